@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 //utilities
 #define APPEND(dest, src) \
@@ -110,12 +111,13 @@ typedef struct CmdLine {
 	bool error;
 	bool help;
 	bool version;
+	bool profile;
 	char* infile;
 	int infileLength;
 } CmdLine;
 
 void usageCmdLine(int argc, const char* argv[]) {
-	printf("Usage: %s [ -h | -v | -f source.toy ]\n\n", argv[0]);
+	printf("Usage: %s [ -h | -v | -p | -f source.toy ]\n\n", argv[0]);
 }
 
 void helpCmdLine(int argc, const char* argv[]) {
@@ -126,6 +128,7 @@ void helpCmdLine(int argc, const char* argv[]) {
 	printf("  -h, --help\t\t\tShow this help then exit.\n");
 	printf("  -v, --version\t\t\tShow version and copyright information then exit.\n");
 	printf("  -f, --file infile\t\tParse, compile and execute the source file then exit.\n");
+	printf("  -p, --profile\t\t\tPrint the VM's execution profile after running, needs TOY_VM_PROFILE.\n");
 }
 
 void versionCmdLine(int argc, const char* argv[]) {
@@ -155,7 +158,7 @@ freely, subject to the following restrictions:\n\
 }
 
 CmdLine parseCmdLine(int argc, const char* argv[]) {
-	CmdLine cmd = { .error = false, .help = false, .version = false, .infile = NULL, .infileLength = 0 };
+	CmdLine cmd = { .error = false, .help = false, .version = false, .profile = false, .infile = NULL, .infileLength = 0 };
 
 	for (int i = 1; i < argc; i++) {
 		if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
@@ -166,6 +169,10 @@ CmdLine parseCmdLine(int argc, const char* argv[]) {
 			cmd.version = true;
 		}
 
+		else if (!strcmp(argv[i], "-p") || !strcmp(argv[i], "--profile")) {
+			cmd.profile = true;
+		}
+
 		else if (!strcmp(argv[i], "-f") || !strcmp(argv[i], "--file")) {
 			if (argc < i + 1) {
 				cmd.error = true;
@@ -200,12 +207,60 @@ CmdLine parseCmdLine(int argc, const char* argv[]) {
 	return cmd;
 }
 
+//profiling
+static void profilePrint(Toy_VM* vm) {
+	Toy_VMProfile* profile = Toy_getVMProfile(vm);
+
+	if (profile == NULL) {
+		fprintf(stderr, TOY_CC_WARN "WARNING: No profile available, rebuild with TOY_VM_PROFILE=1\n" TOY_CC_RESET);
+		return;
+	}
+
+	printf("Profile Dump\n\nopcode\t\t\tcount\tticks\tticks/op\n");
+	for (int i = 0; i < 256; i++) {
+		if (profile->opcodeCounts[i] > 0) {
+			printf("%-24s%llu\t%llu\t%llu\n", Toy_getOpcodeName(i), profile->opcodeCounts[i], profile->opcodeTicks[i], profile->opcodeTicks[i] / profile->opcodeCounts[i]);
+		}
+	}
+
+	//only the most frequent pairs are interesting, so list them in order without sorting the whole table
+	printf("\nfirst\t\t\tsecond\t\t\tcount\n");
+	unsigned int lastCount = UINT_MAX, lastIndex = 0;
+	for (int n = 0; n < 10; n++) {
+		unsigned int bestCount = 0, bestIndex = 0;
+
+		for (unsigned int index = 0; index < 256 * 256; index++) {
+			unsigned int count = profile->opcodePairs[index / 256][index % 256];
+
+			//skip anything already printed
+			if (count > lastCount || (count == lastCount && index <= lastIndex)) {
+				continue;
+			}
+
+			if (count > bestCount) {
+				bestCount = count;
+				bestIndex = index;
+			}
+		}
+
+		if (bestCount == 0) {
+			break;
+		}
+
+		printf("%-24s%-24s%u\n", Toy_getOpcodeName(bestIndex / 256), Toy_getOpcodeName(bestIndex % 256), bestCount);
+		lastCount = bestCount;
+		lastIndex = bestIndex;
+	}
+
+	printf("\nstack peak\t%u\nscope peak\t%u\nstring bytes\t%u\nscope bytes\t%u\n", profile->stackPeak, profile->scopePeak, profile->stringBucketBytes, profile->scopeBucketBytes);
+}
+
 //repl function
 static void errorAndContinueCallback(const char* msg) {
 	fprintf(stderr, "%s\n", msg);
 }
 
-int repl(const char* filepath) {
+int repl(const char* filepath, bool profile) {
 	Toy_setErrorCallback(errorAndContinueCallback);
 	Toy_setAssertFailureCallback(errorAndContinueCallback);
 
@@ -254,6 +309,8 @@ int repl(const char* filepath) {
 			continue;
 		}
 
+		Toy_optimizeAst(&bucket, ast);
+
 		Toy_Bytecode bc = Toy_compileBytecode(ast);
 		Toy_bindVM(&vm, bc.ptr);
 
@@ -278,6 +335,10 @@ int repl(const char* filepath) {
 		printf("%s> ", prompt); //shows the terminal prompt
 	}
 
+	if (profile) {
+		profilePrint(&vm);
+	}
+
 	//cleanp all memory
 	Toy_freeVM(&vm);
 	Toy_freeBucket(&bucket);
@@ -293,9 +354,9 @@ static void debugStackPrint(Toy_Stack* stack) {
 		for (int i = 0; i < stack->count; i++) {
 			Toy_Value v = ((Toy_Value*)(stack + 1))[i];
 
-			printf("%d\t", v.type);
+			printf("%d\t", TOY_VALUE_GET_TYPE(v));
 
-			switch(v.type) {
+			switch(TOY_VALUE_GET_TYPE(v)) {
 				case TOY_VALUE_NULL:
 					printf("null");
 					break;
@@ -313,16 +374,23 @@ static void debugStackPrint(Toy_Stack* stack) {
 					break;
 
 				case TOY_VALUE_STRING: {
+					if (TOY_VALUE_IS_SHORT_STRING(v)) {
+						char buffer[TOY_VALUE_SHORT_STRING_CAPACITY + 1];
+						TOY_VALUE_AS_SHORT_STRING(v, buffer);
+						printf("%s", buffer);
+						break;
+					}
+
 					Toy_String* str = TOY_VALUE_AS_STRING(v);
 
 					//print based on type
-					if (str->type == TOY_STRING_NODE) {
-						char* buffer = Toy_getStringRawBuffer(str);
-						printf("%s", buffer);
-						free(buffer);
-					}
-					else if (str->type == TOY_STRING_LEAF) {
-						printf("%s", str->as.leaf.data);
+					if (str->type != TOY_STRING_NAME) {
+						Toy_StringIterator iter;
+						Toy_initStringIterator(&iter, str);
+
+						while (Toy_nextStringChunk(&iter)) {
+							printf("%.*s", (int)iter.length, iter.chunk);
+						}
 					}
 					else if (str->type == TOY_STRING_NAME) {
 						printf("%s", str->as.name.data);
@@ -344,20 +412,20 @@ static void debugStackPrint(Toy_Stack* stack) {
 }
 
 static void debugScopePrint(Toy_Scope* scope, int depth) {
-	//DEBUG: if there's anything in the scope, print it
-	if (scope->table->count > 0) {
+	//DEBUG: if there's anything in the scope, print it - persistent scopes aren't walked
+	if (scope->table != NULL && scope->table->count > 0) {
 		printf("Scope %d Dump\n\ntype\tname\tvalue\n", depth);
 		for (int i = 0; i < scope->table->capacity; i++) {
-			if ( (TOY_VALUE_IS_STRING(scope->table->data[i].key) && TOY_VALUE_AS_STRING(scope->table->data[i].key)->type == TOY_STRING_NAME) == false) {
+			if ( (TOY_VALUE_IS_STRING(TOY_TABLE_KEY(scope->table, i)) && TOY_VALUE_AS_STRING(TOY_TABLE_KEY(scope->table, i))->type == TOY_STRING_NAME) == false) {
 				continue;
 			}
 
-			Toy_Value k = scope->table->data[i].key;
-			Toy_Value v = scope->table->data[i].value;
+			Toy_Value k = TOY_TABLE_KEY(scope->table, i);
+			Toy_Value v = TOY_TABLE_VALUE(scope->table, i);
 
-			printf("%d\t%s\t", v.type, TOY_VALUE_AS_STRING(k)->as.name.data);
+			printf("%d\t%s\t", TOY_VALUE_GET_TYPE(v), TOY_VALUE_AS_STRING(k)->as.name.data);
 
-			switch(v.type) {
+			switch(TOY_VALUE_GET_TYPE(v)) {
 				case TOY_VALUE_NULL:
 					printf("null");
 					break;
@@ -375,16 +443,23 @@ static void debugScopePrint(Toy_Scope* scope, int depth) {
 					break;
 
 				case TOY_VALUE_STRING: {
+					if (TOY_VALUE_IS_SHORT_STRING(v)) {
+						char buffer[TOY_VALUE_SHORT_STRING_CAPACITY + 1];
+						TOY_VALUE_AS_SHORT_STRING(v, buffer);
+						printf("%s", buffer);
+						break;
+					}
+
 					Toy_String* str = TOY_VALUE_AS_STRING(v);
 
 					//print based on type
-					if (str->type == TOY_STRING_NODE) {
-						char* buffer = Toy_getStringRawBuffer(str);
-						printf("%s", buffer);
-						free(buffer);
-					}
-					else if (str->type == TOY_STRING_LEAF) {
-						printf("%s", str->as.leaf.data);
+					if (str->type != TOY_STRING_NAME) {
+						Toy_StringIterator iter;
+						Toy_initStringIterator(&iter, str);
+
+						while (Toy_nextStringChunk(&iter)) {
+							printf("%.*s", (int)iter.length, iter.chunk);
+						}
 					}
 					else if (str->type == TOY_STRING_NAME) {
 						printf("%s\nWarning: The above value is a name string", str->as.name.data);
@@ -427,7 +502,7 @@ int main(int argc, const char* argv[]) {
 
 	//repl
 	if (argc == 1) {
-		return repl(argv[0]);
+		return repl(argv[0], false);
 	}
 
 	//if there's args, process them
@@ -478,6 +553,7 @@ int main(int argc, const char* argv[]) {
 
 		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
 		Toy_Ast* ast = Toy_scanParser(&bucket, &parser);
+		Toy_optimizeAst(&bucket, ast);
 
 		Toy_Bytecode bc = Toy_compileBytecode(ast);
 
@@ -493,11 +569,18 @@ int main(int argc, const char* argv[]) {
 		debugStackPrint(vm.stack);
 		debugScopePrint(vm.scope, 0);
 
+		if (cmd.profile) {
+			profilePrint(&vm);
+		}
+
 		//cleanup
 		Toy_freeVM(&vm);
 		Toy_freeBucket(&bucket);
 		free(source);
 	}
+	else if (cmd.profile) {
+		return repl(argv[0], true);
+	}
 	else {
 		usageCmdLine(argc, argv);
 	}
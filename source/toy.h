@@ -12,9 +12,13 @@
 #include "toy_bucket.h"
 #include "toy_string.h"
 #include "toy_table.h"
+#include "toy_dictionary.h"
+#include "toy_hamt.h"
+#include "toy_shared_table.h"
 
 //IR structures and other components
 #include "toy_ast.h"
+#include "toy_optimizer.h"
 #include "toy_routine.h"
 
 //pipeline
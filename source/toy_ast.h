@@ -14,10 +14,12 @@ typedef enum Toy_AstType {
 	TOY_AST_UNARY,
 	TOY_AST_BINARY,
 	TOY_AST_GROUP,
+	TOY_AST_SCOPE,
 
 	TOY_AST_PRINT,
 
 	TOY_AST_VAR_DECLARE,
+	TOY_AST_VAR_ACCESS,
 
 	TOY_AST_PASS,
 	TOY_AST_ERROR,
@@ -91,6 +93,11 @@ typedef struct Toy_AstGroup {
 	Toy_Ast* child;
 } Toy_AstGroup;
 
+typedef struct Toy_AstScope {
+	Toy_AstType type;
+	Toy_Ast* child; //a block, with it's own local variables
+} Toy_AstScope;
+
 typedef struct Toy_AstPrint {
 	Toy_AstType type;
 	Toy_Ast* child;
@@ -102,6 +109,11 @@ typedef struct Toy_AstVarDeclare {
 	Toy_Ast* expr;
 } Toy_AstVarDeclare;
 
+typedef struct Toy_AstVarAccess {
+	Toy_AstType type;
+	Toy_String* name;
+} Toy_AstVarAccess;
+
 typedef struct Toy_AstPass {
 	Toy_AstType type;
 } Toy_AstPass;
@@ -121,8 +133,10 @@ union Toy_Ast {                     //32 | 64 BITNESS
 	Toy_AstUnary unary;             //12 | 16
 	Toy_AstBinary binary;           //16 | 24
 	Toy_AstGroup group;             //8  | 16
+	Toy_AstScope scope;             //8  | 16
 	Toy_AstPrint print;             //8  | 16
 	Toy_AstVarDeclare varDeclare;   //16 | 24
+	Toy_AstVarAccess varAccess;     //8  | 16
 	Toy_AstPass pass;               //4  | 4
 	Toy_AstError error;             //4  | 4
 	Toy_AstEnd end;                 //4  | 4
@@ -135,10 +149,12 @@ void Toy_private_emitAstValue(Toy_Bucket** bucketHandle, Toy_Ast** astHandle, To
 void Toy_private_emitAstUnary(Toy_Bucket** bucketHandle, Toy_Ast** astHandle, Toy_AstFlag flag);
 void Toy_private_emitAstBinary(Toy_Bucket** bucketHandle, Toy_Ast** astHandle,Toy_AstFlag flag, Toy_Ast* right);
 void Toy_private_emitAstGroup(Toy_Bucket** bucketHandle, Toy_Ast** astHandle);
+void Toy_private_emitAstScope(Toy_Bucket** bucketHandle, Toy_Ast** astHandle);
 
 void Toy_private_emitAstPrint(Toy_Bucket** bucketHandle, Toy_Ast** astHandle);
 
 void Toy_private_emitAstVariableDeclaration(Toy_Bucket** bucketHandle, Toy_Ast** astHandle, Toy_String* name, Toy_Ast* expr);
+void Toy_private_emitAstVariableAccess(Toy_Bucket** bucketHandle, Toy_Ast** astHandle, Toy_String* name);
 
 void Toy_private_emitAstPass(Toy_Bucket** bucketHandle, Toy_Ast** astHandle);
 void Toy_private_emitAstError(Toy_Bucket** bucketHandle, Toy_Ast** astHandle);
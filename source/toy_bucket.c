@@ -4,8 +4,49 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-//buckets of fun
-Toy_Bucket* Toy_allocateBucket(unsigned int capacity) {
+//utils
+#define BLOCK_GRANULARITY 8 //enough to hold the free list's link
+
+static unsigned int roundBlock(unsigned int amount) {
+	return amount > 0 ? (amount + BLOCK_GRANULARITY - 1) & ~(BLOCK_GRANULARITY - 1) : BLOCK_GRANULARITY;
+}
+
+//each size class lists the buckets with free blocks of that class
+static void linkFreeBucket(Toy_Bucket* bucket, unsigned int sizeClass) {
+	Toy_Bucket** head = &bucket->chain->freeBuckets[sizeClass];
+
+	bucket->freePrev[sizeClass] = NULL;
+	bucket->freeNext[sizeClass] = (*head);
+	if ((*head) != NULL) {
+		(*head)->freePrev[sizeClass] = bucket;
+	}
+	(*head) = bucket;
+}
+
+static void unlinkFreeBucket(Toy_Bucket* bucket, unsigned int sizeClass) {
+	if (bucket->freePrev[sizeClass] != NULL) {
+		bucket->freePrev[sizeClass]->freeNext[sizeClass] = bucket->freeNext[sizeClass];
+	}
+	else {
+		bucket->chain->freeBuckets[sizeClass] = bucket->freeNext[sizeClass];
+	}
+
+	if (bucket->freeNext[sizeClass] != NULL) {
+		bucket->freeNext[sizeClass]->freePrev[sizeClass] = bucket->freePrev[sizeClass];
+	}
+}
+
+//drops every free block in the bucket, and the bucket from the chain's lists
+static void clearFreeBlocks(Toy_Bucket* bucket) {
+	for (int i = 0; i < TOY_BUCKET_BLOCK_CLASSES; i++) {
+		if (bucket->blocks[i] != NULL) {
+			unlinkFreeBucket(bucket, i);
+			bucket->blocks[i] = NULL;
+		}
+	}
+}
+
+static Toy_Bucket* allocateBucketInChain(unsigned int capacity, Toy_BucketChain* chain) {
 	if (capacity == 0) {
 		fprintf(stderr, TOY_CC_ERROR "ERROR: Cannot allocate a 'Toy_Bucket' with zero capacity\n" TOY_CC_RESET);
 		exit(1);
@@ -20,12 +61,35 @@ Toy_Bucket* Toy_allocateBucket(unsigned int capacity) {
 
 	//initialize the bucket
 	bucket->next = NULL;
+	bucket->prev = NULL;
+	bucket->chain = chain;
 	bucket->capacity = capacity;
 	bucket->count = 0;
+	bucket->released = 0;
+
+	for (int i = 0; i < TOY_BUCKET_BLOCK_CLASSES; i++) {
+		bucket->blocks[i] = NULL;
+	}
 
 	return bucket;
 }
 
+//buckets of fun
+Toy_Bucket* Toy_allocateBucket(unsigned int capacity) {
+	Toy_BucketChain* chain = malloc(sizeof(Toy_BucketChain));
+
+	if (chain == NULL) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_BucketChain'\n" TOY_CC_RESET);
+		exit(1);
+	}
+
+	for (int i = 0; i < TOY_BUCKET_BLOCK_CLASSES; i++) {
+		chain->freeBuckets[i] = NULL;
+	}
+
+	return allocateBucketInChain(capacity, chain);
+}
+
 void* Toy_partitionBucket(Toy_Bucket** bucketHandle, unsigned int amount) {
 	if ((*bucketHandle) == NULL) {
 		fprintf(stderr, TOY_CC_ERROR "ERROR: Expected a 'Toy_Bucket', received NULL\n" TOY_CC_RESET);
@@ -46,8 +110,9 @@ void* Toy_partitionBucket(Toy_Bucket** bucketHandle, unsigned int amount) {
 	//if you're out of space in this bucket
 	if ((*bucketHandle)->capacity < (*bucketHandle)->count + amount) {
 		//move to the next bucket
-		Toy_Bucket* tmp = Toy_allocateBucket((*bucketHandle)->capacity);
+		Toy_Bucket* tmp = allocateBucketInChain((*bucketHandle)->capacity, (*bucketHandle)->chain);
 		tmp->next = (*bucketHandle); //it's buckets all the way down
+		(*bucketHandle)->prev = tmp;
 		(*bucketHandle) = tmp;
 	}
 
@@ -59,6 +124,10 @@ void* Toy_partitionBucket(Toy_Bucket** bucketHandle, unsigned int amount) {
 void Toy_freeBucket(Toy_Bucket** bucketHandle) {
 	Toy_Bucket* iter = (*bucketHandle);
 
+	if (iter != NULL) {
+		free(iter->chain);
+	}
+
 	while (iter != NULL) {
 		//run down the chain
 		Toy_Bucket* last = iter;
@@ -71,3 +140,80 @@ void Toy_freeBucket(Toy_Bucket** bucketHandle) {
 	//for safety
 	(*bucketHandle) = NULL;
 }
+
+void* Toy_partitionBucketBlock(Toy_Bucket** bucketHandle, unsigned int amount) {
+	if ((*bucketHandle) == NULL) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Expected a 'Toy_Bucket', received NULL\n" TOY_CC_RESET);
+		exit(1);
+	}
+
+	amount = roundBlock(amount);
+	unsigned int sizeClass = amount / BLOCK_GRANULARITY - 1;
+
+	//reuse a block given back earlier, from whichever bucket listed first
+	if (sizeClass < TOY_BUCKET_BLOCK_CLASSES && (*bucketHandle)->chain->freeBuckets[sizeClass] != NULL) {
+		Toy_Bucket* bucket = (*bucketHandle)->chain->freeBuckets[sizeClass];
+
+		void* block = bucket->blocks[sizeClass];
+		bucket->blocks[sizeClass] = *(void**)block;
+		bucket->released -= amount;
+
+		if (bucket->blocks[sizeClass] == NULL) {
+			unlinkFreeBucket(bucket, sizeClass);
+		}
+
+		return block;
+	}
+
+	//otherwise take fresh space from the front, starting a new bucket when it's full
+	return Toy_partitionBucket(bucketHandle, amount);
+}
+
+void Toy_releaseBucketBlock(Toy_Bucket* bucket, void* block, unsigned int amount) {
+	amount = roundBlock(amount);
+	unsigned int sizeClass = amount / BLOCK_GRANULARITY - 1;
+
+	bucket->released += amount;
+
+	//the last partition can simply be taken back
+	if ((char*)block + amount == bucket->data + bucket->count) {
+		bucket->count -= amount;
+		bucket->released -= amount;
+	}
+
+	//everything has been given back
+	if (bucket->released == bucket->count) {
+		clearFreeBlocks(bucket);
+
+		//the front of the chain is kept for reuse
+		if (bucket->prev == NULL) {
+			bucket->count = 0;
+			bucket->released = 0;
+			return;
+		}
+
+		//anything else is unlinked and freed
+		bucket->prev->next = bucket->next;
+		if (bucket->next != NULL) {
+			bucket->next->prev = bucket->prev;
+		}
+
+		free(bucket);
+		return;
+	}
+
+	//taken back above
+	if ((char*)block >= bucket->data + bucket->count) {
+		return;
+	}
+
+	//keep it for later, if it's small enough to be worth tracking
+	if (sizeClass < TOY_BUCKET_BLOCK_CLASSES) {
+		if (bucket->blocks[sizeClass] == NULL) {
+			linkFreeBucket(bucket, sizeClass);
+		}
+
+		*(void**)block = bucket->blocks[sizeClass];
+		bucket->blocks[sizeClass] = block;
+	}
+}
@@ -3,23 +3,43 @@
 #include "toy_common.h"
 
 //NOTE: this structure has restrictions on it's usage:
-// - It can only expand until it is freed
+// - It can only expand until it is freed, except for blocks given back with Toy_releaseBucketBlock()
 // - It cannot be copied around within RAM
 // - It cannot allocate more memory than it has capacity
 // If each of these rules are followed, the bucket is actually more efficient than any other option
 
+//blocks given back with Toy_releaseBucketBlock() are kept in free lists, one per size class of 8 bytes - larger blocks are only reclaimed along with their whole bucket
+#ifndef TOY_BUCKET_BLOCK_CLASSES
+#define TOY_BUCKET_BLOCK_CLASSES 16
+#endif
+
+//the buckets holding free blocks of each size class, shared by every bucket in a chain, so finding a block never walks the chain
+typedef struct Toy_BucketChain {                                //32 | 64 BITNESS
+	struct Toy_Bucket* freeBuckets[TOY_BUCKET_BLOCK_CLASSES];   //64 | 128
+} Toy_BucketChain;                                              //64 | 128
+
 //a custom allocator
-typedef struct Toy_Bucket {  //32 | 64 BITNESS
-	struct Toy_Bucket* next; //4  | 8
-	unsigned int capacity;   //4  | 4
-	unsigned int count;      //4  | 4
-	char data[];             //-  | -
-} Toy_Bucket;                //12 | 16
+typedef struct Toy_Bucket {                                     //32 | 64 BITNESS
+	struct Toy_Bucket* next;                                    //4  | 8
+	struct Toy_Bucket* prev;                                    //4  | 8  - NULL for the front of the chain
+	Toy_BucketChain* chain;                                     //4  | 8
+	unsigned int capacity;                                      //4  | 4
+	unsigned int count;                                         //4  | 4
+	unsigned int released;                                      //4  | 4  - bytes given back, the bucket is empty when this reaches 'count'
+	void* blocks[TOY_BUCKET_BLOCK_CLASSES];                     //64 | 128
+	struct Toy_Bucket* freeNext[TOY_BUCKET_BLOCK_CLASSES];      //64 | 128 - the chain's other buckets with free blocks of each class
+	struct Toy_Bucket* freePrev[TOY_BUCKET_BLOCK_CLASSES];      //64 | 128 - only meaningful while this bucket's list for the class is non-empty
+	char data[];                                                //-  | -
+} Toy_Bucket;                                                   //216 | 424
 
 TOY_API Toy_Bucket* Toy_allocateBucket(unsigned int capacity);
 TOY_API void* Toy_partitionBucket(Toy_Bucket** bucketHandle, unsigned int amount);
 TOY_API void Toy_freeBucket(Toy_Bucket** bucketHandle);
 
+//blocks that can be given back, for memory with a known lifetime like strings - a free block from anywhere in the chain, or else space at the front, (*bucketHandle)
+TOY_API void* Toy_partitionBucketBlock(Toy_Bucket** bucketHandle, unsigned int amount);
+TOY_API void Toy_releaseBucketBlock(Toy_Bucket* bucket, void* block, unsigned int amount); //'amount' must match the partition
+
 //some useful sizes, could be swapped out as needed
 #ifndef TOY_BUCKET_TINY
 #define TOY_BUCKET_TINY (1024 * 2)
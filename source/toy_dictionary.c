@@ -0,0 +1,199 @@
+#include "toy_dictionary.h"
+#include "toy_console_colors.h"
+#include "toy_print.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//utils
+static unsigned int readIndex(Toy_Dictionary* dictionary, unsigned int slot) {
+	switch(TOY_DICTIONARY_INDEX_WIDTH(dictionary->capacity)) {
+		case 1:
+			return dictionary->index[slot];
+
+		case 2:
+			return ((uint16_t*)dictionary->index)[slot];
+
+		default:
+			return ((uint32_t*)dictionary->index)[slot];
+	}
+}
+
+static void writeIndex(Toy_Dictionary* dictionary, unsigned int slot, unsigned int position) {
+	switch(TOY_DICTIONARY_INDEX_WIDTH(dictionary->capacity)) {
+		case 1:
+			dictionary->index[slot] = (uint8_t)position;
+			break;
+
+		case 2:
+			((uint16_t*)dictionary->index)[slot] = (uint16_t)position;
+			break;
+
+		default:
+			((uint32_t*)dictionary->index)[slot] = (uint32_t)position;
+			break;
+	}
+}
+
+//the index slot that points to the key, or the first free slot along its probe when 'found' is false
+static unsigned int findSlot(Toy_Dictionary* dictionary, Toy_Value key, unsigned int hash, bool* found) {
+	unsigned int mask = dictionary->capacity - 1;
+	unsigned int probe = hash & mask;
+	unsigned int firstRemoved = UINT32_MAX;
+
+	while (true) {
+		unsigned int position = readIndex(dictionary, probe);
+
+		//the end of the probe, so reuse the first removed slot passed, if any
+		if (position == 0) {
+			(*found) = false;
+			return firstRemoved != UINT32_MAX ? firstRemoved : probe;
+		}
+
+		if (position == 1) {
+			firstRemoved = firstRemoved != UINT32_MAX ? firstRemoved : probe;
+		}
+		else {
+			Toy_DictionaryEntry* entry = &dictionary->entries[position - 2];
+
+			//found the entry
+			if (entry->hash == hash && TOY_VALUES_ARE_EQUAL(entry->key, key)) {
+				(*found) = true;
+				return probe;
+			}
+		}
+
+		//adjust and continue
+		probe = (probe + 1) & mask;
+	}
+}
+
+static void appendEntry(Toy_Dictionary* dictionary, unsigned int slot, Toy_Value key, Toy_Value value, unsigned int hash) {
+	dictionary->entries[dictionary->used] = (Toy_DictionaryEntry){ .key = key, .value = value, .hash = hash };
+	writeIndex(dictionary, slot, dictionary->used + 2);
+	dictionary->used++;
+	dictionary->count++;
+}
+
+//exposed functions
+Toy_Dictionary* Toy_private_adjustDictionaryCapacity(Toy_Dictionary* oldDictionary, unsigned int newUsable) {
+	//room for the live entries and at least one more, behind an index that's a power of two
+	unsigned int count = oldDictionary != NULL ? oldDictionary->count : 0;
+	unsigned int usable = newUsable > count ? newUsable : count + 1;
+	unsigned int capacity = 2;
+	while (TOY_DICTIONARY_USABLE(capacity) < usable) {
+		capacity *= 2;
+	}
+
+	//allocate a new dictionary in memory
+	Toy_Dictionary* newDictionary = malloc(TOY_DICTIONARY_SIZE(capacity, usable));
+
+	if (newDictionary == NULL) {
+		Toy_error(TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_Dictionary'\n" TOY_CC_RESET);
+	}
+
+	newDictionary->capacity = capacity;
+	newDictionary->count = 0;
+	newDictionary->used = 0;
+	newDictionary->usable = usable;
+	newDictionary->entries = (Toy_DictionaryEntry*)(newDictionary->index + TOY_DICTIONARY_INDEX_SIZE(capacity));
+
+	//every index slot starts empty, while the entries are only read once written
+	memset(newDictionary->index, 0, TOY_DICTIONARY_INDEX_SIZE(capacity));
+
+	if (oldDictionary == NULL) { //for initial allocations
+		return newDictionary;
+	}
+
+	//copy the live entries across in order, leaving the removed ones behind, reusing the hashes
+	for (unsigned int i = 0; i < oldDictionary->used; i++) {
+		Toy_DictionaryEntry* entry = &oldDictionary->entries[i];
+
+		if (TOY_VALUE_IS_NULL(entry->key)) {
+			continue;
+		}
+
+		//every key is unique, so the first empty slot will do
+		unsigned int mask = newDictionary->capacity - 1;
+		unsigned int probe = entry->hash & mask;
+		while (readIndex(newDictionary, probe) != 0) {
+			probe = (probe + 1) & mask;
+		}
+
+		appendEntry(newDictionary, probe, entry->key, entry->value, entry->hash);
+	}
+
+	//clean up and return
+	free(oldDictionary);
+	return newDictionary;
+}
+
+Toy_Dictionary* Toy_allocateDictionary() {
+	return Toy_private_adjustDictionaryCapacity(NULL, TOY_DICTIONARY_USABLE(TOY_DICTIONARY_INITIAL_CAPACITY));
+}
+
+void Toy_freeDictionary(Toy_Dictionary* dictionary) {
+	//TODO: slip in a call to free the complex values here
+
+	free(dictionary);
+}
+
+void Toy_insertDictionary(Toy_Dictionary** dictionaryHandle, Toy_Value key, Toy_Value value) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad dictionary key\n" TOY_CC_RESET);
+	}
+
+	unsigned int hash = Toy_hashValue(key);
+	bool found;
+	unsigned int slot = findSlot((*dictionaryHandle), key, hash, &found);
+
+	//overriding an existing value keeps its place in the order
+	if (found) {
+		(*dictionaryHandle)->entries[readIndex((*dictionaryHandle), slot) - 2].value = value;
+		return;
+	}
+
+	//out of entries, so expand when mostly live, or compact away the removed ones when not
+	if ((*dictionaryHandle)->used >= (*dictionaryHandle)->usable) {
+		unsigned int usable = (*dictionaryHandle)->usable;
+		if ((*dictionaryHandle)->count > usable / 2) {
+			usable = (unsigned int)(usable * TOY_DICTIONARY_EXPANSION_RATE);
+		}
+
+		(*dictionaryHandle) = Toy_private_adjustDictionaryCapacity((*dictionaryHandle), usable);
+		slot = findSlot((*dictionaryHandle), key, hash, &found);
+	}
+
+	appendEntry((*dictionaryHandle), slot, key, value, hash);
+}
+
+Toy_Value Toy_lookupDictionary(Toy_Dictionary** dictionaryHandle, Toy_Value key) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad dictionary key\n" TOY_CC_RESET);
+	}
+
+	bool found;
+	unsigned int slot = findSlot((*dictionaryHandle), key, Toy_hashValue(key), &found);
+
+	return found ? (*dictionaryHandle)->entries[readIndex((*dictionaryHandle), slot) - 2].value : TOY_VALUE_FROM_NULL();
+}
+
+void Toy_removeDictionary(Toy_Dictionary** dictionaryHandle, Toy_Value key) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad dictionary key\n" TOY_CC_RESET);
+	}
+
+	bool found;
+	unsigned int slot = findSlot((*dictionaryHandle), key, Toy_hashValue(key), &found);
+
+	if (!found) {
+		return;
+	}
+
+	//leave a hole in the entries, and a marker in the index so later probes continue past it
+	unsigned int position = readIndex((*dictionaryHandle), slot) - 2;
+	(*dictionaryHandle)->entries[position] = (Toy_DictionaryEntry){ .key = TOY_VALUE_FROM_NULL(), .value = TOY_VALUE_FROM_NULL(), .hash = 0 };
+	writeIndex((*dictionaryHandle), slot, 1);
+	(*dictionaryHandle)->count--;
+}
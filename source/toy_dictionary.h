@@ -0,0 +1,51 @@
+#pragma once
+
+#include "toy_common.h"
+#include "toy_value.h"
+
+//key-value entry, kept in insertion order, where a removed entry leaves a null key until the next resize
+typedef struct Toy_DictionaryEntry { //32 | 64 BITNESS
+	Toy_Value key;                   //8  | 16
+	Toy_Value value;                 //8  | 16
+	unsigned int hash;               //4  | 4
+} Toy_DictionaryEntry;               //20 | 40
+
+//compact dictionary for script-level values: a sparse index of small integers into a dense array of entries - https://mail.python.org/pipermail/python-dev/2012-December/123028.html
+typedef struct Toy_Dictionary {   //32 | 64 BITNESS
+	unsigned int capacity;        //4  | 4  slots in the index, a power of two
+	unsigned int count;           //4  | 4  live entries
+	unsigned int used;            //4  | 4  entries written, including the ones removed since the last resize
+	unsigned int usable;          //4  | 4  entries that fit before a resize, at most two thirds of the capacity
+	Toy_DictionaryEntry* entries; //4  | 8  follows the index, in the same allocation
+	unsigned char index[];        //-  | -  1, 2 or 4 bytes per slot, where 0 is empty, 1 is removed, and the rest are entry positions + 2
+} Toy_Dictionary;                 //20 | 24
+
+//the index is only as wide as the entry positions need
+#define TOY_DICTIONARY_INDEX_WIDTH(capacity) ((capacity) <= 256 ? 1 : (capacity) <= 65536 ? 2 : 4)
+
+//the most entries an index can point to, keeping a third of it empty
+#define TOY_DICTIONARY_USABLE(capacity) ((capacity) * 2 / 3)
+
+//the index is padded, so the entries that follow it are aligned
+#define TOY_DICTIONARY_INDEX_SIZE(capacity) (((capacity) * TOY_DICTIONARY_INDEX_WIDTH(capacity) + sizeof(Toy_DictionaryEntry*) - 1) / sizeof(Toy_DictionaryEntry*) * sizeof(Toy_DictionaryEntry*))
+#define TOY_DICTIONARY_SIZE(capacity, usable) (sizeof(Toy_Dictionary) + TOY_DICTIONARY_INDEX_SIZE(capacity) + (usable) * sizeof(Toy_DictionaryEntry))
+
+//iteration walks the entries from 0 to 'used', skipping null keys
+TOY_API Toy_Dictionary* Toy_allocateDictionary();
+TOY_API void Toy_freeDictionary(Toy_Dictionary* dictionary);
+TOY_API void Toy_insertDictionary(Toy_Dictionary** dictionaryHandle, Toy_Value key, Toy_Value value);
+TOY_API Toy_Value Toy_lookupDictionary(Toy_Dictionary** dictionaryHandle, Toy_Value key);
+TOY_API void Toy_removeDictionary(Toy_Dictionary** dictionaryHandle, Toy_Value key);
+
+//NOTE: exposed for preallocation, and to compact away removed entries; room is made for at least one more than the live entries
+TOY_API Toy_Dictionary* Toy_private_adjustDictionaryCapacity(Toy_Dictionary* oldDictionary, unsigned int newUsable);
+
+//some useful sizes, could be swapped out as needed
+#ifndef TOY_DICTIONARY_INITIAL_CAPACITY
+#define TOY_DICTIONARY_INITIAL_CAPACITY 8
+#endif
+
+//the entries grow more gently than Toy_Table, as the index stays sparse regardless
+#ifndef TOY_DICTIONARY_EXPANSION_RATE
+#define TOY_DICTIONARY_EXPANSION_RATE 1.5
+#endif
@@ -0,0 +1,266 @@
+#include "toy_hamt.h"
+#include "toy_console_colors.h"
+#include "toy_print.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//utils
+static inline unsigned int popCount(uint32_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned int)__builtin_popcount(bits);
+#else
+	bits = bits - ((bits >> 1) & 0x55555555u);
+	bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+	return (((bits + (bits >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+static inline uint32_t branchBit(unsigned int hash, unsigned int depth) {
+	return (uint32_t)1 << ((hash >> (depth * 5)) & 31);
+}
+
+static inline Toy_HamtNode** childrenOf(Toy_HamtNode* node) {
+	return (Toy_HamtNode**)(node->entries + node->entryCount);
+}
+
+static Toy_HamtNode* allocateNode(uint32_t entryMap, uint32_t nodeMap, unsigned int entryCount) {
+	Toy_HamtNode* node = malloc(sizeof(Toy_HamtNode) + entryCount * sizeof(Toy_HamtEntry) + popCount(nodeMap) * sizeof(Toy_HamtNode*));
+
+	if (node == NULL) {
+		Toy_error(TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_HamtNode'\n" TOY_CC_RESET);
+	}
+
+	node->refCount = 1;
+	node->entryMap = entryMap;
+	node->nodeMap = nodeMap;
+	node->entryCount = entryCount;
+
+	return node;
+}
+
+//each node owns a reference to the strings in its entries, so copies of an entry are retained
+static void retainEntries(Toy_HamtEntry* entries, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++) {
+		Toy_copyValue(entries[i].key);
+		Toy_copyValue(entries[i].value);
+	}
+}
+
+static void releaseNode(Toy_HamtNode* node) {
+	if (node == NULL || --node->refCount > 0) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < node->entryCount; i++) {
+		Toy_freeValue(node->entries[i].key);
+		Toy_freeValue(node->entries[i].value);
+	}
+
+	Toy_HamtNode** children = childrenOf(node);
+	for (unsigned int i = 0; i < popCount(node->nodeMap); i++) {
+		releaseNode(children[i]);
+	}
+
+	free(node);
+}
+
+//the node's entries and children were copied into its replacement - they gain a reference if the node lives on elsewhere, or simply move across otherwise
+static void leaveNode(Toy_HamtNode* node) {
+	if (node->refCount == 1) {
+		free(node);
+		return;
+	}
+
+	retainEntries(node->entries, node->entryCount);
+
+	Toy_HamtNode** children = childrenOf(node);
+	for (unsigned int i = 0; i < popCount(node->nodeMap); i++) {
+		children[i]->refCount++;
+	}
+
+	node->refCount--;
+}
+
+//an unshared node can be changed in place, while a shared one is copied, leaving the caller's reference with the copy
+static Toy_HamtNode* uniqueNode(Toy_HamtNode* node) {
+	if (node->refCount == 1) {
+		return node;
+	}
+
+	Toy_HamtNode* copy = allocateNode(node->entryMap, node->nodeMap, node->entryCount);
+	memcpy(copy->entries, node->entries, node->entryCount * sizeof(Toy_HamtEntry) + popCount(node->nodeMap) * sizeof(Toy_HamtNode*));
+
+	//the copy's entries and children are now shared by both
+	retainEntries(copy->entries, copy->entryCount);
+
+	Toy_HamtNode** children = childrenOf(copy);
+	for (unsigned int i = 0; i < popCount(copy->nodeMap); i++) {
+		children[i]->refCount++;
+	}
+
+	node->refCount--;
+	return copy;
+}
+
+//two entries whose hashes agreed up to this depth, split into a new subtree
+static Toy_HamtNode* mergeEntries(Toy_HamtEntry first, Toy_HamtEntry second, unsigned int depth) {
+	//out of hash bits, so the entries just sit side by side
+	if (depth >= TOY_HAMT_MAX_DEPTH) {
+		Toy_HamtNode* node = allocateNode(0, 0, 2);
+		node->entries[0] = first;
+		node->entries[1] = second;
+		return node;
+	}
+
+	uint32_t firstBit = branchBit(first.hash, depth);
+	uint32_t secondBit = branchBit(second.hash, depth);
+
+	//still together, so go another level down
+	if (firstBit == secondBit) {
+		Toy_HamtNode* node = allocateNode(0, firstBit, 0);
+		childrenOf(node)[0] = mergeEntries(first, second, depth + 1);
+		return node;
+	}
+
+	//entries are kept in branch order
+	Toy_HamtNode* node = allocateNode(firstBit | secondBit, 0, 2);
+	node->entries[firstBit < secondBit ? 0 : 1] = first;
+	node->entries[firstBit < secondBit ? 1 : 0] = second;
+	return node;
+}
+
+//replaces the caller's reference to 'node' with a reference to the result
+static Toy_HamtNode* insertNode(Toy_HamtNode* node, Toy_HamtEntry entry, unsigned int depth) {
+	//the deepest level is searched in full
+	if (depth >= TOY_HAMT_MAX_DEPTH) {
+		for (unsigned int i = 0; i < node->entryCount; i++) {
+			if (node->entries[i].hash == entry.hash && TOY_VALUES_ARE_EQUAL(node->entries[i].key, entry.key)) {
+				node = uniqueNode(node);
+				node->entries[i].value = entry.value;
+				return node;
+			}
+		}
+
+		Toy_HamtNode* grown = allocateNode(0, 0, node->entryCount + 1);
+		memcpy(grown->entries, node->entries, node->entryCount * sizeof(Toy_HamtEntry));
+		grown->entries[node->entryCount] = entry;
+
+		leaveNode(node);
+		return grown;
+	}
+
+	uint32_t bit = branchBit(entry.hash, depth);
+	unsigned int entryIndex = popCount(node->entryMap & (bit - 1));
+	unsigned int nodeIndex = popCount(node->nodeMap & (bit - 1));
+	unsigned int nodeCount = popCount(node->nodeMap);
+
+	//the branch leads to a subtree
+	if (node->nodeMap & bit) {
+		node = uniqueNode(node);
+		childrenOf(node)[nodeIndex] = insertNode(childrenOf(node)[nodeIndex], entry, depth + 1);
+		return node;
+	}
+
+	//the branch holds an entry
+	if (node->entryMap & bit) {
+		Toy_HamtEntry* existing = &node->entries[entryIndex];
+
+		//the same key
+		if (existing->hash == entry.hash && TOY_VALUES_ARE_EQUAL(existing->key, entry.key)) {
+			node = uniqueNode(node);
+			node->entries[entryIndex].value = entry.value;
+			return node;
+		}
+
+		//a different key, so both move into a new subtree where the entry was
+		Toy_HamtNode* split = allocateNode(node->entryMap & ~bit, node->nodeMap | bit, node->entryCount - 1);
+		Toy_HamtNode** children = childrenOf(split);
+
+		memcpy(split->entries, node->entries, entryIndex * sizeof(Toy_HamtEntry));
+		memcpy(split->entries + entryIndex, node->entries + entryIndex + 1, (node->entryCount - entryIndex - 1) * sizeof(Toy_HamtEntry));
+		memcpy(children, childrenOf(node), nodeIndex * sizeof(Toy_HamtNode*));
+		children[nodeIndex] = mergeEntries(*existing, entry, depth + 1);
+		memcpy(children + nodeIndex + 1, childrenOf(node) + nodeIndex, (nodeCount - nodeIndex) * sizeof(Toy_HamtNode*));
+
+		leaveNode(node);
+		return split;
+	}
+
+	//an empty branch
+	Toy_HamtNode* grown = allocateNode(node->entryMap | bit, node->nodeMap, node->entryCount + 1);
+
+	memcpy(grown->entries, node->entries, entryIndex * sizeof(Toy_HamtEntry));
+	grown->entries[entryIndex] = entry;
+	memcpy(grown->entries + entryIndex + 1, node->entries + entryIndex, (node->entryCount - entryIndex) * sizeof(Toy_HamtEntry));
+	memcpy(childrenOf(grown), childrenOf(node), nodeCount * sizeof(Toy_HamtNode*));
+
+	leaveNode(node);
+	return grown;
+}
+
+//exposed functions
+void Toy_insertHamt(Toy_HamtNode** rootHandle, Toy_Value key, Toy_Value value, unsigned int hash) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad hamt key\n" TOY_CC_RESET);
+	}
+
+	Toy_HamtEntry entry = (Toy_HamtEntry){ .key = key, .value = value, .hash = hash };
+
+	//the first entry
+	if ((*rootHandle) == NULL) {
+		(*rootHandle) = allocateNode(branchBit(hash, 0), 0, 1);
+		(*rootHandle)->entries[0] = entry;
+		return;
+	}
+
+	(*rootHandle) = insertNode((*rootHandle), entry, 0);
+}
+
+Toy_HamtNode* Toy_copyHamt(Toy_HamtNode* root) {
+	if (root != NULL) {
+		root->refCount++;
+	}
+
+	return root;
+}
+
+void Toy_freeHamt(Toy_HamtNode* root) {
+	releaseNode(root);
+}
+
+const Toy_Value* Toy_private_lookupHamtValue(Toy_HamtNode* root, Toy_Value key, unsigned int hash) {
+	Toy_HamtNode* node = root;
+
+	for (unsigned int depth = 0; node != NULL; depth++) {
+		//the deepest level is searched in full
+		if (depth >= TOY_HAMT_MAX_DEPTH) {
+			for (unsigned int i = 0; i < node->entryCount; i++) {
+				if (node->entries[i].hash == hash && TOY_VALUES_ARE_EQUAL(node->entries[i].key, key)) {
+					return &(node->entries[i].value);
+				}
+			}
+
+			return NULL;
+		}
+
+		uint32_t bit = branchBit(hash, depth);
+
+		//found an entry, which may not be the key
+		if (node->entryMap & bit) {
+			Toy_HamtEntry* entry = &node->entries[popCount(node->entryMap & (bit - 1))];
+			return entry->hash == hash && TOY_VALUES_ARE_EQUAL(entry->key, key) ? &(entry->value) : NULL;
+		}
+
+		//nothing along this branch
+		if ((node->nodeMap & bit) == 0) {
+			return NULL;
+		}
+
+		//adjust and continue
+		node = childrenOf(node)[popCount(node->nodeMap & (bit - 1))];
+	}
+
+	return NULL;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "toy_common.h"
+#include "toy_value.h"
+
+//key-value entry, stored in whichever node its hash runs out of collisions in
+typedef struct Toy_HamtEntry { //32 | 64 BITNESS
+	Toy_Value key;             //8  | 16
+	Toy_Value value;           //8  | 16
+	unsigned int hash;         //4  | 4
+} Toy_HamtEntry;               //20 | 40
+
+//persistent hash array mapped trie, where each level branches on 5 bits of the hash - https://infoscience.epfl.ch/record/64398
+typedef struct Toy_HamtNode {  //32 | 64 BITNESS
+	unsigned int refCount;     //4  | 4  parents and handles sharing this node, which is copied before changing while shared
+	uint32_t entryMap;         //4  | 4  branches holding an entry directly
+	uint32_t nodeMap;          //4  | 4  branches holding a child node
+	unsigned int entryCount;   //4  | 4  entries in this node, which at the deepest level are full hash collisions
+	Toy_HamtEntry entries[];   //-  | -  followed by the child nodes
+} Toy_HamtNode;                //16 | 16
+
+//the levels that branch, where the last one only has 2 bits of the hash left
+#define TOY_HAMT_MAX_DEPTH 7
+
+//a NULL root is an empty trie, every handle owns one reference to its root, and each node owns a reference to the strings in its entries
+TOY_API void Toy_insertHamt(Toy_HamtNode** rootHandle, Toy_Value key, Toy_Value value, unsigned int hash); //copies each shared node along the path, and changes unshared ones in place; takes the caller's reference to the value, and to the key if it's new, while a replaced value's reference is left with the caller
+TOY_API Toy_HamtNode* Toy_copyHamt(Toy_HamtNode* root); //shares the whole trie
+TOY_API void Toy_freeHamt(Toy_HamtNode* root);
+
+//NOTE: exposed so Toy_Scope can hash a name once for the whole chain; NULL when missing, and read-only, since the node may be shared
+TOY_API const Toy_Value* Toy_private_lookupHamtValue(Toy_HamtNode* root, Toy_Value key, unsigned int hash);
@@ -7,6 +7,11 @@ typedef enum Toy_OpcodeType {
 	TOY_OPCODE_ASSIGN,
 	TOY_OPCODE_ACCESS,
 
+	//local variable instructions, resolved to slots by the compiler
+	TOY_OPCODE_DECLARE_SLOT,
+	TOY_OPCODE_ASSIGN_SLOT,
+	TOY_OPCODE_ACCESS_SLOT,
+
 	//arithmetic instructions
 	TOY_OPCODE_ADD,
 	TOY_OPCODE_SUBTRACT,
@@ -34,11 +39,23 @@ typedef enum Toy_OpcodeType {
 	//various action instructions
 	TOY_OPCODE_PRINT,
 	TOY_OPCODE_CONCAT,
+	TOY_OPCODE_CONCAT_N, //[opcode, count, 0, 0] joins the top 'count' values, or [opcode, destination, first, count] for registers
 	//TODO: clear the program stack?
 
+	//superinstructions, fused by the compiler from a literal 'READ' and the instruction using it; the literal follows the first word
+	TOY_OPCODE_ARITHMETIC_IMM, //[opcode, type, arithmetic opcode, 0]
+	TOY_OPCODE_COMPARE_IMM, //[opcode, type, comparison opcode, negate]
+	TOY_OPCODE_PRINT_IMM, //[opcode, type, boolean, 0]
+
 	//meta instructions
 	TOY_OPCODE_PASS,
 	TOY_OPCODE_ERROR,
 	TOY_OPCODE_EOF = 255,
 } Toy_OpcodeType;
 
+//the instruction encodings a routine can be compiled to, recorded in the routine's header
+typedef enum Toy_RoutineBackend {
+	TOY_BACKEND_STACK, //operands are pushed and popped from the stack
+	TOY_BACKEND_REGISTER, //each instruction names its registers, as [opcode, destination, left, right]
+} Toy_RoutineBackend;
+
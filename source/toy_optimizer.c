@@ -0,0 +1,244 @@
+#include "toy_optimizer.h"
+#include "toy_console_colors.h"
+
+#include "toy_value.h"
+#include "toy_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+//NOTE: folding mirrors the VM's behaviour exactly; anything that would raise an error at runtime is left alone, so the VM can still report it
+
+static bool isNumber(Toy_Value value) {
+	return TOY_VALUE_IS_INTEGER(value) || TOY_VALUE_IS_FLOAT(value);
+}
+
+static bool foldArithmetic(Toy_AstFlag flag, Toy_Value left, Toy_Value right, Toy_Value* result) {
+	if (!isNumber(left) || !isNumber(right)) {
+		return false;
+	}
+
+	//divide by zero
+	if ((flag == TOY_AST_FLAG_DIVIDE || flag == TOY_AST_FLAG_MODULO) && ((TOY_VALUE_IS_INTEGER(right) && TOY_VALUE_AS_INTEGER(right) == 0) || (TOY_VALUE_IS_FLOAT(right) && TOY_VALUE_AS_FLOAT(right) == 0))) {
+		return false;
+	}
+
+	//modulo is only defined for integers
+	if (flag == TOY_AST_FLAG_MODULO && (TOY_VALUE_IS_FLOAT(left) || TOY_VALUE_IS_FLOAT(right))) {
+		return false;
+	}
+
+	//coerce ints into floats if needed
+	if (TOY_VALUE_IS_INTEGER(left) && TOY_VALUE_IS_FLOAT(right)) {
+		left = TOY_VALUE_FROM_FLOAT( (float)TOY_VALUE_AS_INTEGER(left) );
+	}
+	else
+	if (TOY_VALUE_IS_FLOAT(left) && TOY_VALUE_IS_INTEGER(right)) {
+		right = TOY_VALUE_FROM_FLOAT( (float)TOY_VALUE_AS_INTEGER(right) );
+	}
+
+	switch(flag) {
+		case TOY_AST_FLAG_ADD:
+			(*result) = TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_FROM_FLOAT( TOY_VALUE_AS_FLOAT(left) + TOY_VALUE_AS_FLOAT(right)) : TOY_VALUE_FROM_INTEGER( TOY_VALUE_AS_INTEGER(left) + TOY_VALUE_AS_INTEGER(right) );
+			return true;
+
+		case TOY_AST_FLAG_SUBTRACT:
+			(*result) = TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_FROM_FLOAT( TOY_VALUE_AS_FLOAT(left) - TOY_VALUE_AS_FLOAT(right)) : TOY_VALUE_FROM_INTEGER( TOY_VALUE_AS_INTEGER(left) - TOY_VALUE_AS_INTEGER(right) );
+			return true;
+
+		case TOY_AST_FLAG_MULTIPLY:
+			(*result) = TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_FROM_FLOAT( TOY_VALUE_AS_FLOAT(left) * TOY_VALUE_AS_FLOAT(right)) : TOY_VALUE_FROM_INTEGER( TOY_VALUE_AS_INTEGER(left) * TOY_VALUE_AS_INTEGER(right) );
+			return true;
+
+		case TOY_AST_FLAG_DIVIDE:
+			(*result) = TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_FROM_FLOAT( TOY_VALUE_AS_FLOAT(left) / TOY_VALUE_AS_FLOAT(right)) : TOY_VALUE_FROM_INTEGER( TOY_VALUE_AS_INTEGER(left) / TOY_VALUE_AS_INTEGER(right) );
+			return true;
+
+		case TOY_AST_FLAG_MODULO:
+			(*result) = TOY_VALUE_FROM_INTEGER( TOY_VALUE_AS_INTEGER(left) % TOY_VALUE_AS_INTEGER(right) );
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static bool foldComparison(Toy_AstFlag flag, Toy_Value left, Toy_Value right, Toy_Value* result) {
+	//most things can be equal, so handle it separately
+	if (flag == TOY_AST_FLAG_COMPARE_EQUAL || flag == TOY_AST_FLAG_COMPARE_NOT) {
+		bool equal = TOY_VALUES_ARE_EQUAL(left, right);
+		(*result) = TOY_VALUE_FROM_BOOLEAN(flag == TOY_AST_FLAG_COMPARE_EQUAL ? equal : !equal);
+		return true;
+	}
+
+	//ordering is only defined for numbers
+	if (!isNumber(left) || !isNumber(right)) {
+		return false;
+	}
+
+	//coerce ints into floats if needed
+	if (TOY_VALUE_IS_INTEGER(left) && TOY_VALUE_IS_FLOAT(right)) {
+		left = TOY_VALUE_FROM_FLOAT( (float)TOY_VALUE_AS_INTEGER(left) );
+	}
+	else
+	if (TOY_VALUE_IS_FLOAT(left) && TOY_VALUE_IS_INTEGER(right)) {
+		right = TOY_VALUE_FROM_FLOAT( (float)TOY_VALUE_AS_INTEGER(right) );
+	}
+
+	switch(flag) {
+		case TOY_AST_FLAG_COMPARE_LESS:
+			(*result) = TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) < TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) < TOY_VALUE_AS_INTEGER(right));
+			return true;
+
+		case TOY_AST_FLAG_COMPARE_LESS_EQUAL:
+			(*result) = TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) <= TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) <= TOY_VALUE_AS_INTEGER(right));
+			return true;
+
+		case TOY_AST_FLAG_COMPARE_GREATER:
+			(*result) = TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) > TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) > TOY_VALUE_AS_INTEGER(right));
+			return true;
+
+		case TOY_AST_FLAG_COMPARE_GREATER_EQUAL:
+			(*result) = TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) >= TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) >= TOY_VALUE_AS_INTEGER(right));
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static bool foldLogical(Toy_AstFlag flag, Toy_Value left, Toy_Value right, Toy_Value* result) {
+	//null is neither true nor false
+	if (TOY_VALUE_IS_NULL(left) || TOY_VALUE_IS_NULL(right)) {
+		return false;
+	}
+
+	if (flag == TOY_AST_FLAG_AND) {
+		(*result) = TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(left) && TOY_VALUE_IS_TRUTHY(right) );
+		return true;
+	}
+	else if (flag == TOY_AST_FLAG_OR) {
+		(*result) = TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(left) || TOY_VALUE_IS_TRUTHY(right) );
+		return true;
+	}
+
+	return false;
+}
+
+static bool foldConcat(Toy_Bucket** bucketHandle, Toy_Value left, Toy_Value right, Toy_Value* result) {
+	if (!TOY_VALUE_IS_STRING(left) || !TOY_VALUE_IS_STRING(right)) {
+		return false;
+	}
+
+	(*result) = TOY_VALUE_FROM_STRING(Toy_concatStrings(bucketHandle, TOY_VALUE_AS_STRING(left), TOY_VALUE_AS_STRING(right)));
+	return true;
+}
+
+static void foldUnary(Toy_Ast* ast) {
+	if (ast->unary.child->type != TOY_AST_VALUE) {
+		return;
+	}
+
+	Toy_Value value = ast->unary.child->value.value;
+
+	//'negate' is a logical not, and null is neither true nor false
+	if (ast->unary.flag == TOY_AST_FLAG_NEGATE && !TOY_VALUE_IS_NULL(value)) {
+		ast->type = TOY_AST_VALUE;
+		ast->value.value = TOY_VALUE_FROM_BOOLEAN( !TOY_VALUE_IS_TRUTHY(value) );
+	}
+}
+
+static void foldBinary(Toy_Bucket** bucketHandle, Toy_Ast* ast) {
+	if (ast->binary.left->type != TOY_AST_VALUE || ast->binary.right->type != TOY_AST_VALUE) {
+		return;
+	}
+
+	Toy_AstFlag flag = ast->binary.flag;
+	Toy_Value left = ast->binary.left->value.value;
+	Toy_Value right = ast->binary.right->value.value;
+	Toy_Value result = TOY_VALUE_FROM_NULL();
+	bool folded = false;
+
+	if (flag >= TOY_AST_FLAG_ADD && flag <= TOY_AST_FLAG_MODULO) {
+		folded = foldArithmetic(flag, left, right, &result);
+	}
+	else if (flag >= TOY_AST_FLAG_COMPARE_EQUAL && flag <= TOY_AST_FLAG_COMPARE_GREATER_EQUAL) {
+		folded = foldComparison(flag, left, right, &result);
+	}
+	else if (flag == TOY_AST_FLAG_AND || flag == TOY_AST_FLAG_OR) {
+		folded = foldLogical(flag, left, right, &result);
+	}
+	else if (flag == TOY_AST_FLAG_CONCAT) {
+		folded = foldConcat(bucketHandle, left, right, &result);
+	}
+
+	//the children are left behind in the bucket
+	if (folded) {
+		ast->type = TOY_AST_VALUE;
+		ast->value.value = result;
+	}
+}
+
+static void optimizeNode(Toy_Bucket** bucketHandle, Toy_Ast* ast) {
+	if (ast == NULL) {
+		return;
+	}
+
+	switch(ast->type) {
+		case TOY_AST_BLOCK:
+			//walk the list rather than recursing, as it can get long
+			for (Toy_Ast* iter = ast; iter != NULL; iter = iter->block.next) {
+				optimizeNode(bucketHandle, iter->block.child);
+			}
+			break;
+
+		case TOY_AST_UNARY:
+			optimizeNode(bucketHandle, ast->unary.child);
+			foldUnary(ast);
+			break;
+
+		case TOY_AST_BINARY:
+			//assignments write to the left, so only the right can be folded
+			optimizeNode(bucketHandle, ast->binary.right);
+
+			if (ast->binary.flag < TOY_AST_FLAG_ASSIGN || ast->binary.flag > TOY_AST_FLAG_MODULO_ASSIGN) {
+				optimizeNode(bucketHandle, ast->binary.left);
+				foldBinary(bucketHandle, ast);
+			}
+			break;
+
+		case TOY_AST_GROUP:
+			//groups only matter to the parser, so replace this node with its contents
+			optimizeNode(bucketHandle, ast->group.child);
+			(*ast) = (*ast->group.child);
+			break;
+
+		case TOY_AST_SCOPE:
+			optimizeNode(bucketHandle, ast->scope.child);
+			break;
+
+		case TOY_AST_PRINT:
+			optimizeNode(bucketHandle, ast->print.child);
+			break;
+
+		case TOY_AST_VAR_DECLARE:
+			optimizeNode(bucketHandle, ast->varDeclare.expr);
+			break;
+
+		case TOY_AST_VALUE:
+		case TOY_AST_VAR_ACCESS:
+		case TOY_AST_PASS:
+		case TOY_AST_ERROR:
+		case TOY_AST_END:
+			break;
+
+		default:
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid AST type found: Unknown 'type' %d in the optimizer\n" TOY_CC_RESET, ast->type);
+			exit(-1);
+	}
+}
+
+//exposed functions
+void Toy_optimizeAst(Toy_Bucket** bucketHandle, Toy_Ast* ast) {
+	optimizeNode(bucketHandle, ast);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "toy_common.h"
+
+#include "toy_bucket.h"
+#include "toy_ast.h"
+
+//rewrites the AST in place before compilation - folds expressions made only of literals, and strips groups
+TOY_API void Toy_optimizeAst(Toy_Bucket** bucketHandle, Toy_Ast* ast);
@@ -111,6 +111,7 @@ typedef struct ParsingTuple {
 static void parsePrecedence(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle, ParsingPrecedence precRule);
 
 static Toy_AstFlag literal(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle);
+static Toy_AstFlag variable(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle);
 static Toy_AstFlag unary(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle);
 static Toy_AstFlag binary(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle);
 static Toy_AstFlag group(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle);
@@ -120,7 +121,7 @@ static ParsingTuple parsingRulesetTable[] = {
 	{PREC_PRIMARY,literal,NULL},// TOY_TOKEN_NULL,
 
 	//variable names
-	{PREC_NONE,NULL,NULL},// TOY_TOKEN_NAME,
+	{PREC_PRIMARY,variable,NULL},// TOY_TOKEN_NAME,
 
 	//types
 	{PREC_NONE,NULL,NULL},// TOY_TOKEN_TYPE_TYPE,
@@ -308,6 +309,26 @@ static Toy_AstFlag literal(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_As
 	}
 }
 
+static Toy_AstFlag variable(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle) {
+	if (parser->previous.type != TOY_TOKEN_NAME) {
+		printError(parser, parser->previous, "Unexpected token passed to variable precedence rule");
+		Toy_private_emitAstError(bucketHandle, rootHandle);
+		return TOY_AST_FLAG_NONE;
+	}
+
+	if (parser->previous.length > 256) {
+		printError(parser, parser->previous, "Can't have a variable name longer than 256 characters");
+		Toy_private_emitAstError(bucketHandle, rootHandle);
+		return TOY_AST_FLAG_NONE;
+	}
+
+	//the type is only known at the declaration
+	Toy_String* nameStr = Toy_createNameStringLength(bucketHandle, parser->previous.lexeme, parser->previous.length, TOY_VALUE_NULL);
+	Toy_private_emitAstVariableAccess(bucketHandle, rootHandle, nameStr);
+
+	return TOY_AST_FLAG_NONE;
+}
+
 static Toy_AstFlag unary(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle) {
 	//'subtract' can only be applied to numbers and groups, while 'negate' can only be applied to booleans and groups
 
@@ -503,6 +524,13 @@ static void parsePrecedence(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_A
 			return;
 		}
 
+		//only variables can be assigned to
+		if (flag >= TOY_AST_FLAG_ASSIGN && flag <= TOY_AST_FLAG_MODULO_ASSIGN && (*rootHandle)->type != TOY_AST_VAR_ACCESS) {
+			printError(parser, parser->previous, "Invalid assignment target");
+			Toy_private_emitAstError(bucketHandle, rootHandle);
+			return;
+		}
+
 		Toy_private_emitAstBinary(bucketHandle, rootHandle, flag, ptr);
 	}
 
@@ -556,10 +584,39 @@ static void makeVariableDeclarationStmt(Toy_Bucket** bucketHandle, Toy_Parser* p
 
 	//finally, emit the declaration as an Ast
 	Toy_private_emitAstVariableDeclaration(bucketHandle, rootHandle, nameStr, expr);
+
+	consume(parser, TOY_TOKEN_OPERATOR_SEMICOLON, "Expected ';' at the end of var statement");
+}
+
+static void makeDeclarationStmt(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle); //forward declare for recursion
+
+static void makeScopeStmt(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle) {
+	//begin the block
+	Toy_private_initAstBlock(bucketHandle, rootHandle);
+
+	//read a series of statements into the block, until the closing brace
+	while (!match(parser, TOY_TOKEN_OPERATOR_BRACE_RIGHT)) {
+		if (parser->current.type == TOY_TOKEN_EOF) {
+			printError(parser, parser->current, "Expected '}' at the end of block");
+			return;
+		}
+
+		Toy_Ast* stmt = NULL;
+		makeDeclarationStmt(bucketHandle, parser, &stmt);
+
+		//if something went wrong, leave it to the outermost block
+		if (parser->panic) {
+			return;
+		}
+
+		Toy_private_appendAstBlock(bucketHandle, *rootHandle, stmt);
+	}
+
+	//the block's variables are local to it
+	Toy_private_emitAstScope(bucketHandle, rootHandle);
 }
 
 static void makeStmt(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** rootHandle) {
-	//block
 	//assert
 	//if-then-else
 	//while-then
@@ -575,6 +632,11 @@ static void makeStmt(Toy_Bucket** bucketHandle, Toy_Parser* parser, Toy_Ast** ro
 		return;
 	}
 
+	else if (match(parser, TOY_TOKEN_OPERATOR_BRACE_LEFT)) {
+		makeScopeStmt(bucketHandle, parser, rootHandle);
+		return;
+	}
+
 	else if (match(parser, TOY_TOKEN_KEYWORD_PRINT)) {
 		makePrintStmt(bucketHandle, parser, rootHandle);
 		return;
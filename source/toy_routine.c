@@ -4,7 +4,9 @@
 #include "toy_opcodes.h"
 #include "toy_value.h"
 #include "toy_string.h"
+#include "toy_print.h"
 
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -53,47 +55,143 @@ static void emitFloat(void** handle, unsigned int* capacity, unsigned int* count
 #define EMIT_FLOAT(rt, part, bytes) \
 	emitFloat((void**)(&((*rt)->part)), &((*rt)->part##Capacity), &((*rt)->part##Count), bytes);
 
-static void emitToJumpTable(Toy_Routine** rt, unsigned int startAddr) {
-	EMIT_INT(rt, code, (*rt)->jumpsCount); //mark the jump index in the code
-	EMIT_INT(rt, jumps, startAddr); //save address at the jump index
+static bool matchesData(const char* existing, Toy_String* str) {
+	Toy_StringIterator iter;
+	Toy_initStringIterator(&iter, str);
+
+	//strncmp stops at the existing string's terminator, so it never reads past the entry
+	while (Toy_nextStringChunk(&iter)) {
+		if (strncmp(existing, iter.chunk, iter.length) != 0) {
+			return false;
+		}
+		existing += iter.length;
+	}
+
+	return *existing == '\0';
 }
 
 static void emitString(Toy_Routine** rt, Toy_String* str) {
-	//4-byte alignment
-	unsigned int length = str->length + 1;
-	if (length % 4 != 0) {
-		length += 4 - (length % 4); //ceil
+	//identical strings share one entry, so the VM only builds each name or literal once
+	//names and literals can't be compared directly, so they're found by hash, then checked against the data - a collision just gets its own entry
+	Toy_Value hash = TOY_VALUE_FROM_INTEGER((int)Toy_hashString(str));
+	Toy_Value existing = Toy_lookupTable(&(*rt)->strings, hash);
+	unsigned int index = (*rt)->jumpsCount / sizeof(unsigned int);
+
+	if (TOY_VALUE_IS_INTEGER(existing) && matchesData((const char*)((*rt)->data + (*rt)->jumps[TOY_VALUE_AS_INTEGER(existing)]), str)) {
+		index = TOY_VALUE_AS_INTEGER(existing);
 	}
+	else {
+		//4-byte alignment
+		unsigned int length = str->length + 1;
+		if (length % 4 != 0) {
+			length += 4 - (length % 4); //ceil
+		}
+
+#if TOY_ROUTINE_DATA_HASHES
+		//the length and raw hash come first, while the jump still points at the characters
+		expand((void**)(&((*rt)->data)), &((*rt)->dataCapacity), &((*rt)->dataCount), sizeof(unsigned int) * 2);
+
+		Toy_hashString(str);
+		unsigned int prefix[2] = { str->length, str->cachedHash };
+		memcpy((*rt)->data + (*rt)->dataCount, prefix, sizeof(prefix));
+		(*rt)->dataCount += sizeof(prefix);
+#endif
 
-	//grab the current start address
-	unsigned int startAddr = (*rt)->dataCount;
+		//grab the current start address
+		unsigned int startAddr = (*rt)->dataCount;
 
-	//move the string into the data section
-	expand((void**)(&((*rt)->data)), &((*rt)->dataCapacity), &((*rt)->dataCount), (*rt)->dataCount + length);
+		//move the string into the data section one chunk at a time, padding included
+		expand((void**)(&((*rt)->data)), &((*rt)->dataCapacity), &((*rt)->dataCount), length);
 
-	if (str->type == TOY_STRING_NODE) {
-		char* buffer = Toy_getStringRawBuffer(str);
-		memcpy((*rt)->data + (*rt)->dataCount, buffer, str->length + 1);
-		free(buffer);
+		Toy_StringIterator iter;
+		Toy_initStringIterator(&iter, str);
+
+		while (Toy_nextStringChunk(&iter)) {
+			memcpy((*rt)->data + (*rt)->dataCount, iter.chunk, iter.length);
+			(*rt)->dataCount += iter.length;
+		}
+
+		memset((*rt)->data + (*rt)->dataCount, 0, length - str->length);
+		(*rt)->dataCount += length - str->length;
+
+		//save the address at the new index
+		EMIT_INT(rt, jumps, startAddr);
+
+		if (TOY_VALUE_IS_NULL(existing)) {
+			Toy_insertTable(&(*rt)->strings, hash, TOY_VALUE_FROM_INTEGER(index));
+		}
 	}
-	else if (str->type == TOY_STRING_LEAF) {
-		memcpy((*rt)->data + (*rt)->dataCount, str->as.leaf.data, str->length + 1);
+
+	//mark the index in the code
+	EMIT_INT(rt, code, index);
+}
+
+static void emitSlot(Toy_Routine** rt, unsigned int slot) {
+	//slots fill the second half of their instruction's word
+	unsigned short bytes = (unsigned short)slot;
+	char* ptr = (char*)&bytes;
+	EMIT_BYTE(rt, code, *(ptr++));
+	EMIT_BYTE(rt, code, *(ptr++));
+}
+
+static int resolveLocal(Toy_Routine** rt, Toy_String* name, unsigned int lowest) {
+	//search the innermost scopes first, so shadowing works
+	for (int i = (int)(*rt)->localsCount - 1; i >= (int)lowest; i--) {
+		if (Toy_equalStrings((*rt)->locals[i], name)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static unsigned int pushLocal(Toy_Routine** rt, Toy_String* name) {
+	if ((*rt)->localsCount >= TOY_ROUTINE_MAX_SLOTS) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Too many local variables in one routine, the maximum is %d\n" TOY_CC_RESET, TOY_ROUTINE_MAX_SLOTS);
+		exit(-1);
 	}
-	else if (str->type == TOY_STRING_NAME) {
-		memcpy((*rt)->data + (*rt)->dataCount, str->as.name.data, str->length + 1);
+
+	if ((*rt)->localsCount + 1 > (*rt)->localsCapacity) {
+		(*rt)->localsCapacity = (*rt)->localsCapacity < 8 ? 8 : (*rt)->localsCapacity * 2;
+		(*rt)->locals = realloc((*rt)->locals, (*rt)->localsCapacity * sizeof(Toy_String*));
+
+		if ((*rt)->locals == NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to allocate %d space for the locals of 'Toy_Routine'\n" TOY_CC_RESET, (int)((*rt)->localsCapacity));
+			exit(1);
+		}
 	}
 
-	(*rt)->dataCount += length;
+	(*rt)->locals[(*rt)->localsCount] = name;
+	return (*rt)->localsCount++;
+}
 
-	//mark the jump position
-	emitToJumpTable(rt, startAddr);
+static unsigned int declareLocal(Toy_Routine** rt, Toy_String* name) {
+	if (resolveLocal(rt, name, (*rt)->scopeStart) >= 0) {
+		char buffer[name->length + 256];
+		sprintf(buffer, "Can't redefine a variable: %s", name->as.name.data);
+		Toy_error(buffer);
+	}
+
+	return pushLocal(rt, name);
 }
 
 static void writeRoutineCode(Toy_Routine** rt, Toy_Ast* ast); //forward declare for recursion
+static void writeInstructionVarAccess(Toy_Routine** rt, Toy_AstVarAccess ast);
+
+//track the depth of the stack, so the VM can reserve it all up front
+static void adjustStack(Toy_Routine** rt, int delta) {
+	(*rt)->stackCount += delta;
+
+	if ((*rt)->stackMax < (*rt)->stackCount) {
+		(*rt)->stackMax = (*rt)->stackCount;
+	}
+}
 
 static void writeInstructionValue(Toy_Routine** rt, Toy_AstValue ast) {
+	adjustStack(rt, 1);
+
 	EMIT_BYTE(rt, code, TOY_OPCODE_READ);
-	EMIT_BYTE(rt, code, ast.value.type);
+	EMIT_BYTE(rt, code, TOY_VALUE_GET_TYPE(ast.value));
 
 	//emit the raw value based on the type
 	if (TOY_VALUE_IS_NULL(ast.value)) {
@@ -154,10 +252,113 @@ static void writeInstructionUnary(Toy_Routine** rt, Toy_AstUnary ast) {
 	}
 }
 
+static void writeInstructionAssign(Toy_Routine** rt, Toy_AstBinary ast) {
+	//the parser ensures the target is a variable
+	Toy_String* name = ast.left->varAccess.name;
+
+	//compound assignments read the variable first
+	if (ast.flag != TOY_AST_FLAG_ASSIGN) {
+		writeInstructionVarAccess(rt, ast.left->varAccess);
+	}
+
+	writeRoutineCode(rt, ast.right);
+
+	if (ast.flag == TOY_AST_FLAG_ADD_ASSIGN) {
+		EMIT_BYTE(rt, code,TOY_OPCODE_ADD);
+	}
+	else if (ast.flag == TOY_AST_FLAG_SUBTRACT_ASSIGN) {
+		EMIT_BYTE(rt, code,TOY_OPCODE_SUBTRACT);
+	}
+	else if (ast.flag == TOY_AST_FLAG_MULTIPLY_ASSIGN) {
+		EMIT_BYTE(rt, code,TOY_OPCODE_MULTIPLY);
+	}
+	else if (ast.flag == TOY_AST_FLAG_DIVIDE_ASSIGN) {
+		EMIT_BYTE(rt, code,TOY_OPCODE_DIVIDE);
+	}
+	else if (ast.flag == TOY_AST_FLAG_MODULO_ASSIGN) {
+		EMIT_BYTE(rt, code,TOY_OPCODE_MODULO);
+	}
+
+	if (ast.flag != TOY_AST_FLAG_ASSIGN) {
+		//4-byte alignment
+		EMIT_BYTE(rt, code,0);
+		EMIT_BYTE(rt, code,0);
+		EMIT_BYTE(rt, code,0);
+
+		adjustStack(rt, -1);
+	}
+
+	//store TOP(S) within the variable
+	adjustStack(rt, -1);
+
+	int slot = resolveLocal(rt, name, 0);
+
+	if (slot >= 0) {
+		EMIT_BYTE(rt, code, TOY_OPCODE_ASSIGN_SLOT);
+		EMIT_BYTE(rt, code, 0);
+		emitSlot(rt, slot);
+	}
+	else {
+		EMIT_BYTE(rt, code, TOY_OPCODE_ASSIGN);
+		EMIT_BYTE(rt, code, 0);
+		EMIT_BYTE(rt, code, name->length); //quick optimisation to skip a 'strlen()' call
+		EMIT_BYTE(rt, code, 0);
+
+		emitString(rt, name);
+	}
+}
+
+//chains like 'a .. b .. c' are flattened into a single instruction, which can join them all at once
+static void emitConcatN(Toy_Routine** rt, unsigned int count) {
+	EMIT_BYTE(rt, code, count == 2 ? TOY_OPCODE_CONCAT : TOY_OPCODE_CONCAT_N);
+	EMIT_BYTE(rt, code, count == 2 ? 0 : count);
+	EMIT_BYTE(rt, code, 0);
+	EMIT_BYTE(rt, code, 0);
+
+	adjustStack(rt, 1 - (int)count);
+}
+
+static void writeConcatOperands(Toy_Routine** rt, Toy_Ast* ast, unsigned int* count) {
+	if (ast->type == TOY_AST_BINARY && ast->binary.flag == TOY_AST_FLAG_CONCAT) {
+		writeConcatOperands(rt, ast->binary.left, count);
+		writeConcatOperands(rt, ast->binary.right, count);
+		return;
+	}
+
+	if (ast->type == TOY_AST_GROUP) {
+		writeConcatOperands(rt, ast->group.child, count);
+		return;
+	}
+
+	//more operands than one instruction can count are joined early, leaving one behind
+	if ((*count) == UCHAR_MAX) {
+		emitConcatN(rt, *count);
+		(*count) = 1;
+	}
+
+	writeRoutineCode(rt, ast);
+	(*count)++;
+}
+
 static void writeInstructionBinary(Toy_Routine** rt, Toy_AstBinary ast) {
-	//left, then right, then the binary's operation
+	//assignments write to the left, rather than reading it
+	if (ast.flag >= TOY_AST_FLAG_ASSIGN && ast.flag <= TOY_AST_FLAG_MODULO_ASSIGN) {
+		writeInstructionAssign(rt, ast);
+		return;
+	}
+
+	if (ast.flag == TOY_AST_FLAG_CONCAT) {
+		unsigned int count = 0;
+		writeConcatOperands(rt, ast.left, &count);
+		writeConcatOperands(rt, ast.right, &count);
+		emitConcatN(rt, count);
+		return;
+	}
+
+	//left, then right, then the binary's operation, which leaves one value behind
 	writeRoutineCode(rt, ast.left);
 	writeRoutineCode(rt, ast.right);
+	adjustStack(rt, -1);
 
 	if (ast.flag == TOY_AST_FLAG_ADD) {
 		EMIT_BYTE(rt, code,TOY_OPCODE_ADD);
@@ -175,36 +376,6 @@ static void writeInstructionBinary(Toy_Routine** rt, Toy_AstBinary ast) {
 		EMIT_BYTE(rt, code,TOY_OPCODE_MODULO);
 	}
 
-	// else if (ast.flag == TOY_AST_FLAG_ASSIGN) {
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_ASSIGN);
-	// 	//TODO: emit the env symbol to store TOP(S) within
-	// }
-	// else if (ast.flag == TOY_AST_FLAG_ADD_ASSIGN) {
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_ADD);
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_ASSIGN);
-	// 	//TODO: emit the env symbol to store TOP(S) within
-	// }
-	// else if (ast.flag == TOY_AST_FLAG_SUBTRACT_ASSIGN) {
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_SUBTRACT);
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_ASSIGN);
-	// 	//TODO: emit the env symbol to store TOP(S) within
-	// }
-	// else if (ast.flag == TOY_AST_FLAG_MULTIPLY_ASSIGN) {
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_MULTIPLY);
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_ASSIGN);
-	// 	//TODO: emit the env symbol to store TOP(S) within
-	// }
-	// else if (ast.flag == TOY_AST_FLAG_DIVIDE_ASSIGN) {
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_DIVIDE);
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_ASSIGN);
-	// 	//TODO: emit the env symbol to store TOP(S) within
-	// }
-	// else if (ast.flag == TOY_AST_FLAG_MODULO_ASSIGN) {
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_MODULO);
-	// 	EMIT_BYTE(rt, code,TOY_OPCODE_ASSIGN);
-	// 	//TODO: emit the env symbol to store TOP(S) within
-	// }
-
 	else if (ast.flag == TOY_AST_FLAG_COMPARE_EQUAL) {
 		EMIT_BYTE(rt, code,TOY_OPCODE_COMPARE_EQUAL);
 	}
@@ -235,9 +406,6 @@ static void writeInstructionBinary(Toy_Routine** rt, Toy_AstBinary ast) {
 	else if (ast.flag == TOY_AST_FLAG_OR) {
 		EMIT_BYTE(rt, code,TOY_OPCODE_OR);
 	}
-	else if (ast.flag == TOY_AST_FLAG_CONCAT) {
-		EMIT_BYTE(rt, code, TOY_OPCODE_CONCAT);
-	}
 	else {
 		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid AST binary flag found\n" TOY_CC_RESET);
 		exit(-1);
@@ -259,6 +427,7 @@ static void writeInstructionPrint(Toy_Routine** rt, Toy_AstPrint ast) {
 
 	//output the print opcode
 	EMIT_BYTE(rt, code,TOY_OPCODE_PRINT);
+	adjustStack(rt, -1);
 
 	//4-byte alignment
 	EMIT_BYTE(rt, code,0);
@@ -266,9 +435,34 @@ static void writeInstructionPrint(Toy_Routine** rt, Toy_AstPrint ast) {
 	EMIT_BYTE(rt, code,0);
 }
 
+static void writeInstructionScope(Toy_Routine** rt, Toy_AstScope ast) {
+	unsigned int scopeStart = (*rt)->scopeStart;
+
+	(*rt)->scopeDepth++;
+	(*rt)->scopeStart = (*rt)->localsCount;
+
+	writeRoutineCode(rt, ast.child);
+
+	//forget this scope's locals, so their slots can be reused
+	(*rt)->localsCount = (*rt)->scopeStart;
+	(*rt)->registersCount = (*rt)->localsCount;
+	(*rt)->scopeStart = scopeStart;
+	(*rt)->scopeDepth--;
+}
+
 static void writeInstructionVarDeclare(Toy_Routine** rt, Toy_AstVarDeclare ast) {
 	//initial value
 	writeRoutineCode(rt, ast.expr);
+	adjustStack(rt, -1);
+
+	//locals are given a slot instead
+	if ((*rt)->scopeDepth > 0) {
+		EMIT_BYTE(rt, code, TOY_OPCODE_DECLARE_SLOT);
+		EMIT_BYTE(rt, code, Toy_getNameStringType(ast.name));
+		emitSlot(rt, declareLocal(rt, ast.name));
+
+		return;
+	}
 
 	//delcare with the given name string
 	EMIT_BYTE(rt, code, TOY_OPCODE_DECLARE);
@@ -279,6 +473,351 @@ static void writeInstructionVarDeclare(Toy_Routine** rt, Toy_AstVarDeclare ast)
 	emitString(rt, ast.name);
 }
 
+static void writeInstructionVarAccess(Toy_Routine** rt, Toy_AstVarAccess ast) {
+	adjustStack(rt, 1);
+
+	int slot = resolveLocal(rt, ast.name, 0);
+
+	//locals are read from their slot
+	if (slot >= 0) {
+		EMIT_BYTE(rt, code, TOY_OPCODE_ACCESS_SLOT);
+		EMIT_BYTE(rt, code, 0);
+		emitSlot(rt, slot);
+
+		return;
+	}
+
+	//anything else is looked up by name
+	EMIT_BYTE(rt, code, TOY_OPCODE_ACCESS);
+	EMIT_BYTE(rt, code, 0);
+	EMIT_BYTE(rt, code, ast.name->length); //quick optimisation to skip a 'strlen()' call
+	EMIT_BYTE(rt, code, 0);
+
+	emitString(rt, ast.name);
+}
+
+//register backend, each expression writes its result into a register and returns which one
+static void writeRegisterWord(Toy_Routine** rt, Toy_OpcodeType opcode, unsigned int a, unsigned int b, unsigned int c) {
+	EMIT_BYTE(rt, code, opcode);
+	EMIT_BYTE(rt, code, a);
+	EMIT_BYTE(rt, code, b);
+	EMIT_BYTE(rt, code, c);
+}
+
+static unsigned int targetRegister(Toy_Routine** rt, int target) {
+	//use the requested register, otherwise the next free temporary
+	unsigned int reg = target >= 0 ? (unsigned int)target : (*rt)->registersCount++;
+
+	if (reg + 1 > (*rt)->registersMax) {
+		(*rt)->registersMax = reg + 1;
+	}
+
+	return reg;
+}
+
+static Toy_OpcodeType registerOpcode(Toy_AstFlag flag) {
+	switch(flag) {
+		case TOY_AST_FLAG_ADD:
+		case TOY_AST_FLAG_ADD_ASSIGN:
+			return TOY_OPCODE_ADD;
+
+		case TOY_AST_FLAG_SUBTRACT:
+		case TOY_AST_FLAG_SUBTRACT_ASSIGN:
+			return TOY_OPCODE_SUBTRACT;
+
+		case TOY_AST_FLAG_MULTIPLY:
+		case TOY_AST_FLAG_MULTIPLY_ASSIGN:
+			return TOY_OPCODE_MULTIPLY;
+
+		case TOY_AST_FLAG_DIVIDE:
+		case TOY_AST_FLAG_DIVIDE_ASSIGN:
+			return TOY_OPCODE_DIVIDE;
+
+		case TOY_AST_FLAG_MODULO:
+		case TOY_AST_FLAG_MODULO_ASSIGN:
+			return TOY_OPCODE_MODULO;
+
+		case TOY_AST_FLAG_COMPARE_EQUAL:
+		case TOY_AST_FLAG_COMPARE_NOT: //followed by a negate
+			return TOY_OPCODE_COMPARE_EQUAL;
+
+		case TOY_AST_FLAG_COMPARE_LESS:
+			return TOY_OPCODE_COMPARE_LESS;
+
+		case TOY_AST_FLAG_COMPARE_LESS_EQUAL:
+			return TOY_OPCODE_COMPARE_LESS_EQUAL;
+
+		case TOY_AST_FLAG_COMPARE_GREATER:
+			return TOY_OPCODE_COMPARE_GREATER;
+
+		case TOY_AST_FLAG_COMPARE_GREATER_EQUAL:
+			return TOY_OPCODE_COMPARE_GREATER_EQUAL;
+
+		case TOY_AST_FLAG_AND:
+			return TOY_OPCODE_AND;
+
+		case TOY_AST_FLAG_OR:
+			return TOY_OPCODE_OR;
+
+		case TOY_AST_FLAG_CONCAT:
+			return TOY_OPCODE_CONCAT;
+
+		default:
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid AST binary flag found\n" TOY_CC_RESET);
+			exit(-1);
+	}
+}
+
+static unsigned int writeRegisterExpression(Toy_Routine** rt, Toy_Ast* ast, int target); //forward declare for recursion
+
+static unsigned int writeRegisterValue(Toy_Routine** rt, Toy_AstValue ast, int target) {
+	unsigned int dst = targetRegister(rt, target);
+
+	EMIT_BYTE(rt, code, TOY_OPCODE_READ);
+	EMIT_BYTE(rt, code, TOY_VALUE_GET_TYPE(ast.value));
+	EMIT_BYTE(rt, code, dst);
+	EMIT_BYTE(rt, code, TOY_VALUE_IS_BOOLEAN(ast.value) ? TOY_VALUE_AS_BOOLEAN(ast.value) : 0);
+
+	//larger values follow the first word, same as the stack backend
+	if (TOY_VALUE_IS_INTEGER(ast.value)) {
+		EMIT_INT(rt, code, TOY_VALUE_AS_INTEGER(ast.value));
+	}
+	else if (TOY_VALUE_IS_FLOAT(ast.value)) {
+		EMIT_FLOAT(rt, code, TOY_VALUE_AS_FLOAT(ast.value));
+	}
+	else if (TOY_VALUE_IS_STRING(ast.value)) {
+		emitString(rt, TOY_VALUE_AS_STRING(ast.value));
+	}
+	else if (!TOY_VALUE_IS_NULL(ast.value) && !TOY_VALUE_IS_BOOLEAN(ast.value)) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid AST type found: Unknown value type\n" TOY_CC_RESET);
+		exit(-1);
+	}
+
+	return dst;
+}
+
+static unsigned int writeRegisterUnary(Toy_Routine** rt, Toy_AstUnary ast, int target) {
+	if (ast.flag != TOY_AST_FLAG_NEGATE) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid AST unary flag found\n" TOY_CC_RESET);
+		exit(-1);
+	}
+
+	unsigned int top = (*rt)->registersCount;
+	unsigned int src = writeRegisterExpression(rt, ast.child, -1);
+	(*rt)->registersCount = top;
+
+	unsigned int dst = targetRegister(rt, target);
+	writeRegisterWord(rt, TOY_OPCODE_NEGATE, dst, src, 0);
+
+	return dst;
+}
+
+static unsigned int writeRegisterVarAccess(Toy_Routine** rt, Toy_AstVarAccess ast, int target) {
+	int slot = resolveLocal(rt, ast.name, 0);
+
+	//locals already live in a register
+	if (slot >= 0) {
+		return slot;
+	}
+
+	//anything else is looked up by name
+	unsigned int dst = targetRegister(rt, target);
+
+	writeRegisterWord(rt, TOY_OPCODE_ACCESS, dst, ast.name->length, 0);
+	emitString(rt, ast.name);
+
+	return dst;
+}
+
+static unsigned int writeRegisterAssign(Toy_Routine** rt, Toy_AstBinary ast) {
+	//the parser ensures the target is a variable
+	Toy_String* name = ast.left->varAccess.name;
+	int slot = resolveLocal(rt, name, 0);
+
+	unsigned int top = (*rt)->registersCount;
+
+	//locals are written in place
+	if (slot >= 0) {
+		if (ast.flag == TOY_AST_FLAG_ASSIGN) {
+			writeRegisterExpression(rt, ast.right, slot);
+		}
+		else {
+			unsigned int right = writeRegisterExpression(rt, ast.right, -1);
+			writeRegisterWord(rt, registerOpcode(ast.flag), slot, slot, right);
+		}
+
+		(*rt)->registersCount = top;
+		return slot;
+	}
+
+	//globals are read and written by name
+	unsigned int src;
+
+	if (ast.flag == TOY_AST_FLAG_ASSIGN) {
+		src = writeRegisterExpression(rt, ast.right, -1);
+	}
+	else {
+		src = writeRegisterVarAccess(rt, ast.left->varAccess, -1);
+		unsigned int right = writeRegisterExpression(rt, ast.right, -1);
+		writeRegisterWord(rt, registerOpcode(ast.flag), src, src, right);
+	}
+
+	writeRegisterWord(rt, TOY_OPCODE_ASSIGN, src, name->length, 0);
+	emitString(rt, name);
+
+	(*rt)->registersCount = top;
+	return src;
+}
+
+static bool isConcatChain(Toy_Ast* ast) {
+	while (ast->type == TOY_AST_GROUP) {
+		ast = ast->group.child;
+	}
+
+	return ast->type == TOY_AST_BINARY && ast->binary.flag == TOY_AST_FLAG_CONCAT;
+}
+
+//the operands of a flattened concatenation are evaluated into consecutive registers
+static void writeRegisterConcatOperands(Toy_Routine** rt, Toy_Ast* ast, unsigned int first, unsigned int* count) {
+	if (ast->type == TOY_AST_BINARY && ast->binary.flag == TOY_AST_FLAG_CONCAT) {
+		writeRegisterConcatOperands(rt, ast->binary.left, first, count);
+		writeRegisterConcatOperands(rt, ast->binary.right, first, count);
+		return;
+	}
+
+	if (ast->type == TOY_AST_GROUP) {
+		writeRegisterConcatOperands(rt, ast->group.child, first, count);
+		return;
+	}
+
+	//more operands than one instruction can count are joined early, leaving one behind
+	if ((*count) == UCHAR_MAX) {
+		writeRegisterWord(rt, TOY_OPCODE_CONCAT_N, first, first, *count);
+		(*count) = 1;
+	}
+
+	unsigned int reg = first + (*count);
+	(*rt)->registersCount = reg + 1;
+	writeRegisterExpression(rt, ast, reg);
+	(*count)++;
+}
+
+static unsigned int writeRegisterBinary(Toy_Routine** rt, Toy_AstBinary ast, int target) {
+	//assignments write to the left, rather than reading it
+	if (ast.flag >= TOY_AST_FLAG_ASSIGN && ast.flag <= TOY_AST_FLAG_MODULO_ASSIGN) {
+		return writeRegisterAssign(rt, ast);
+	}
+
+	//longer chains are joined by one instruction
+	if (ast.flag == TOY_AST_FLAG_CONCAT && (isConcatChain(ast.left) || isConcatChain(ast.right))) {
+		unsigned int top = (*rt)->registersCount;
+		unsigned int count = 0;
+
+		writeRegisterConcatOperands(rt, ast.left, top, &count);
+		writeRegisterConcatOperands(rt, ast.right, top, &count);
+		(*rt)->registersCount = top;
+
+		unsigned int dst = targetRegister(rt, target);
+		writeRegisterWord(rt, TOY_OPCODE_CONCAT_N, dst, top, count);
+
+		return dst;
+	}
+
+	//the operands are temporaries, which can be reused by the result
+	unsigned int top = (*rt)->registersCount;
+	unsigned int left = writeRegisterExpression(rt, ast.left, -1);
+	unsigned int right = writeRegisterExpression(rt, ast.right, -1);
+	(*rt)->registersCount = top;
+
+	unsigned int dst = targetRegister(rt, target);
+	writeRegisterWord(rt, registerOpcode(ast.flag), dst, left, right);
+
+	if (ast.flag == TOY_AST_FLAG_COMPARE_NOT) {
+		writeRegisterWord(rt, TOY_OPCODE_NEGATE, dst, dst, 0);
+	}
+
+	return dst;
+}
+
+static unsigned int writeRegisterExpression(Toy_Routine** rt, Toy_Ast* ast, int target) {
+	unsigned int result = 0;
+
+	switch(ast->type) {
+		case TOY_AST_VALUE:
+			result = writeRegisterValue(rt, ast->value, target);
+			break;
+
+		case TOY_AST_UNARY:
+			result = writeRegisterUnary(rt, ast->unary, target);
+			break;
+
+		case TOY_AST_BINARY:
+			result = writeRegisterBinary(rt, ast->binary, target);
+			break;
+
+		case TOY_AST_GROUP:
+			result = writeRegisterExpression(rt, ast->group.child, target);
+			break;
+
+		case TOY_AST_VAR_ACCESS:
+			result = writeRegisterVarAccess(rt, ast->varAccess, target);
+			break;
+
+		default:
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid AST type found: Expected an expression\n" TOY_CC_RESET);
+			exit(-1);
+	}
+
+	//copy into the requested register, if the result landed elsewhere
+	if (target >= 0 && result != (unsigned int)target) {
+		writeRegisterWord(rt, TOY_OPCODE_ACCESS_SLOT, targetRegister(rt, target), result, 0);
+		result = target;
+	}
+
+	return result;
+}
+
+static bool writeRegisterStatement(Toy_Routine** rt, Toy_Ast* ast) {
+	switch(ast->type) {
+		case TOY_AST_VALUE:
+		case TOY_AST_UNARY:
+		case TOY_AST_BINARY:
+		case TOY_AST_GROUP:
+		case TOY_AST_VAR_ACCESS:
+			//the result is discarded
+			writeRegisterExpression(rt, ast, -1);
+			break;
+
+		case TOY_AST_PRINT: {
+			unsigned int src = writeRegisterExpression(rt, ast->print.child, -1);
+			writeRegisterWord(rt, TOY_OPCODE_PRINT, src, 0, 0);
+			break;
+		}
+
+		case TOY_AST_VAR_DECLARE: {
+			//locals are evaluated straight into their own register, so there's nothing to declare at runtime
+			if ((*rt)->scopeDepth > 0) {
+				writeRegisterExpression(rt, ast->varDeclare.expr, (*rt)->localsCount);
+				declareLocal(rt, ast->varDeclare.name);
+				break;
+			}
+
+			unsigned int src = writeRegisterExpression(rt, ast->varDeclare.expr, -1);
+			writeRegisterWord(rt, TOY_OPCODE_DECLARE, Toy_getNameStringType(ast->varDeclare.name), ast->varDeclare.name->length, src);
+			emitString(rt, ast->varDeclare.name);
+			break;
+		}
+
+		default:
+			//blocks, scopes and meta types are shared with the stack backend
+			return false;
+	}
+
+	//temporaries don't outlive their statement
+	(*rt)->registersCount = (*rt)->localsCount;
+	return true;
+}
+
 //routine structure
 // static void writeRoutineParam(Toy_Routine* rt) {
 // 	//
@@ -289,6 +828,11 @@ static void writeRoutineCode(Toy_Routine** rt, Toy_Ast* ast) {
 		return;
 	}
 
+	//the register backend has its own instruction writers
+	if ((*rt)->backend == TOY_BACKEND_REGISTER && writeRegisterStatement(rt, ast)) {
+		return;
+	}
+
 	//determine how to write each instruction based on the Ast
 	switch(ast->type) {
 		case TOY_AST_BLOCK:
@@ -312,6 +856,10 @@ static void writeRoutineCode(Toy_Routine** rt, Toy_Ast* ast) {
 			writeInstructionGroup(rt, ast->group);
 			break;
 
+		case TOY_AST_SCOPE:
+			writeInstructionScope(rt, ast->scope);
+			break;
+
 		case TOY_AST_PRINT:
 			writeInstructionPrint(rt, ast->print);
 			break;
@@ -320,6 +868,10 @@ static void writeRoutineCode(Toy_Routine** rt, Toy_Ast* ast) {
 			writeInstructionVarDeclare(rt, ast->varDeclare);
 			break;
 
+		case TOY_AST_VAR_ACCESS:
+			writeInstructionVarAccess(rt, ast->varAccess);
+			break;
+
 		//meta instructions are disallowed
 		case TOY_AST_PASS:
 			//NOTE: this should be disallowed, but for now it's required for testing
@@ -339,11 +891,140 @@ static void writeRoutineCode(Toy_Routine** rt, Toy_Ast* ast) {
 	}
 }
 
+//peephole pass over the stack backend's code; there are no jumps yet, so words can be removed freely
+static unsigned int instructionLength(unsigned char* instruction) {
+	//values and names stored after the first word
+	if (((instruction[0] == TOY_OPCODE_READ || instruction[0] == TOY_OPCODE_PRINT_IMM) && instruction[1] >= TOY_VALUE_INTEGER) ||
+		instruction[0] == TOY_OPCODE_DECLARE || instruction[0] == TOY_OPCODE_ASSIGN || instruction[0] == TOY_OPCODE_ACCESS ||
+		instruction[0] == TOY_OPCODE_ARITHMETIC_IMM || instruction[0] == TOY_OPCODE_COMPARE_IMM)
+	{
+		return 8;
+	}
+
+	return 4;
+}
+
+static bool isBooleanResult(unsigned char* instruction) {
+	return
+		(instruction[0] >= TOY_OPCODE_COMPARE_EQUAL && instruction[0] <= TOY_OPCODE_NEGATE) ||
+		(instruction[0] == TOY_OPCODE_COMPARE_IMM) ||
+		(instruction[0] == TOY_OPCODE_READ && instruction[1] == TOY_VALUE_BOOLEAN);
+}
+
+static void writePeephole(Toy_Routine** rt) {
+	unsigned char* code = (*rt)->code;
+	bool changed = true;
+
+	//each rewrite can expose another, so repeat until nothing changes
+	while (changed) {
+		changed = false;
+
+		unsigned int count = 0; //the compacted code is written back over the original
+		unsigned char* last = NULL;
+
+		for (unsigned int i = 0; i < (*rt)->codeCount; /* EMPTY */) {
+			unsigned int length = instructionLength(code + i);
+
+			if (last != NULL && code[i] == TOY_OPCODE_NEGATE) {
+				//'!=' is 'COMPARE_EQUAL' with 'NEGATE' squeezed into one word, and negating it again cancels out
+				if (last[0] == TOY_OPCODE_COMPARE_EQUAL) {
+					last[1] = last[1] == TOY_OPCODE_NEGATE ? 0 : TOY_OPCODE_NEGATE;
+					i += length;
+					changed = true;
+					continue;
+				}
+
+				if (last[0] == TOY_OPCODE_COMPARE_IMM && last[2] == TOY_OPCODE_COMPARE_EQUAL) {
+					last[3] = last[3] == TOY_OPCODE_NEGATE ? 0 : TOY_OPCODE_NEGATE;
+					i += length;
+					changed = true;
+					continue;
+				}
+
+				//'!!x' is the truthiness of 'x', while '!' after a truthy check can skip the check
+				if (last[0] == TOY_OPCODE_NEGATE || last[0] == TOY_OPCODE_TRUTHY) {
+					last[0] = last[0] == TOY_OPCODE_NEGATE ? TOY_OPCODE_TRUTHY : TOY_OPCODE_NEGATE;
+					i += length;
+					changed = true;
+					continue;
+				}
+			}
+
+			//the truthiness of a boolean is itself
+			if (last != NULL && code[i] == TOY_OPCODE_TRUTHY && isBooleanResult(last)) {
+				i += length;
+				changed = true;
+				continue;
+			}
+
+#if TOY_ROUTINE_SUPERINSTRUCTIONS
+			//fuse a literal into the instruction that uses it, keeping the literal's payload in place
+			if (last != NULL && last[0] == TOY_OPCODE_READ) {
+				bool number = last[1] == TOY_VALUE_INTEGER || last[1] == TOY_VALUE_FLOAT;
+
+				if (number && code[i] >= TOY_OPCODE_ADD && code[i] <= TOY_OPCODE_MODULO) {
+					last[0] = TOY_OPCODE_ARITHMETIC_IMM;
+					last[2] = code[i];
+					i += length;
+					changed = true;
+					continue;
+				}
+
+				if (number && code[i] >= TOY_OPCODE_COMPARE_EQUAL && code[i] <= TOY_OPCODE_COMPARE_GREATER_EQUAL) {
+					last[0] = TOY_OPCODE_COMPARE_IMM;
+					last[2] = code[i];
+					last[3] = code[i + 1]; //the squeezed 'NEGATE', if any
+					i += length;
+					changed = true;
+					continue;
+				}
+
+				if (code[i] == TOY_OPCODE_PRINT) {
+					last[0] = TOY_OPCODE_PRINT_IMM;
+					i += length;
+					changed = true;
+					continue;
+				}
+			}
+#endif
+
+			memmove(code + count, code + i, length);
+			last = code + count;
+			count += length;
+			i += length;
+		}
+
+		(*rt)->codeCount = count;
+	}
+}
+
 static void* writeRoutine(Toy_Routine* rt, Toy_Ast* ast) {
 	//build the routine's parts
 	//TODO: param
 	//code
 	writeRoutineCode(&rt, ast);
+
+	//register operands are a single byte, so very large routines fall back to the stack backend
+	if (rt->backend == TOY_BACKEND_REGISTER && rt->registersMax > TOY_ROUTINE_MAX_REGISTERS) {
+		rt->backend = TOY_BACKEND_STACK;
+
+		rt->codeCount = 0;
+		rt->jumpsCount = 0;
+		rt->dataCount = 0;
+		rt->localsCount = 0;
+		rt->registersCount = 0;
+		rt->registersMax = 0;
+		rt->stackCount = 0;
+		rt->stackMax = 0;
+
+		writeRoutineCode(&rt, ast);
+	}
+
+	//register words name their operands, so neighbouring words can't be merged blindly
+	if (rt->backend == TOY_BACKEND_STACK) {
+		writePeephole(&rt);
+	}
+
 	EMIT_BYTE(&rt, code, TOY_OPCODE_RETURN); //temp terminator
 	EMIT_BYTE(&rt, code, 0); //4-byte alignment
 	EMIT_BYTE(&rt, code, 0);
@@ -362,6 +1043,8 @@ static void* writeRoutine(Toy_Routine* rt, Toy_Ast* ast) {
 	emitInt(&buffer, &capacity, &count, rt->jumpsCount); //jumps size
 	emitInt(&buffer, &capacity, &count, rt->dataCount); //data size
 	emitInt(&buffer, &capacity, &count, rt->subsCount); //routine size
+	emitInt(&buffer, &capacity, &count, rt->backend); //instruction encoding
+	emitInt(&buffer, &capacity, &count, rt->backend == TOY_BACKEND_REGISTER ? rt->registersMax : rt->stackMax); //frame size, the register file or stack depth needed at runtime
 
 	//generate blank spaces, cache their positions in the *Addr variables (for storing the start positions)
 	if (rt->paramCount > 0) {
@@ -422,6 +1105,10 @@ static void* writeRoutine(Toy_Routine* rt, Toy_Ast* ast) {
 
 //exposed functions
 void* Toy_compileRoutine(Toy_Ast* ast) {
+	return Toy_compileRoutineWithBackend(ast, TOY_ROUTINE_BACKEND);
+}
+
+void* Toy_compileRoutineWithBackend(Toy_Ast* ast, Toy_RoutineBackend backend) {
 	//setup
 	Toy_Routine rt;
 
@@ -440,21 +1127,36 @@ void* Toy_compileRoutine(Toy_Ast* ast) {
 	rt.data = NULL;
 	rt.dataCapacity = 0;
 	rt.dataCount = 0;
+	rt.strings = Toy_allocateTable();
 
 	rt.subs = NULL;
 	rt.subsCapacity = 0;
 	rt.subsCount = 0;
 
+	rt.locals = NULL;
+	rt.localsCapacity = 0;
+	rt.localsCount = 0;
+	rt.scopeDepth = 0;
+	rt.scopeStart = 0;
+
+	rt.backend = backend;
+	rt.registersCount = 0;
+	rt.registersMax = 0;
+
+	rt.stackCount = 0;
+	rt.stackMax = 0;
+
 	//build
 	void * buffer = writeRoutine(&rt, ast);
 
-
 	//cleanup the temp object
 	free(rt.param);
 	free(rt.code);
 	free(rt.jumps);
 	free(rt.data);
+	Toy_freeTable(rt.strings);
 	free(rt.subs);
+	free(rt.locals);
 
 	return buffer;
 }
@@ -2,6 +2,8 @@
 
 #include "toy_common.h"
 #include "toy_ast.h"
+#include "toy_opcodes.h"
+#include "toy_table.h"
 
 //internal structure that holds the individual parts of a compiled routine
 typedef struct Toy_Routine {
@@ -20,11 +22,51 @@ typedef struct Toy_Routine {
 	unsigned char* data; //data for longer stuff
 	unsigned int dataCapacity;
 	unsigned int dataCount;
+	Toy_Table* strings; //compile-time only; the hash of each string already in 'data', mapped to its index in 'jumps'
 
 	unsigned char* subs; //subroutines, recursively
 	unsigned int subsCapacity;
 	unsigned int subsCount;
+
+	Toy_String** locals; //compile-time only; names of the locals in scope, where the index is the slot
+	unsigned int localsCapacity;
+	unsigned int localsCount;
+	unsigned int scopeDepth; //variables declared at depth 0 are globals, stored by name
+	unsigned int scopeStart; //the first slot of the innermost scope
+
+	Toy_RoutineBackend backend; //the instruction encoding being written
+	unsigned int registersCount; //register backend only; locals fill the lowest registers, temporaries sit above them
+	unsigned int registersMax; //the size of the register file needed at runtime
+
+	unsigned int stackCount; //stack backend only; tracks the depth of the stack as the code is written
+	unsigned int stackMax; //the deepest the stack can get at runtime
 } Toy_Routine;
 
+//limited by the size of a slot's operand
+#ifndef TOY_ROUTINE_MAX_SLOTS
+#define TOY_ROUTINE_MAX_SLOTS 65536
+#endif
+
+//limited by the size of a register operand, larger routines fall back to the stack backend
+#ifndef TOY_ROUTINE_MAX_REGISTERS
+#define TOY_ROUTINE_MAX_REGISTERS 256
+#endif
+
+//fuse literal reads into the instructions that use them, see TOY_OPCODE_ARITHMETIC_IMM
+#ifndef TOY_ROUTINE_SUPERINSTRUCTIONS
+#define TOY_ROUTINE_SUPERINSTRUCTIONS 1
+#endif
+
+//precede each string in the data section with its length and hash, so the VM doesn't measure or hash names at runtime - must match between the compiler and the VM
+#ifndef TOY_ROUTINE_DATA_HASHES
+#define TOY_ROUTINE_DATA_HASHES 1
+#endif
+
+//the backend used by Toy_compileRoutine() - can be overridden at build time
+#ifndef TOY_ROUTINE_BACKEND
+#define TOY_ROUTINE_BACKEND TOY_BACKEND_STACK
+#endif
+
 TOY_API void* Toy_compileRoutine(Toy_Ast* ast);
+TOY_API void* Toy_compileRoutineWithBackend(Toy_Ast* ast, Toy_RoutineBackend backend);
 
@@ -20,29 +20,59 @@ static void decrementRefCount(Toy_Scope* scope) {
 	}
 }
 
-static Toy_Value* lookupScope(Toy_Scope* scope, Toy_String* key, unsigned int hash, bool recursive) {
+//taken from the hash's high bits, which the table's index rarely reaches
+static uint64_t bloomBits(unsigned int hash) {
+	return ((uint64_t)1 << ((hash >> 20) & 63)) | ((uint64_t)1 << ((hash >> 26) & 63));
+}
+
+//each scope's table owns a reference to its names, and to the strings stored in it
+static void freeScopeTable(Toy_Table* table) {
+	for (unsigned int i = 0; i < table->capacity; i++) {
+		if (!TOY_VALUE_IS_NULL(TOY_TABLE_KEY(table, i))) {
+			Toy_freeValue(TOY_TABLE_KEY(table, i));
+			Toy_freeValue(TOY_TABLE_VALUE(table, i));
+		}
+	}
+
+	Toy_freeTable(table);
+}
+
+//'owner' is set to the scope the name was found in - values in persistent and shared scopes may be shared, so are never written through the result
+//values in shared scopes are copied into 'buffer', since the version of the table they were found in may be freed by another thread
+static Toy_Value* lookupScope(Toy_Scope* scope, Toy_String* key, unsigned int hash, bool recursive, Toy_Scope** owner, Toy_Value* buffer) {
 	//terminate
 	if (scope == NULL) {
 		return NULL;
 	}
 
-	//copy and modify the code from Toy_lookupTable, so it can behave slightly differently
-	unsigned int probe = hash % scope->table->capacity;
+	//this scope never declared the name, so skip its table
+	if (TOY_SCOPE_BLOOM_FILTER && (scope->bloom & bloomBits(hash)) != bloomBits(hash)) {
+		return recursive ? lookupScope(scope->next, key, hash, recursive, owner, buffer) : NULL;
+	}
 
-	while (true) {
-		//found the entry
-		if (TOY_VALUE_IS_STRING(scope->table->data[probe].key) && Toy_compareStrings(TOY_VALUE_AS_STRING(scope->table->data[probe].key), key) == 0) {
-			return &(scope->table->data[probe].value);
-		}
+	//the hash is calculated once for the whole chain - interned names are the same pointer, and the cached hashes rule out nearly every other mismatch
+	Toy_Value* valuePtr = NULL;
 
-		//if its an empty slot (didn't find it here)
-		if (TOY_VALUE_IS_NULL(scope->table->data[probe].key)) {
-			return recursive ? lookupScope(scope->next, key, hash, recursive) : NULL;
-		}
+	if (scope->shared != NULL) {
+		valuePtr = Toy_private_lookupSharedTableValue(scope->shared, scope->reader, TOY_VALUE_FROM_STRING(key), hash, buffer) ? buffer : NULL;
+	}
+	else if (scope->persistent) {
+		valuePtr = (Toy_Value*)Toy_private_lookupHamtValue(scope->hamt, TOY_VALUE_FROM_STRING(key), hash);
+	}
+	else {
+		valuePtr = Toy_private_lookupTableValue(scope->table, TOY_VALUE_FROM_STRING(key), hash);
+	}
+
+	//didn't find it here
+	if (valuePtr == NULL && recursive) {
+		return lookupScope(scope->next, key, hash, recursive, owner, buffer);
+	}
 
-		//adjust and continue
-		probe = (probe + 1) % scope->table->capacity;
+	if (owner != NULL) {
+		(*owner) = scope;
 	}
+
+	return valuePtr;
 }
 
 //exposed functions
@@ -51,7 +81,46 @@ Toy_Scope* Toy_pushScope(Toy_Bucket** bucketHandle, Toy_Scope* scope) {
 
 	newScope->next = scope;
 	newScope->table = Toy_allocateTable();
+	newScope->hamt = NULL;
+	newScope->shared = NULL;
+	newScope->reader = NULL;
+	newScope->refCount = 0;
+	newScope->bloom = 0;
+	newScope->persistent = false;
+
+	incrementRefCount(newScope);
+
+	return newScope;
+}
+
+Toy_Scope* Toy_pushPersistentScope(Toy_Bucket** bucketHandle, Toy_Scope* scope) {
+	Toy_Scope* newScope = Toy_partitionBucket(bucketHandle, sizeof(Toy_Scope));
+
+	newScope->next = scope;
+	newScope->table = NULL;
+	newScope->hamt = NULL;
+	newScope->shared = NULL;
+	newScope->reader = NULL;
 	newScope->refCount = 0;
+	newScope->bloom = 0;
+	newScope->persistent = true;
+
+	incrementRefCount(newScope);
+
+	return newScope;
+}
+
+Toy_Scope* Toy_pushSharedScope(Toy_Bucket** bucketHandle, Toy_Scope* scope, Toy_SharedTable* shared) {
+	Toy_Scope* newScope = Toy_partitionBucket(bucketHandle, sizeof(Toy_Scope));
+
+	newScope->next = scope;
+	newScope->table = NULL;
+	newScope->hamt = NULL;
+	newScope->shared = shared;
+	newScope->reader = Toy_openSharedReader(shared);
+	newScope->refCount = 0;
+	newScope->bloom = ~(uint64_t)0; //other VMs can declare names here at any time, so this scope is never skipped
+	newScope->persistent = false;
 
 	incrementRefCount(newScope);
 
@@ -66,8 +135,18 @@ Toy_Scope* Toy_popScope(Toy_Scope* scope) {
 	decrementRefCount(scope);
 
 	if (scope->refCount == 0) {
-		Toy_freeTable(scope->table);
+		if (scope->table != NULL) {
+			freeScopeTable(scope->table);
+		}
+		Toy_freeHamt(scope->hamt);
 		scope->table = NULL;
+		scope->hamt = NULL;
+
+		//the shared table itself belongs to the host
+		if (scope->reader != NULL) {
+			Toy_closeSharedReader(scope->shared, scope->reader);
+			scope->reader = NULL;
+		}
 	}
 
 	return scope->next;
@@ -78,15 +157,34 @@ Toy_Scope* Toy_deepCopyScope(Toy_Bucket** bucketHandle, Toy_Scope* scope) {
 	Toy_Scope* newScope = Toy_partitionBucket(bucketHandle, sizeof(Toy_Scope));
 
 	newScope->next = scope->next;
-	newScope->table = Toy_private_adjustTableCapacity(NULL, scope->table->capacity);
+	newScope->table = NULL;
+	newScope->hamt = NULL;
+	newScope->shared = scope->shared;
+	newScope->reader = NULL;
 	newScope->refCount = 0;
+	newScope->bloom = scope->bloom;
+	newScope->persistent = scope->persistent;
 
 	incrementRefCount(newScope);
 
-	//forcibly copy the contents
+	//shared scopes are never copied, just read through another reader
+	if (scope->shared != NULL) {
+		newScope->reader = Toy_openSharedReader(scope->shared);
+		return newScope;
+	}
+
+	//persistent scopes share their contents, until either side changes
+	if (scope->persistent) {
+		newScope->hamt = Toy_copyHamt(scope->hamt);
+		return newScope;
+	}
+
+	newScope->table = Toy_private_adjustTableCapacity(NULL, scope->table->capacity);
+
+	//forcibly copy the contents, so the copy owns them too
 	for (int i = 0; i < scope->table->capacity; i++) {
-		if (!TOY_VALUE_IS_NULL(scope->table->data[i].key)) {
-			Toy_insertTable(&newScope->table, scope->table->data[i].key, scope->table->data[i].value);
+		if (!TOY_VALUE_IS_NULL(TOY_TABLE_KEY(scope->table, i))) {
+			Toy_insertTable(&newScope->table, Toy_copyValue(TOY_TABLE_KEY(scope->table, i)), Toy_copyValue(TOY_TABLE_VALUE(scope->table, i)));
 		}
 	}
 
@@ -99,35 +197,67 @@ void Toy_declareScope(Toy_Scope* scope, Toy_String* key, Toy_Value value) {
 		exit(-1);
 	}
 
-	Toy_Value* valuePtr = lookupScope(scope, key, Toy_hashString(key), false);
+	unsigned int hash = Toy_hashString(key);
+	Toy_Value buffer;
+	bool redefined = lookupScope(scope, key, hash, false, NULL, &buffer) != NULL;
 
-	if (valuePtr != NULL) {
+	if (!redefined) {
+		//another VM may be declaring the same name right now, so the shared table checks again while it holds the writer lock; it copies the name itself
+		if (scope->shared != NULL) {
+			redefined = !Toy_declareSharedTable(scope->shared, TOY_VALUE_FROM_STRING(key), value);
+		}
+		else if (scope->persistent) {
+			Toy_insertHamt(&scope->hamt, TOY_VALUE_FROM_STRING(Toy_copyString(key)), value, hash);
+		}
+		else {
+			Toy_insertTable(&scope->table, TOY_VALUE_FROM_STRING(Toy_copyString(key)), value);
+		}
+	}
 
+	if (redefined) {
 		char buffer[key->length + 256];
 		sprintf(buffer, "Can't redefine a variable: %s", key->as.name.data);
 		Toy_error(buffer);
 		return;
 	}
 
-	Toy_insertTable(&scope->table, TOY_VALUE_FROM_STRING(Toy_copyString(key)), value);
+	scope->bloom |= bloomBits(hash);
 }
 
-void Toy_assignScope(Toy_Scope* scope, Toy_String* key, Toy_Value value) {
+Toy_Value Toy_assignScope(Toy_Scope* scope, Toy_String* key, Toy_Value value) {
 	if (key->type != TOY_STRING_NAME) {
 		fprintf(stderr, TOY_CC_ERROR "ERROR: Toy_Scope only allows name strings as keys\n" TOY_CC_RESET);
 		exit(-1);
 	}
 
-	Toy_Value* valuePtr = lookupScope(scope, key, Toy_hashString(key), true);
+	unsigned int hash = Toy_hashString(key);
+	Toy_Scope* owner = NULL;
+	Toy_Value buffer;
+	Toy_Value* valuePtr = lookupScope(scope, key, hash, true, &owner, &buffer);
 
 	if (valuePtr == NULL) {
 		char buffer[key->length + 256];
 		sprintf(buffer, "Undefined variable: %s", key->as.name.data);
 		Toy_error(buffer);
-		return;
+		return TOY_VALUE_FROM_NULL();
+	}
+
+	//the name already exists, so this only replaces the value, publishing a new version for the other VMs to see
+	if (owner->shared != NULL) {
+		Toy_insertSharedTable(owner->shared, TOY_VALUE_FROM_STRING(key), value);
+		return value; //the table keeps its own copy, and the old one may still be read by other VMs
+	}
+
+	Toy_Value previous = *valuePtr;
+
+	//the name already exists, so this only replaces the value, copying whatever nodes are shared along the way
+	if (owner->persistent) {
+		Toy_insertHamt(&owner->hamt, TOY_VALUE_FROM_STRING(key), value, hash);
+		return previous;
 	}
 
 	*valuePtr = value;
+	return previous;
 }
 
 Toy_Value Toy_accessScope(Toy_Scope* scope, Toy_String* key) {
@@ -136,7 +266,8 @@ Toy_Value Toy_accessScope(Toy_Scope* scope, Toy_String* key) {
 		exit(-1);
 	}
 
-	Toy_Value* valuePtr = lookupScope(scope, key, Toy_hashString(key), true);
+	Toy_Value buffer;
+	Toy_Value* valuePtr = lookupScope(scope, key, Toy_hashString(key), true, NULL, &buffer);
 
 	if (valuePtr == NULL) {
 		char buffer[key->length + 256];
@@ -154,7 +285,8 @@ bool Toy_isDeclaredScope(Toy_Scope* scope, Toy_String* key) {
 		exit(-1);
 	}
 
-	Toy_Value* valuePtr = lookupScope(scope, key, Toy_hashString(key), true);
+	Toy_Value buffer;
+	Toy_Value* valuePtr = lookupScope(scope, key, Toy_hashString(key), true, NULL, &buffer);
 
 	return valuePtr != NULL;
 }
@@ -6,23 +6,37 @@
 #include "toy_value.h"
 #include "toy_string.h"
 #include "toy_table.h"
+#include "toy_hamt.h"
+#include "toy_shared_table.h"
 
-//wraps Toy_Table, restricting keys to name strings, and handles scopes as a linked list
+//skip scopes along the chain whose declared names can't include the one being looked up
+#ifndef TOY_SCOPE_BLOOM_FILTER
+#define TOY_SCOPE_BLOOM_FILTER 1
+#endif
+
+//wraps Toy_Table, Toy_HamtNode for persistent scopes, or Toy_SharedTable for shared scopes, restricting keys to name strings, and handles scopes as a linked list
 typedef struct Toy_Scope {
 	struct Toy_Scope* next;
-	Toy_Table* table;
+	Toy_Table* table; //NULL for persistent and shared scopes
+	Toy_HamtNode* hamt; //shared between a persistent scope and its copies, until either one changes
+	Toy_SharedTable* shared; //owned by the host, and read by many VMs on many threads at once
+	Toy_SharedReader* reader; //this scope's own reader, so each VM has one
 	unsigned int refCount;
+	uint64_t bloom; //two bits per declared name's hash, never cleared, since names are never undeclared
+	bool persistent;
 } Toy_Scope;
 
 //handle deep scopes - the scope is stored in the bucket, not the table
 TOY_API Toy_Scope* Toy_pushScope(Toy_Bucket** bucketHandle, Toy_Scope* scope);
+TOY_API Toy_Scope* Toy_pushPersistentScope(Toy_Bucket** bucketHandle, Toy_Scope* scope); //deep copies are O(1), while changes copy O(log n) nodes
+TOY_API Toy_Scope* Toy_pushSharedScope(Toy_Bucket** bucketHandle, Toy_Scope* scope, Toy_SharedTable* shared); //usually the root of each VM's chain; names and values declared through it are copied, so the table must outlive every VM instead
 TOY_API Toy_Scope* Toy_popScope(Toy_Scope* scope);
 
 TOY_API Toy_Scope* Toy_deepCopyScope(Toy_Bucket** bucketHandle, Toy_Scope* scope);
 
 //manage the contents
 TOY_API void Toy_declareScope(Toy_Scope* scope, Toy_String* key, Toy_Value value);
-TOY_API void Toy_assignScope(Toy_Scope* scope, Toy_String* key, Toy_Value value);
+TOY_API Toy_Value Toy_assignScope(Toy_Scope* scope, Toy_String* key, Toy_Value value); //returns the value for the caller to release - the one replaced, or the one given when a shared scope keeps its own copy
 TOY_API Toy_Value Toy_accessScope(Toy_Scope* scope, Toy_String* key);
 
 TOY_API bool Toy_isDeclaredScope(Toy_Scope* scope, Toy_String* key);
@@ -0,0 +1,191 @@
+#include "toy_shared_table.h"
+#include "toy_console_colors.h"
+#include "toy_print.h"
+#include "toy_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+	#include <windows.h>
+#else
+	#include <sched.h>
+#endif
+
+//utils
+static inline void yieldThread() {
+	//a thread being waited on may be sharing this core
+#if defined(_WIN32) || defined(_WIN64)
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+
+static void lockWriters(Toy_SharedTable* shared) {
+	while (atomic_flag_test_and_set_explicit(&shared->writing, memory_order_acquire)) {
+		yieldThread();
+	}
+}
+
+static void unlockWriters(Toy_SharedTable* shared) {
+	atomic_flag_clear_explicit(&shared->writing, memory_order_release);
+}
+
+//every reader that started before the epoch was bumped is finished afterwards, and any later ones only saw the newer version
+static void waitForReaders(Toy_SharedTable* shared, unsigned int epoch) {
+	unsigned int current = (epoch << 1) | 1;
+
+	for (Toy_SharedReader* iter = shared->readers; iter; iter = iter->next) {
+		unsigned int state = atomic_load(&iter->state);
+		while ((state & 1) && state != current) {
+			yieldThread();
+			state = atomic_load(&iter->state);
+		}
+	}
+}
+
+//pinned, so readers on other threads never write to the copy's reference count
+static Toy_Value copyIntoTable(Toy_SharedTable* shared, Toy_Value value) {
+	if (!TOY_VALUE_IS_STRING(value) || TOY_VALUE_IS_SHORT_STRING(value)) {
+		return value;
+	}
+
+	return TOY_VALUE_FROM_STRING(Toy_private_pinString(Toy_deepCopyString(&shared->bucket, TOY_VALUE_AS_STRING(value))));
+}
+
+//false if the key exists and can't be replaced, leaving the table as it was
+static bool writeSharedTable(Toy_SharedTable* shared, Toy_Value key, Toy_Value value, bool replace) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad shared table key\n" TOY_CC_RESET);
+	}
+
+	unsigned int hash = Toy_hashValue(key);
+
+	lockWriters(shared);
+
+	//readers may still be walking the old version, so the change is made to a copy
+	Toy_Table* old = atomic_load_explicit(&shared->table, memory_order_relaxed);
+
+	if (!replace && Toy_private_lookupTableValue(old, key, hash) != NULL) {
+		unlockWriters(shared);
+		return false;
+	}
+
+	Toy_Table* table = Toy_private_adjustTableCapacity(NULL, old->capacity);
+
+	for (unsigned int i = 0; i < old->capacity; i++) {
+		if (!TOY_VALUE_IS_NULL(TOY_TABLE_KEY(old, i))) {
+			Toy_insertTable(&table, TOY_TABLE_KEY(old, i), TOY_TABLE_VALUE(old, i));
+		}
+	}
+
+	//an existing key is kept, so only the value is copied in
+	Toy_Value* valuePtr = Toy_private_lookupTableValue(table, key, hash);
+
+	if (valuePtr != NULL) {
+		(*valuePtr) = copyIntoTable(shared, value);
+	}
+	else {
+		Toy_insertTable(&table, copyIntoTable(shared, key), copyIntoTable(shared, value));
+	}
+
+	atomic_store(&shared->table, table);
+	waitForReaders(shared, atomic_fetch_add(&shared->epoch, 1) + 1);
+
+	//nobody can reach the old version now
+	Toy_freeTable(old);
+
+	unlockWriters(shared);
+
+	return true;
+}
+
+//exposed functions
+Toy_SharedTable* Toy_allocateSharedTable() {
+	Toy_SharedTable* shared = malloc(sizeof(Toy_SharedTable));
+
+	if (shared == NULL) {
+		Toy_error(TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_SharedTable'\n" TOY_CC_RESET);
+	}
+
+	atomic_init(&shared->table, Toy_allocateTable());
+	atomic_init(&shared->epoch, 0);
+	atomic_flag_clear(&shared->writing);
+	shared->readers = NULL;
+	shared->bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+	return shared;
+}
+
+void Toy_freeSharedTable(Toy_SharedTable* shared) {
+	if (shared->readers != NULL) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Can't free a 'Toy_SharedTable' with open readers\n" TOY_CC_RESET);
+		exit(-1);
+	}
+
+	Toy_freeTable(atomic_load(&shared->table));
+	Toy_freeBucket(&shared->bucket);
+	free(shared);
+}
+
+Toy_SharedReader* Toy_openSharedReader(Toy_SharedTable* shared) {
+	Toy_SharedReader* reader = malloc(sizeof(Toy_SharedReader));
+
+	if (reader == NULL) {
+		Toy_error(TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_SharedReader'\n" TOY_CC_RESET);
+	}
+
+	atomic_init(&reader->state, 0);
+
+	lockWriters(shared);
+	reader->next = shared->readers;
+	shared->readers = reader;
+	unlockWriters(shared);
+
+	return reader;
+}
+
+void Toy_closeSharedReader(Toy_SharedTable* shared, Toy_SharedReader* reader) {
+	lockWriters(shared);
+	for (Toy_SharedReader** iter = &shared->readers; *iter; iter = &(*iter)->next) {
+		if (*iter == reader) {
+			*iter = reader->next;
+			break;
+		}
+	}
+	unlockWriters(shared);
+
+	free(reader);
+}
+
+void Toy_insertSharedTable(Toy_SharedTable* shared, Toy_Value key, Toy_Value value) {
+	writeSharedTable(shared, key, value, true);
+}
+
+bool Toy_declareSharedTable(Toy_SharedTable* shared, Toy_Value key, Toy_Value value) {
+	return writeSharedTable(shared, key, value, false);
+}
+
+Toy_Value Toy_lookupSharedTable(Toy_SharedTable* shared, Toy_SharedReader* reader, Toy_Value key) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad shared table key\n" TOY_CC_RESET);
+	}
+
+	Toy_Value result;
+	return Toy_private_lookupSharedTableValue(shared, reader, key, Toy_hashValue(key), &result) ? result : TOY_VALUE_FROM_NULL();
+}
+
+bool Toy_private_lookupSharedTableValue(Toy_SharedTable* shared, Toy_SharedReader* reader, Toy_Value key, unsigned int hash, Toy_Value* result) {
+	//announce the read before loading the table, so a writer that published after this either waits, or was already seen
+	atomic_store(&reader->state, (atomic_load(&shared->epoch) << 1) | 1);
+
+	const Toy_Value* valuePtr = Toy_private_lookupTableValue(atomic_load(&shared->table), key, hash);
+	if (valuePtr != NULL) {
+		(*result) = (*valuePtr);
+	}
+
+	atomic_store_explicit(&reader->state, 0, memory_order_release);
+
+	return valuePtr != NULL;
+}
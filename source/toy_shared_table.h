@@ -0,0 +1,39 @@
+#pragma once
+
+#include "toy_common.h"
+#include "toy_bucket.h"
+#include "toy_value.h"
+#include "toy_table.h"
+
+#include <stdatomic.h>
+
+//one per reading thread, so readers never write to the same cache line as each other
+typedef struct Toy_SharedReader {   //32 | 64 BITNESS
+	atomic_uint state;              //4  | 4  the epoch this reader's lookup started in shifted left, with the lowest bit set, or 0 when idle
+	struct Toy_SharedReader* next;  //4  | 8
+	char padding[64 - 2 * sizeof(void*)]; //-  | -  the state is padded out to a pointer's size
+} Toy_SharedReader;                 //64 | 64
+
+//key-value table for many threads - readers never block, while writers take turns publishing a changed copy of the table, then wait for the readers of the old one to finish before freeing it
+typedef struct Toy_SharedTable {    //32 | 64 BITNESS
+	_Atomic(Toy_Table*) table;      //4  | 8  the current version, which is never changed once published
+	atomic_uint epoch;              //4  | 4  bumped by each write, once the new version is published
+	atomic_flag writing;            //1  | 1  held by the writer, which also guards the reader list
+	Toy_SharedReader* readers;      //4  | 8
+	Toy_Bucket* bucket;             //4  | 8  the table's own copies of string keys and values, guarded by the writer
+} Toy_SharedTable;                  //20 | 32
+
+//NOTE: strings are copied in, so they outlive the writer - replaced ones are kept until the table is freed, as other threads may still be holding them
+TOY_API Toy_SharedTable* Toy_allocateSharedTable();
+TOY_API void Toy_freeSharedTable(Toy_SharedTable* shared); //every reader must be closed first
+
+//each thread reading the table opens its own reader
+TOY_API Toy_SharedReader* Toy_openSharedReader(Toy_SharedTable* shared);
+TOY_API void Toy_closeSharedReader(Toy_SharedTable* shared, Toy_SharedReader* reader);
+
+TOY_API void Toy_insertSharedTable(Toy_SharedTable* shared, Toy_Value key, Toy_Value value); //copies the whole table, then waits for readers of the previous version
+TOY_API bool Toy_declareSharedTable(Toy_SharedTable* shared, Toy_Value key, Toy_Value value); //inserts only if the key is absent, checked while holding the writer lock, returning false otherwise
+TOY_API Toy_Value Toy_lookupSharedTable(Toy_SharedTable* shared, Toy_SharedReader* reader, Toy_Value key); //lock-free
+
+//NOTE: exposed so Toy_Scope can hash a name once for the whole chain; the value is copied out, since the version it was found in may be freed afterwards
+TOY_API bool Toy_private_lookupSharedTableValue(Toy_SharedTable* shared, Toy_SharedReader* reader, Toy_Value key, unsigned int hash, Toy_Value* result);
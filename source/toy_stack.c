@@ -68,18 +68,27 @@ Toy_Value Toy_popStack(Toy_Stack** stackHandle) {
 		exit(-1);
 	}
 
-	//shrink if possible
-	if ((*stackHandle)->count > TOY_STACK_INITIAL_CAPACITY && (*stackHandle)->count < (*stackHandle)->capacity * TOY_STACK_CONTRACTION_RATE) {
-		(*stackHandle)->capacity /= 2;
-		unsigned int newCapacity = (*stackHandle)->capacity;
+	//NOTE: the stack never shrinks, the VM reserves what it needs up front
+	return ((Toy_Value*)((*stackHandle) + 1))[--(*stackHandle)->count];
+}
 
-		(*stackHandle) = realloc((*stackHandle), (*stackHandle)->capacity * sizeof(Toy_Value) + sizeof(Toy_Stack));
+void Toy_reserveStack(Toy_Stack** stackHandle, unsigned int capacity) {
+	//don't go overboard
+	if (capacity > TOY_STACK_OVERFLOW) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Stack overflow\n" TOY_CC_RESET);
+		exit(-1);
+	}
 
-		if ((*stackHandle) == NULL) {
-			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to reallocate a 'Toy_Stack' of %d capacity (%d space in memory)\n" TOY_CC_RESET, (int)newCapacity, (int)(newCapacity * sizeof(Toy_Value) + sizeof(Toy_Stack)));
-			exit(1);
-		}
+	if (capacity <= (*stackHandle)->capacity) {
+		return;
 	}
 
-	return ((Toy_Value*)((*stackHandle) + 1))[--(*stackHandle)->count];
+	(*stackHandle) = realloc((*stackHandle), capacity * sizeof(Toy_Value) + sizeof(Toy_Stack));
+
+	if ((*stackHandle) == NULL) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to reallocate a 'Toy_Stack' of %d capacity (%d space in memory)\n" TOY_CC_RESET, (int)capacity, (int)(capacity * sizeof(Toy_Value) + sizeof(Toy_Stack)));
+		exit(1);
+	}
+
+	(*stackHandle)->capacity = capacity;
 }
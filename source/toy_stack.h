@@ -16,6 +16,15 @@ TOY_API void Toy_pushStack(Toy_Stack** stackHandle, Toy_Value value);
 TOY_API Toy_Value Toy_peekStack(Toy_Stack** stackHandle);
 TOY_API Toy_Value Toy_popStack(Toy_Stack** stackHandle);
 
+TOY_API void Toy_reserveStack(Toy_Stack** stackHandle, unsigned int capacity); //the stack never shrinks, so this is only needed once
+
+//unchecked fast paths, only safe once enough space has been reserved
+#define TOY_STACK_PUSH_UNCHECKED(stack, value) \
+	(((Toy_Value*)((stack) + 1))[(stack)->count++] = (value))
+
+#define TOY_STACK_POP_UNCHECKED(stack) \
+	(((Toy_Value*)((stack) + 1))[--(stack)->count])
+
 //some useful sizes, could be swapped out as needed
 #ifndef TOY_STACK_INITIAL_CAPACITY
 #define TOY_STACK_INITIAL_CAPACITY 8
@@ -25,10 +34,6 @@ TOY_API Toy_Value Toy_popStack(Toy_Stack** stackHandle);
 #define TOY_STACK_EXPANSION_RATE 2
 #endif
 
-#ifndef TOY_STACK_CONTRACTION_RATE
-#define TOY_STACK_CONTRACTION_RATE (1 / 4)
-#endif
-
 //prevent an infinite expansion, limited to 1MB
 #ifndef TOY_STACK_OVERFLOW
 #define TOY_STACK_OVERFLOW (1024 * 1024 / sizeof(Toy_Value))
@@ -2,93 +2,376 @@
 #include "toy_console_colors.h"
 
 #include <stdio.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
 //utils
-#define MIN(X,Y) ((X) < (Y) ? (X) : (Y))
-
 static void deepCopyUtil(char* dest, Toy_String* str) {
-	//sometimes, "clever" can be a bad thing...
-	if (str->type == TOY_STRING_NODE) {
-		deepCopyUtil(dest, str->as.node.left);
-		deepCopyUtil(dest + str->as.node.left->length, str->as.node.right);
+	Toy_StringIterator iter;
+	Toy_initStringIterator(&iter, str);
+
+	while (Toy_nextStringChunk(&iter)) {
+		memcpy(dest, iter.chunk, iter.length);
+		dest += iter.length;
 	}
+}
 
-	else {
-		memcpy(dest, str->as.leaf.data, str->length);
+//strings remember where they are in their bucket, so their memory can be given back when the last reference goes
+static unsigned int sizeOfString(Toy_String* str) {
+	return str->type == TOY_STRING_NODE || str->type == TOY_STRING_VIEW ? sizeof(Toy_String) : sizeof(Toy_String) + str->length + 1;
+}
+
+static Toy_String* partitionString(Toy_Bucket** bucketHandle, unsigned int amount) {
+	Toy_String* ret = (Toy_String*)Toy_partitionBucketBlock(bucketHandle, amount);
+
+	//too deep into an oversized bucket to find the way back, so it's never given back
+	unsigned int offset = ((char*)ret - (*bucketHandle)->data) / 4;
+	ret->bucketOffset = offset < USHRT_MAX ? offset : USHRT_MAX;
+
+	return ret;
+}
+
+static void releaseString(Toy_String* str) {
+	if (str->bucketOffset == USHRT_MAX) {
+		return;
 	}
+
+	Toy_Bucket* bucket = (Toy_Bucket*)((char*)str - str->bucketOffset * 4 - offsetof(Toy_Bucket, data));
+	Toy_releaseBucketBlock(bucket, str, sizeOfString(str));
 }
 
+//pinned strings are read by many threads at once, so their count is never written, and they're never given back
+#define PINNED_REFCOUNT UINT_MAX
+
 static void incrementRefCount(Toy_String* str) {
-	str->refCount++;
-	if (str->type == TOY_STRING_NODE) {
-		incrementRefCount(str->as.node.left);
-		incrementRefCount(str->as.node.right);
+	if (str->refCount != PINNED_REFCOUNT) {
+		str->refCount++;
 	}
 }
 
 static void decrementRefCount(Toy_String* str) {
-	str->refCount--;
+	if (str->refCount == PINNED_REFCOUNT || --str->refCount > 0) {
+		return;
+	}
+
+	//a node's children, and a view's parent, are only released along with the node or view itself
 	if (str->type == TOY_STRING_NODE) {
 		decrementRefCount(str->as.node.left);
 		decrementRefCount(str->as.node.right);
 	}
+	else if (str->type == TOY_STRING_VIEW) {
+		decrementRefCount(str->as.view.parent);
+	}
+
+	releaseString(str);
+}
+
+//the contiguous characters of anything that isn't a node
+static const char* chunkOf(Toy_String* str) {
+	switch(str->type) {
+		case TOY_STRING_LEAF:
+			return str->as.leaf.data;
+
+		case TOY_STRING_NAME:
+			return str->as.name.data;
+
+		case TOY_STRING_VIEW:
+			return str->as.view.data;
+
+		default:
+			return NULL;
+	}
 }
 
-static unsigned int hashCString(const char* string) {
-	unsigned int hash = 2166136261u;
+//polynomial hash, the sum of s[i] * B^(n-1-i) mod 2^32 - the hash of 'left..right' is hash(left) * B^length(right) + hash(right), so ropes hash from their children without flattening
+#define HASH_BASE   0x9e3779b1u
+#define HASH_BASE_2 (HASH_BASE * HASH_BASE)
+#define HASH_BASE_3 (HASH_BASE_2 * HASH_BASE)
+#define HASH_BASE_4 (HASH_BASE_3 * HASH_BASE)
+
+static unsigned int hashStringLength(const char* string, unsigned int length) {
+	unsigned int hash = 0;
+	unsigned int i = 0;
+
+	//four bytes per step, as the multiplies don't depend on each other
+	for (; i + 4 <= length; i += 4) {
+		hash = hash * HASH_BASE_4 +
+			(unsigned char)string[i + 0] * HASH_BASE_3 +
+			(unsigned char)string[i + 1] * HASH_BASE_2 +
+			(unsigned char)string[i + 2] * HASH_BASE +
+			(unsigned char)string[i + 3];
+	}
 
-	for (unsigned int i = 0; string[i]; i++) {
-		hash *= string[i];
-		hash ^= 16777619;
+	for (; i < length; i++) {
+		hash = hash * HASH_BASE + (unsigned char)string[i];
 	}
 
 	return hash;
 }
 
-static Toy_String* partitionStringLength(Toy_Bucket** bucketHandle, const char* cstring, unsigned int length) {
+static unsigned int combineHashes(unsigned int left, unsigned int right, unsigned int rightLength) {
+	//B^rightLength, by squaring
+	unsigned int power = 1;
+	unsigned int base = HASH_BASE;
+
+	while (rightLength > 0) {
+		if (rightLength & 1) {
+			power *= base;
+		}
+		base *= base;
+		rightLength >>= 1;
+	}
+
+	return left * power + right;
+}
+
+//the unmixed polynomial is what gets cached, as it's the part that composes
+static unsigned int rawHashString(Toy_String* str) {
+	if (str->cachedHash != 0) {
+		return str->cachedHash;
+	}
+	else if (str->type == TOY_STRING_NODE) {
+		//NOTE: recursing is bounded by the depth, and leaves every subtree's hash cached for later concatenations, unlike a flat walk with Toy_StringIterator
+		str->cachedHash = combineHashes(rawHashString(str->as.node.left), rawHashString(str->as.node.right), str->as.node.right->length);
+	}
+	else {
+		str->cachedHash = hashStringLength(chunkOf(str), str->length);
+	}
+
+	return str->cachedHash;
+}
+
+static Toy_String* partitionLeaf(Toy_Bucket** bucketHandle, unsigned int length) {
 	if (sizeof(Toy_String) + length + 1 > (*bucketHandle)->capacity) {
 		fprintf(stderr, TOY_CC_ERROR "ERROR: Can't partition enough space for a string, requested %d length (%d total) but buckets have a capacity of %d\n" TOY_CC_RESET, (int)length, (int)(sizeof(Toy_String) + length + 1), (int)((*bucketHandle)->capacity));
 		exit(-1);
 	}
 
-	Toy_String* ret = (Toy_String*)Toy_partitionBucket(bucketHandle, sizeof(Toy_String) + length + 1);
+	Toy_String* ret = partitionString(bucketHandle, sizeof(Toy_String) + length + 1);
 
 	ret->type = TOY_STRING_LEAF;
+	ret->depth = 0;
 	ret->length = length;
 	ret->refCount = 1;
 	ret->cachedHash = 0; //don't calc until needed
-	memcpy(ret->as.leaf.data, cstring, length + 1);
 	ret->as.leaf.data[length] = '\0';
 
 	return ret;
 }
 
-//exposed functions
-Toy_String* Toy_createString(Toy_Bucket** bucketHandle, const char* cstring) {
-	unsigned int length = strlen(cstring);
+static Toy_String* partitionStringLength(Toy_Bucket** bucketHandle, const char* cstring, unsigned int length) {
+	Toy_String* ret = partitionLeaf(bucketHandle, length);
+	memcpy(ret->as.leaf.data, cstring, length);
+	return ret;
+}
 
-	return Toy_createStringLength(bucketHandle, cstring, length);
+//takes ownership of the given references
+static Toy_String* partitionNode(Toy_Bucket** bucketHandle, Toy_String* left, Toy_String* right) {
+	Toy_String* ret = partitionString(bucketHandle, sizeof(Toy_String));
+
+	ret->type = TOY_STRING_NODE;
+	ret->depth = (left->depth > right->depth ? left->depth : right->depth) + 1;
+	ret->length = left->length + right->length;
+	ret->refCount = 1;
+	ret->cachedHash = left->cachedHash != 0 && right->cachedHash != 0 ? combineHashes(left->cachedHash, right->cachedHash, right->length) : 0; //otherwise, don't calc until needed
+	ret->as.node.left = left;
+	ret->as.node.right = right;
+
+	return ret;
 }
 
-Toy_String* Toy_createStringLength(Toy_Bucket** bucketHandle, const char* cstring, unsigned int length) {
-	//normal behaviour
-	if (length < (*bucketHandle)->capacity - sizeof(Toy_String) - 1) {
+//adds a reference to the parent
+static Toy_String* partitionView(Toy_Bucket** bucketHandle, Toy_String* parent, const char* data, unsigned int length) {
+	Toy_String* ret = partitionString(bucketHandle, sizeof(Toy_String));
+
+	ret->type = TOY_STRING_VIEW;
+	ret->depth = 0;
+	ret->length = length;
+	ret->refCount = 1;
+	ret->cachedHash = 0; //don't calc until needed
+	ret->as.view.parent = parent;
+	ret->as.view.data = data;
+
+	incrementRefCount(parent);
+
+	return ret;
+}
+
+static Toy_String* fragmentStringLength(Toy_Bucket** bucketHandle, const char* cstring, unsigned int length) {
+	//the most a leaf can hold, keeping the partition a whole number of blocks
+	unsigned int fragment = (((*bucketHandle)->capacity - sizeof(Toy_String)) & ~7u) - 1;
+
+	if (length <= fragment) {
 		return partitionStringLength(bucketHandle, cstring, length);
 	}
 
-	//break the string up if it's too long
-	Toy_String* result = NULL;
+	//split on a fragment boundary, so the tree is balanced
+	unsigned int fragments = (length + fragment - 1) / fragment;
+	unsigned int split = (fragments / 2) * fragment;
 
-	for (unsigned int i = 0; i < length; i += (*bucketHandle)->capacity - sizeof(Toy_String) - 1) { //increment by the amount actually used by the cstring
-		unsigned int amount = MIN((length - i), (*bucketHandle)->capacity - sizeof(Toy_String) - 1);
-		Toy_String* fragment = partitionStringLength(bucketHandle, cstring + i, amount);
+	Toy_String* left = fragmentStringLength(bucketHandle, cstring, split);
+	Toy_String* right = fragmentStringLength(bucketHandle, cstring + split, length - split);
 
-		result = result == NULL ? fragment : Toy_concatStrings(bucketHandle, result, fragment);
+	return partitionNode(bucketHandle, left, right);
+}
+
+//rebalancing, using a list of pieces that are already balanced
+static bool isBalanced(Toy_String* str) {
+	//a rope is balanced when it's at least as long as the fibonacci number of its depth + 2 (Boehm, Atkinson and Plass)
+	unsigned int previous = 1, current = 1;
+
+	for (unsigned int i = 0; i < str->depth; i++) {
+		unsigned int next = previous + current;
+
+		if (next < current) {
+			return false; //overflowed, so longer than any string can be
+		}
+
+		previous = current;
+		current = next;
 	}
 
-	return result;
+	return str->length >= current;
+}
+
+typedef struct PieceList {
+	Toy_String** data;
+	unsigned int count;
+	unsigned int capacity;
+} PieceList;
+
+static void pushPiece(PieceList* pieces, Toy_String* str) {
+	if (pieces->count + 1 > pieces->capacity) {
+		pieces->capacity = pieces->capacity > 0 ? pieces->capacity * 2 : 8;
+		pieces->data = realloc(pieces->data, pieces->capacity * sizeof(Toy_String*));
+
+		if (pieces->data == NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to allocate space for rebalancing a string\n" TOY_CC_RESET);
+			exit(-1);
+		}
+	}
+
+	pieces->data[pieces->count++] = str;
+}
+
+static void flushPieces(Toy_Bucket** bucketHandle, PieceList* pieces, Toy_StringBuilder* builder) {
+	if (builder->length > 0) {
+		pushPiece(pieces, Toy_buildString(bucketHandle, builder));
+	}
+}
+
+static void collectPieces(Toy_Bucket** bucketHandle, PieceList* pieces, Toy_StringBuilder* builder, Toy_String* str) {
+	//long leaves, and long nodes that are balanced and shallow, are shared as-is so appending to a rebalanced rope doesn't rebuild all of it
+	bool shared = str->length >= TOY_STRING_FLATTEN_LENGTH && (str->type != TOY_STRING_NODE || (str->depth <= TOY_STRING_MAX_DEPTH / 2 && isBalanced(str)));
+
+	if (shared) {
+		flushPieces(bucketHandle, pieces, builder);
+		incrementRefCount(str);
+		pushPiece(pieces, str);
+	}
+
+	else if (str->type == TOY_STRING_NODE) {
+		collectPieces(bucketHandle, pieces, builder, str->as.node.left);
+		collectPieces(bucketHandle, pieces, builder, str->as.node.right);
+	}
+
+	//short leaves are collapsed together
+	else {
+		Toy_appendCStringBuilder(builder, chunkOf(str), str->length);
+
+		if (builder->length >= TOY_STRING_FLATTEN_LENGTH) {
+			flushPieces(bucketHandle, pieces, builder);
+		}
+	}
+}
+
+static Toy_String* balancePieces(Toy_Bucket** bucketHandle, Toy_String** pieces, unsigned int count) {
+	if (count == 1) {
+		return pieces[0];
+	}
+
+	unsigned int half = count / 2;
+
+	Toy_String* left = balancePieces(bucketHandle, pieces, half);
+	Toy_String* right = balancePieces(bucketHandle, pieces + half, count - half);
+
+	return partitionNode(bucketHandle, left, right);
+}
+
+static Toy_String* rebalanceStrings(Toy_Bucket** bucketHandle, Toy_String* left, Toy_String* right) {
+	PieceList pieces = { .data = NULL, .count = 0, .capacity = 0 };
+
+	Toy_StringBuilder builder;
+	Toy_initStringBuilder(&builder);
+
+	collectPieces(bucketHandle, &pieces, &builder, left);
+	collectPieces(bucketHandle, &pieces, &builder, right);
+	flushPieces(bucketHandle, &pieces, &builder);
+
+	//both sides were empty
+	if (pieces.count == 0) {
+		pushPiece(&pieces, Toy_buildString(bucketHandle, &builder));
+	}
+
+	Toy_String* ret = balancePieces(bucketHandle, pieces.data, pieces.count);
+
+	free(pieces.data);
+	Toy_freeStringBuilder(&builder);
+
+	return ret;
+}
+
+//slicing, which shares what it can and copies what's too small to be worth sharing
+static Toy_String* sliceUtil(Toy_Bucket** bucketHandle, Toy_String* str, unsigned int start, unsigned int length) {
+	if (str->type == TOY_STRING_NODE) {
+		Toy_String* left = str->as.node.left;
+		Toy_String* right = str->as.node.right;
+
+		if (start + length <= left->length) {
+			return sliceUtil(bucketHandle, left, start, length);
+		}
+
+		if (start >= left->length) {
+			return sliceUtil(bucketHandle, right, start - left->length, length);
+		}
+
+		//straddles both sides, so the result is no deeper than the original
+		unsigned int leftLength = left->length - start;
+		return partitionNode(bucketHandle, sliceUtil(bucketHandle, left, start, leftLength), sliceUtil(bucketHandle, right, 0, length - leftLength));
+	}
+
+	//whole pieces are shared outright
+	if (start == 0 && length == str->length) {
+		incrementRefCount(str);
+		return str;
+	}
+
+	//views always look directly into a leaf
+	Toy_String* parent = str->type == TOY_STRING_VIEW ? str->as.view.parent : str;
+	const char* data = chunkOf(str) + start;
+
+	if (length < TOY_STRING_VIEW_MIN_LENGTH || length < parent->length / TOY_STRING_VIEW_MIN_SHARE) {
+		return fragmentStringLength(bucketHandle, data, length);
+	}
+
+	return partitionView(bucketHandle, parent, data, length);
+}
+
+//exposed functions
+Toy_String* Toy_createString(Toy_Bucket** bucketHandle, const char* cstring) {
+	unsigned int length = strlen(cstring);
+
+	return Toy_createStringLength(bucketHandle, cstring, length);
+}
+
+Toy_String* Toy_createStringLength(Toy_Bucket** bucketHandle, const char* cstring, unsigned int length) {
+	//breaks the string up if it's too long for the bucket
+	return fragmentStringLength(bucketHandle, cstring, length);
+}
+
+Toy_String* Toy_reserveStringLength(Toy_Bucket** bucketHandle, unsigned int length) {
+	return partitionLeaf(bucketHandle, length);
 }
 
 Toy_String* Toy_createNameStringLength(Toy_Bucket** bucketHandle, const char* cname, unsigned int length, Toy_ValueType type) {
@@ -99,9 +382,10 @@ Toy_String* Toy_createNameStringLength(Toy_Bucket** bucketHandle, const char* cn
 		exit(-1);
 	}
 
-	Toy_String* ret = (Toy_String*)Toy_partitionBucket(bucketHandle, sizeof(Toy_String) + length + 1);
+	Toy_String* ret = partitionString(bucketHandle, sizeof(Toy_String) + length + 1);
 
 	ret->type = TOY_STRING_NAME;
+	ret->depth = 0;
 	ret->length = length;
 	ret->refCount = 1;
 	ret->cachedHash = 0; //don't calc until needed
@@ -135,10 +419,11 @@ Toy_String* Toy_deepCopyString(Toy_Bucket** bucketHandle, Toy_String* str) {
 		return result;
 	}
 
-	Toy_String* ret = (Toy_String*)Toy_partitionBucket(bucketHandle, sizeof(Toy_String) + str->length + 1);
+	Toy_String* ret = partitionString(bucketHandle, sizeof(Toy_String) + str->length + 1);
 
-	if (str->type == TOY_STRING_NODE || str->type == TOY_STRING_LEAF) {
+	if (str->type != TOY_STRING_NAME) {
 		ret->type = TOY_STRING_LEAF;
+		ret->depth = 0;
 		ret->length = str->length;
 		ret->refCount = 1;
 		ret->cachedHash = str->cachedHash;
@@ -147,6 +432,7 @@ Toy_String* Toy_deepCopyString(Toy_Bucket** bucketHandle, Toy_String* str) {
 	}
 	else {
 		ret->type = TOY_STRING_NAME;
+		ret->depth = 0;
 		ret->length = str->length;
 		ret->refCount = 1;
 		ret->cachedHash = str->cachedHash;
@@ -168,23 +454,80 @@ Toy_String* Toy_concatStrings(Toy_Bucket** bucketHandle, Toy_String* left, Toy_S
 		exit(-1);
 	}
 
-	Toy_String* ret = (Toy_String*)Toy_partitionBucket(bucketHandle, sizeof(Toy_String));
-
-	ret->type = TOY_STRING_NODE;
-	ret->length = left->length + right->length;
-	ret->refCount = 1;
-	ret->cachedHash = 0; //don't calc until needed
-	ret->as.node.left = left;
-	ret->as.node.right = right;
+	//deep ropes are rebuilt from their existing pieces, rather than growing further
+	if ((left->depth > right->depth ? left->depth : right->depth) + 1 > TOY_STRING_MAX_DEPTH) {
+		return rebalanceStrings(bucketHandle, left, right);
+	}
 
 	incrementRefCount(left);
 	incrementRefCount(right);
 
-	return ret;
+	return partitionNode(bucketHandle, left, right);
+}
+
+Toy_String* Toy_sliceString(Toy_Bucket** bucketHandle, Toy_String* str, unsigned int start, unsigned int length) {
+	if (str->type == TOY_STRING_NAME) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Can't slice a name string\n" TOY_CC_RESET);
+		exit(-1);
+	}
+
+	if (str->refCount == 0) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Can't slice a string with refcount of zero\n" TOY_CC_RESET);
+		exit(-1);
+	}
+
+	if (start > str->length || length > str->length - start) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Can't slice %d characters from position %d of a string with length %d\n" TOY_CC_RESET, (int)length, (int)start, (int)str->length);
+		exit(-1);
+	}
+
+	//short slices of ropes are gathered into a single leaf, rather than a node for each leaf they cross
+	if (str->type == TOY_STRING_NODE && length < TOY_STRING_VIEW_MIN_LENGTH) {
+		char buffer[TOY_STRING_VIEW_MIN_LENGTH];
+		unsigned int position = 0, gathered = 0;
+
+		Toy_StringIterator iter;
+		Toy_initStringIterator(&iter, str);
+
+		while (gathered < length && Toy_nextStringChunk(&iter)) {
+			unsigned int from = start > position ? start - position : 0;
+
+			if (from < iter.length) {
+				unsigned int amount = iter.length - from < length - gathered ? iter.length - from : length - gathered;
+				memcpy(buffer + gathered, iter.chunk + from, amount);
+				gathered += amount;
+			}
+
+			position += iter.length;
+		}
+
+		return fragmentStringLength(bucketHandle, buffer, length);
+	}
+
+	return sliceUtil(bucketHandle, str, start, length);
 }
 
 void Toy_freeString(Toy_String* str) {
-	decrementRefCount(str); //TODO: tool for checking the bucket is empty, and freeing it
+	if (str->refCount == 0) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Can't free a string with refcount of zero\n" TOY_CC_RESET);
+		exit(-1);
+	}
+
+	decrementRefCount(str);
+}
+
+Toy_String* Toy_private_pinString(Toy_String* str) {
+	//a node's children, and a view's parent, are read along with it
+	if (str->type == TOY_STRING_NODE) {
+		Toy_private_pinString(str->as.node.left);
+		Toy_private_pinString(str->as.node.right);
+	}
+	else if (str->type == TOY_STRING_VIEW) {
+		Toy_private_pinString(str->as.view.parent);
+	}
+
+	str->refCount = PINNED_REFCOUNT;
+	return str;
 }
 
 unsigned int Toy_getStringLength(Toy_String* str) {
@@ -223,117 +566,174 @@ char* Toy_getStringRawBuffer(Toy_String* str) {
 	return buffer;
 }
 
-static int deepCompareUtil(Toy_String* left, Toy_String* right, const char** leftHead, const char** rightHead) {
-	//WARNING: this function can't handle strings of zero length
-	int result = 0;
-
-	//if it's the same object, of course they match
+int Toy_compareStrings(Toy_String* left, Toy_String* right) {
+	//interned and shared strings are often the same object
 	if (left == right) {
-		return result;
+		return 0;
 	}
 
-	//BUGFIX: if we're not currently iterating through the left leaf (and leftHead is not null), skip out
-	if (left->type == TOY_STRING_LEAF && (*leftHead) != NULL && (**leftHead) != '\0' && ((*leftHead) < left->as.leaf.data || (*leftHead) > (left->as.leaf.data + strlen(left->as.leaf.data))) ) {
-		return result;
-	}
+	if (left->type == TOY_STRING_NAME || right->type == TOY_STRING_NAME) {
+		if (left->type != right->type) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Can't compare a name string to a non-name string\n" TOY_CC_RESET);
+			exit(-1);
+		}
 
-	//BUGFIX: if we're not currently iterating through the right leaf (and rightHead is not null), skip out
-	if (right->type == TOY_STRING_LEAF && (*rightHead) != NULL && (**rightHead) != '\0' && ((*rightHead) < right->as.leaf.data || (*rightHead) > (right->as.leaf.data + strlen(right->as.leaf.data))) ) {
-		return result;
+		return strcmp(left->as.name.data, right->as.name.data);
 	}
 
-	//dig into left
-	if (left->type == TOY_STRING_NODE) {
-		if ((result = deepCompareUtil(left->as.node.left, right, leftHead, rightHead)) != 0) {
-			return result;
-		}
-		if ((result = deepCompareUtil(left->as.node.right, right, leftHead, rightHead)) != 0) {
-			return result;
-		}
+	//walk both sets of chunks side by side, which needn't line up
+	Toy_StringIterator leftIter, rightIter;
+	Toy_initStringIterator(&leftIter, left);
+	Toy_initStringIterator(&rightIter, right);
 
-		//return zero to keep going
-		return result;
-	}
+	bool leftMore = Toy_nextStringChunk(&leftIter);
+	bool rightMore = Toy_nextStringChunk(&rightIter);
 
-	//dig into right
-	if (right->type == TOY_STRING_NODE) {
-		if ((result = deepCompareUtil(left, right->as.node.left, leftHead, rightHead)) != 0) {
-			return result;
-		}
+	while (leftMore && rightMore) {
+		unsigned int length = leftIter.length < rightIter.length ? leftIter.length : rightIter.length;
 
-		if ((result = deepCompareUtil(left, right->as.node.right, leftHead, rightHead)) != 0) {
+		int result = memcmp(leftIter.chunk, rightIter.chunk, length);
+		if (result != 0) {
 			return result;
 		}
 
-		//return zero to keep going
-		return result;
-	}
+		leftIter.chunk += length;
+		leftIter.length -= length;
+		rightIter.chunk += length;
+		rightIter.length -= length;
 
-	//keep comparing the leaves
-	if (left->type == TOY_STRING_LEAF && right->type == TOY_STRING_LEAF) {
-		//initial head states can be null, or null characters
-		if ((*leftHead) == NULL || (**leftHead) == '\0') {
-			(*leftHead) = left->as.leaf.data;
+		if (leftIter.length == 0) {
+			leftMore = Toy_nextStringChunk(&leftIter);
 		}
-
-		if ((*rightHead) == NULL || (**rightHead) == '\0') {
-			(*rightHead) = right->as.leaf.data;
+		if (rightIter.length == 0) {
+			rightMore = Toy_nextStringChunk(&rightIter);
 		}
+	}
 
-		//compare and increment
-		while (**leftHead && (**leftHead == **rightHead)) {
-			(*leftHead)++;
-			(*rightHead)++;
-		}
+	//one is a prefix of the other, so the shorter one comes first
+	return leftMore - rightMore;
+}
 
-		//if both are not null, then it's a real result
-		if ( (**leftHead == '\0' || **rightHead == '\0') == false) {
-			result = *(const unsigned char*)(*leftHead) - *(const unsigned char*)(*rightHead);
-		}
+bool Toy_equalStrings(Toy_String* left, Toy_String* right) {
+	if (left == right) {
+		return true;
 	}
 
-	//if either are a null character, return 0 to check the next node
-	return result;
+	//different lengths, or different hashes, can't be equal
+	if (left->length != right->length || (left->cachedHash != 0 && right->cachedHash != 0 && left->cachedHash != right->cachedHash)) {
+		return false;
+	}
+
+	return Toy_compareStrings(left, right) == 0;
 }
 
-int Toy_compareStrings(Toy_String* left, Toy_String* right) {
-	//BUGFIX: since deepCompareUtil() can't handle strings of length zero, insert a check here
-	if (left->length == 0 || right->length == 0) {
-		return left->length - right->length;
-	}
+//the polynomial's low bits are weak, and tables only use the low bits, so mix them (murmur3's finalizer)
+static unsigned int finalizeHash(unsigned int hash) {
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16;
 
-	if (left->type == TOY_STRING_NAME || right->type == TOY_STRING_NAME) {
-		if (left->type != right->type) {
-			fprintf(stderr, TOY_CC_ERROR "ERROR: Can't compare a name string to a non-name string\n" TOY_CC_RESET);
-			exit(-1);
+	return hash;
+}
+
+unsigned int Toy_hashString(Toy_String* str) {
+	return finalizeHash(rawHashString(str));
+}
+
+unsigned int Toy_hashCString(const char* cstring, unsigned int length) {
+	return finalizeHash(hashStringLength(cstring, length));
+}
+
+void Toy_initStringIterator(Toy_StringIterator* iter, Toy_String* str) {
+	iter->stack[0] = str;
+	iter->top = 1;
+
+	iter->chunk = NULL;
+	iter->length = 0;
+}
+
+bool Toy_nextStringChunk(Toy_StringIterator* iter) {
+	while (iter->top > 0) {
+		Toy_String* str = iter->stack[--iter->top];
+
+		//go left, leaving the right branches for later
+		while (str->type == TOY_STRING_NODE) {
+			iter->stack[iter->top++] = str->as.node.right;
+			str = str->as.node.left;
 		}
 
-		return strcmp(left->as.name.data, right->as.name.data);
+		//empty leaves have nothing to give
+		if (str->length == 0) {
+			continue;
+		}
+
+		iter->chunk = chunkOf(str);
+		iter->length = str->length;
+		return true;
 	}
 
-	//util pointers
-	const char* leftHead = NULL;
-	const char* rightHead = NULL;
+	iter->chunk = NULL;
+	iter->length = 0;
+	return false;
+}
 
-	return deepCompareUtil(left, right, &leftHead, &rightHead);
+void Toy_initStringBuilder(Toy_StringBuilder* builder) {
+	builder->data = NULL;
+	builder->length = 0;
+	builder->capacity = 0;
 }
 
-unsigned int Toy_hashString(Toy_String* str) {
-	if (str->cachedHash != 0) {
-		return str->cachedHash;
+void Toy_freeStringBuilder(Toy_StringBuilder* builder) {
+	free(builder->data);
+	Toy_initStringBuilder(builder);
+}
+
+void Toy_appendStringBuilder(Toy_StringBuilder* builder, Toy_String* str) {
+	if (str->type == TOY_STRING_NAME) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Can't append a name string to a string builder\n" TOY_CC_RESET);
+		exit(-1);
 	}
-	else if (str->type == TOY_STRING_NODE) {
-		//TODO: I wonder if it would be possible to discretely swap the composite node string with a new leaf string here? Would that speed up other parts of the code by not having to walk the tree in future?
-		char* buffer = Toy_getStringRawBuffer(str);
-		str->cachedHash = hashCString(buffer);
-		free(buffer);
+
+	Toy_StringIterator iter;
+	Toy_initStringIterator(&iter, str);
+
+	while (Toy_nextStringChunk(&iter)) {
+		Toy_appendCStringBuilder(builder, iter.chunk, iter.length);
 	}
-	else if (str->type == TOY_STRING_LEAF) {
-		str->cachedHash = hashCString(str->as.leaf.data);
+}
+
+void Toy_appendCStringBuilder(Toy_StringBuilder* builder, const char* cstring, unsigned int length) {
+	//a fresh builder has no data to copy into yet
+	if (length == 0) {
+		return;
 	}
-	else if (str->type == TOY_STRING_NAME) {
-		str->cachedHash = hashCString(str->as.name.data);
+
+	if (builder->length + length > builder->capacity) {
+		unsigned int capacity = builder->capacity > 0 ? builder->capacity : TOY_STRING_BUILDER_INITIAL_CAPACITY;
+
+		while (builder->length + length > capacity) {
+			capacity *= TOY_STRING_BUILDER_EXPANSION_RATE;
+		}
+
+		char* data = realloc(builder->data, capacity);
+
+		if (data == NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_StringBuilder' of %d capacity\n" TOY_CC_RESET, (int)capacity);
+			exit(1);
+		}
+
+		builder->data = data;
+		builder->capacity = capacity;
 	}
 
-	return str->cachedHash;
+	memcpy(builder->data + builder->length, cstring, length);
+	builder->length += length;
+}
+
+Toy_String* Toy_buildString(Toy_Bucket** bucketHandle, Toy_StringBuilder* builder) {
+	Toy_String* ret = Toy_createStringLength(bucketHandle, builder->data != NULL ? builder->data : "", builder->length);
+	builder->length = 0;
+	return ret;
 }
@@ -5,16 +5,23 @@
 #include "toy_bucket.h"
 #include "toy_value.h"
 
+#include <limits.h>
+
 //rope pattern
+typedef enum Toy_StringType {
+	TOY_STRING_NODE,
+	TOY_STRING_LEAF,
+	TOY_STRING_NAME,
+	TOY_STRING_VIEW,
+} Toy_StringType;
+
 typedef struct Toy_String {             //32 | 64 BITNESS
-	enum Toy_StringType {
-		TOY_STRING_NODE,
-		TOY_STRING_LEAF,
-		TOY_STRING_NAME,
-	} type;                             //4  | 4
+	unsigned char type;                 //1  | 1
+	unsigned char depth;                //1  | 1  - longest path from a node to its leaves, zero for everything else
+	unsigned short bucketOffset;        //2  | 2  - words from the start of its bucket's data, so it can be given back
 
 	unsigned int length;                //4  | 4
-	unsigned int refCount;              //4  | 4
+	unsigned int refCount;              //4  | 4  - nodes hold one reference to each child
 	unsigned int cachedHash;            //4  | 4
 
 	union {
@@ -32,11 +39,37 @@ typedef struct Toy_String {             //32 | 64 BITNESS
 			Toy_ValueType type;         //4  | 4
 			char data[];                //-  | -
 		} name;                         //4  | 4
+
+		struct {
+			struct Toy_String* parent;  //4  | 8  - always a leaf, which the view holds a reference to
+			const char* data;           //4  | 8  - somewhere within the parent, not null-terminated
+		} view;                         //8  | 16
 	} as;                               //8  | 16
 } Toy_String;                           //24 | 32
 
+//concatenating past this depth rebalances the rope, so walking it stays cheap - must fit in 'depth'
+#ifndef TOY_STRING_MAX_DEPTH
+#define TOY_STRING_MAX_DEPTH 32
+#endif
+
+//when rebalancing, runs of leaves shorter than this are collapsed into a single leaf
+#ifndef TOY_STRING_FLATTEN_LENGTH
+#define TOY_STRING_FLATTEN_LENGTH 256
+#endif
+
+//slices shorter than this are copied, as a view costs as much as a short leaf
+#ifndef TOY_STRING_VIEW_MIN_LENGTH
+#define TOY_STRING_VIEW_MIN_LENGTH 32
+#endif
+
+//slices covering less than 1/N of a leaf are copied too, so a small view doesn't keep a large leaf alive
+#ifndef TOY_STRING_VIEW_MIN_SHARE
+#define TOY_STRING_VIEW_MIN_SHARE 8
+#endif
+
 TOY_API Toy_String* Toy_createString(Toy_Bucket** bucketHandle, const char* cstring);
 TOY_API Toy_String* Toy_createStringLength(Toy_Bucket** bucketHandle, const char* cstring, unsigned int length);
+TOY_API Toy_String* Toy_reserveStringLength(Toy_Bucket** bucketHandle, unsigned int length); //a single leaf whose characters are left for the caller to write, so must fit in the bucket
 
 TOY_API Toy_String* Toy_createNameStringLength(Toy_Bucket** bucketHandle, const char* cname, unsigned int length, Toy_ValueType type); //for variable names
 
@@ -44,9 +77,13 @@ TOY_API Toy_String* Toy_copyString(Toy_String* str);
 TOY_API Toy_String* Toy_deepCopyString(Toy_Bucket** bucketHandle, Toy_String* str);
 
 TOY_API Toy_String* Toy_concatStrings(Toy_Bucket** bucketHandle, Toy_String* left, Toy_String* right);
+TOY_API Toy_String* Toy_sliceString(Toy_Bucket** bucketHandle, Toy_String* str, unsigned int start, unsigned int length); //shares the original's leaves where it can, rather than copying
 
 TOY_API void Toy_freeString(Toy_String* str);
 
+//NOTE: exposed so Toy_SharedTable can hand its strings to many threads; only for strings nobody else holds, as they're never given back afterwards
+TOY_API Toy_String* Toy_private_pinString(Toy_String* str);
+
 TOY_API unsigned int Toy_getStringLength(Toy_String* str);
 TOY_API unsigned int Toy_getStringRefCount(Toy_String* str);
 TOY_API Toy_ValueType Toy_getNameStringType(Toy_String* str);
@@ -54,5 +91,42 @@ TOY_API Toy_ValueType Toy_getNameStringType(Toy_String* str);
 TOY_API char* Toy_getStringRawBuffer(Toy_String* str); //allocates the buffer on the heap, needs to be freed
 
 TOY_API int Toy_compareStrings(Toy_String* left, Toy_String* right); //return value mimics strcmp()
+TOY_API bool Toy_equalStrings(Toy_String* left, Toy_String* right); //faster than Toy_compareStrings() when only equality matters
 
 TOY_API unsigned int Toy_hashString(Toy_String* string);
+TOY_API unsigned int Toy_hashCString(const char* cstring, unsigned int length); //matches Toy_hashString() for the same contents
+
+//walks a string's leaves in order, one contiguous chunk at a time, without allocating
+typedef struct Toy_StringIterator {
+	Toy_String* stack[UCHAR_MAX]; //pending right branches, which can't outnumber the depth
+	unsigned int top;
+
+	const char* chunk; //not null-terminated
+	unsigned int length;
+} Toy_StringIterator;
+
+TOY_API void Toy_initStringIterator(Toy_StringIterator* iter, Toy_String* str);
+TOY_API bool Toy_nextStringChunk(Toy_StringIterator* iter); //false when there are no more chunks
+
+//mutable buffer for building strings piece by piece, without creating a rope node for each piece
+typedef struct Toy_StringBuilder {
+	char* data;
+	unsigned int length;
+	unsigned int capacity;
+} Toy_StringBuilder;
+
+#ifndef TOY_STRING_BUILDER_INITIAL_CAPACITY
+#define TOY_STRING_BUILDER_INITIAL_CAPACITY 64
+#endif
+
+#ifndef TOY_STRING_BUILDER_EXPANSION_RATE
+#define TOY_STRING_BUILDER_EXPANSION_RATE 2
+#endif
+
+TOY_API void Toy_initStringBuilder(Toy_StringBuilder* builder);
+TOY_API void Toy_freeStringBuilder(Toy_StringBuilder* builder);
+
+TOY_API void Toy_appendStringBuilder(Toy_StringBuilder* builder, Toy_String* str);
+TOY_API void Toy_appendCStringBuilder(Toy_StringBuilder* builder, const char* cstring, unsigned int length);
+
+TOY_API Toy_String* Toy_buildString(Toy_Bucket** bucketHandle, Toy_StringBuilder* builder); //empties the builder, keeping its buffer
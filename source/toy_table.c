@@ -6,16 +6,252 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if TOY_TABLE_SWISS
+
+//each group of control bytes is matched at once, giving a bitmask with one bit per slot
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+
+static inline unsigned int matchByte(const unsigned char* group, unsigned char byte) {
+	__m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+}
+
+static inline unsigned int matchFree(const unsigned char* group) {
+	//empty and deleted are the only control bytes with the high bit set
+	return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+
+static inline unsigned int maskOf(uint8x16_t lanes) {
+	//keep a different bit from each lane, then add up each half
+	static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+	uint8x16_t masked = vandq_u8(lanes, vld1q_u8(bits));
+	return vaddv_u8(vget_low_u8(masked)) | (vaddv_u8(vget_high_u8(masked)) << 8);
+}
+
+static inline unsigned int matchByte(const unsigned char* group, unsigned char byte) {
+	return maskOf(vceqq_u8(vld1q_u8(group), vdupq_n_u8(byte)));
+}
+
+static inline unsigned int matchFree(const unsigned char* group) {
+	return maskOf(vtstq_u8(vld1q_u8(group), vdupq_n_u8(0x80)));
+}
+
+#else
+
+static inline unsigned int matchByte(const unsigned char* group, unsigned char byte) {
+	unsigned int mask = 0;
+	for (int i = 0; i < TOY_TABLE_GROUP_WIDTH; i++) {
+		mask |= (unsigned int)(group[i] == byte) << i;
+	}
+	return mask;
+}
+
+static inline unsigned int matchFree(const unsigned char* group) {
+	unsigned int mask = 0;
+	for (int i = 0; i < TOY_TABLE_GROUP_WIDTH; i++) {
+		mask |= (unsigned int)(group[i] >> 7) << i;
+	}
+	return mask;
+}
+
+#endif
+
+static inline unsigned int lowestBit(unsigned int mask) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctz(mask);
+#else
+	unsigned int index = 0;
+	while ((mask & 1) == 0) {
+		mask >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+//the high bits pick the first group, while the low 7 bits are kept in the control byte
+#define HASH_GROUP(table, hash) (((hash) >> 7) & (table)->mask)
+#define HASH_FRAGMENT(hash) ((unsigned char)((hash) & 0x7F))
+
 //utils
-static void probeAndInsert(Toy_Table** tableHandle, Toy_Value key, Toy_Value value) {
+static int findSlot(Toy_Table* table, Toy_Value key, unsigned int hash) {
+	unsigned char fragment = HASH_FRAGMENT(hash);
+	unsigned int group = HASH_GROUP(table, hash);
+
+	for (unsigned int step = 1; /* EMPTY */; step++) {
+		const unsigned char* ctrl = table->ctrl + group * TOY_TABLE_GROUP_WIDTH;
+
+		//only keys whose fragment matches are compared
+		for (unsigned int match = matchByte(ctrl, fragment); match != 0; match &= match - 1) {
+			unsigned int slot = group * TOY_TABLE_GROUP_WIDTH + lowestBit(match);
+
+			if (TOY_VALUES_ARE_EQUAL(table->keys[slot], key)) {
+				return slot;
+			}
+		}
+
+		//an empty slot means no insertion ever probed past this group
+		if (matchByte(ctrl, TOY_TABLE_CTRL_EMPTY) != 0) {
+			return -1;
+		}
+
+		//triangular steps visit every group, as the number of groups is a power of two
+		group = (group + step) & table->mask;
+	}
+}
+
+static void placeEntry(Toy_Table* table, Toy_Value key, Toy_Value value, unsigned int hash) {
+	unsigned int group = HASH_GROUP(table, hash);
+
+	//the first empty or deleted slot along the key's probe sequence
+	for (unsigned int step = 1; /* EMPTY */; step++) {
+		unsigned int free = matchFree(table->ctrl + group * TOY_TABLE_GROUP_WIDTH);
+
+		if (free != 0) {
+			unsigned int slot = group * TOY_TABLE_GROUP_WIDTH + lowestBit(free);
+
+			if (table->ctrl[slot] == TOY_TABLE_CTRL_DELETED) {
+				table->deleted--;
+			}
+
+			table->ctrl[slot] = HASH_FRAGMENT(hash);
+			table->keys[slot] = key;
+			table->values[slot] = value;
+			table->count++;
+			return;
+		}
+
+		group = (group + step) & table->mask;
+	}
+}
+
+//exposed functions
+Toy_Table* Toy_private_adjustTableCapacity(Toy_Table* oldTable, unsigned int newCapacity) {
+	//whole groups, and a power of two so the groups can be picked with a mask
+	unsigned int capacity = TOY_TABLE_GROUP_WIDTH;
+	while (capacity < newCapacity) {
+		capacity *= 2;
+	}
+
+	//allocate a new table in memory
+	Toy_Table* newTable = malloc(TOY_TABLE_SIZE(capacity));
+
+	if (newTable == NULL) {
+		Toy_error(TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_Table'\n" TOY_CC_RESET);
+	}
+
+	newTable->capacity = capacity;
+	newTable->count = 0;
+	newTable->deleted = 0;
+	newTable->mask = capacity / TOY_TABLE_GROUP_WIDTH - 1;
+	newTable->keys = (Toy_Value*)(newTable->ctrl + capacity);
+	newTable->values = newTable->keys + capacity;
+
+	//every slot starts empty, with null keys and values
+	memset(newTable->ctrl, TOY_TABLE_CTRL_EMPTY, capacity);
+	memset(newTable->keys, 0, capacity * sizeof(Toy_Value) * 2);
+
+	if (oldTable == NULL) { //for initial allocations
+		return newTable;
+	}
+
+	//for each entry in the old table, copy it into the new table, leaving the tombstones behind
+	for (unsigned int i = 0; i < oldTable->capacity; i++) {
+		if ((oldTable->ctrl[i] & 0x80) == 0) {
+			placeEntry(newTable, oldTable->keys[i], oldTable->values[i], Toy_hashValue(oldTable->keys[i]));
+		}
+	}
+
+	//clean up and return
+	free(oldTable);
+	return newTable;
+}
+
+Toy_Value* Toy_private_lookupTableValue(Toy_Table* table, Toy_Value key, unsigned int hash) {
+	int slot = findSlot(table, key, hash);
+	return slot >= 0 ? &(table->values[slot]) : NULL;
+}
+
+void Toy_insertTable(Toy_Table** tableHandle, Toy_Value key, Toy_Value value) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad table key\n" TOY_CC_RESET);
+	}
+
+	unsigned int hash = Toy_hashValue(key);
+
+	//if we're overriding an existing value
+	int slot = findSlot((*tableHandle), key, hash);
+
+	if (slot >= 0) {
+		(*tableHandle)->keys[slot] = key;
+		(*tableHandle)->values[slot] = value;
+		return;
+	}
+
+	//expand the capacity, where tombstones count too, as they lengthen the probes just the same
+	if ((*tableHandle)->count + (*tableHandle)->deleted > (*tableHandle)->capacity * TOY_TABLE_EXPANSION_THRESHOLD) {
+		//a table that's mostly tombstones is only cleaned out
+		bool grow = (*tableHandle)->count > (*tableHandle)->capacity * TOY_TABLE_EXPANSION_THRESHOLD / 2;
+		(*tableHandle) = Toy_private_adjustTableCapacity((*tableHandle), grow ? (*tableHandle)->capacity * TOY_TABLE_EXPANSION_RATE : (*tableHandle)->capacity);
+	}
+
+	placeEntry((*tableHandle), key, value, hash);
+}
+
+Toy_Value Toy_lookupTable(Toy_Table** tableHandle, Toy_Value key) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad table key\n" TOY_CC_RESET);
+	}
+
+	int slot = findSlot((*tableHandle), key, Toy_hashValue(key));
+	return slot >= 0 ? (*tableHandle)->values[slot] : TOY_VALUE_FROM_NULL();
+}
+
+void Toy_removeTable(Toy_Table** tableHandle, Toy_Value key) {
+	if (TOY_VALUE_IS_NULL(key) || TOY_VALUE_IS_BOOLEAN(key)) { //TODO: disallow functions and opaques
+		Toy_error(TOY_CC_ERROR "ERROR: Bad table key\n" TOY_CC_RESET);
+	}
+
+	int slot = findSlot((*tableHandle), key, Toy_hashValue(key));
+
+	if (slot < 0) {
+		return;
+	}
+
+	//a group with an empty slot has never been probed past, so the slot can be emptied too, otherwise it's a tombstone
+	Toy_Table* table = (*tableHandle);
+	const unsigned char* group = table->ctrl + (slot / TOY_TABLE_GROUP_WIDTH) * TOY_TABLE_GROUP_WIDTH;
+
+	if (matchByte(group, TOY_TABLE_CTRL_EMPTY) != 0) {
+		table->ctrl[slot] = TOY_TABLE_CTRL_EMPTY;
+	}
+	else {
+		table->ctrl[slot] = TOY_TABLE_CTRL_DELETED;
+		table->deleted++;
+	}
+
+	table->keys[slot] = TOY_VALUE_FROM_NULL();
+	table->values[slot] = TOY_VALUE_FROM_NULL();
+	table->count--;
+}
+
+#else
+
+//utils
+static void probeAndInsert(Toy_Table** tableHandle, Toy_Value key, Toy_Value value, unsigned int hash) {
 	//make the entry
-	unsigned int probe = Toy_hashValue(key) % (*tableHandle)->capacity;
-	Toy_TableEntry entry = (Toy_TableEntry){ .key = key, .value = value, .psl = 0 };
+	unsigned int mask = (*tableHandle)->capacity - 1;
+	unsigned int probe = hash & mask;
+	Toy_TableEntry entry = (Toy_TableEntry){ .key = key, .value = value, .psl = 0, .hash = hash };
 
 	//probe
 	while (true) {
-		//if we're overriding an existing value
-		if (TOY_VALUES_ARE_EQUAL((*tableHandle)->data[probe].key, key)) {
+		//if we're overriding an existing value, where the hashes rule out nearly every mismatch before comparing
+		if ((*tableHandle)->data[probe].hash == entry.hash && TOY_VALUES_ARE_EQUAL((*tableHandle)->data[probe].key, entry.key)) {
 			(*tableHandle)->data[probe] = entry;
 
 			//TODO: benchmark the psl optimisation
@@ -46,21 +282,27 @@ static void probeAndInsert(Toy_Table** tableHandle, Toy_Value key, Toy_Value val
 		}
 
 		//adjust and continue
-		probe = (probe + 1) % (*tableHandle)->capacity;
+		probe = (probe + 1) & mask;
 		entry.psl++;
 	}
 }
 
 //exposed functions
 Toy_Table* Toy_private_adjustTableCapacity(Toy_Table* oldTable, unsigned int newCapacity) {
+	//a power of two, so the index is a mask
+	unsigned int capacity = 1;
+	while (capacity < newCapacity) {
+		capacity *= 2;
+	}
+
 	//allocate and zero a new table in memory
-	Toy_Table* newTable = malloc(newCapacity * sizeof(Toy_TableEntry) + sizeof(Toy_Table));
+	Toy_Table* newTable = malloc(TOY_TABLE_SIZE(capacity));
 
 	if (newTable == NULL) {
 		Toy_error(TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_Table'\n" TOY_CC_RESET);
 	}
 
-	newTable->capacity = newCapacity;
+	newTable->capacity = capacity;
 	newTable->count = 0;
 	newTable->minPsl = 0;
 	newTable->maxPsl = 0;
@@ -72,10 +314,10 @@ Toy_Table* Toy_private_adjustTableCapacity(Toy_Table* oldTable, unsigned int new
 		return newTable;
 	}
 
-	//for each entry in the old table, copy it into the new table
+	//for each entry in the old table, copy it into the new table, reusing the hash
 	for (int i = 0; i < oldTable->capacity; i++) {
 		if (!TOY_VALUE_IS_NULL(oldTable->data[i].key)) {
-			probeAndInsert(&newTable, oldTable->data[i].key, oldTable->data[i].value);
+			probeAndInsert(&newTable, oldTable->data[i].key, oldTable->data[i].value, oldTable->data[i].hash);
 		}
 	}
 
@@ -84,14 +326,27 @@ Toy_Table* Toy_private_adjustTableCapacity(Toy_Table* oldTable, unsigned int new
 	return newTable;
 }
 
-Toy_Table* Toy_allocateTable() {
-	return Toy_private_adjustTableCapacity(NULL, TOY_TABLE_INITIAL_CAPACITY);
-}
+Toy_Value* Toy_private_lookupTableValue(Toy_Table* table, Toy_Value key, unsigned int hash) {
+	//lookup
+	unsigned int mask = table->capacity - 1;
+	unsigned int probe = hash & mask;
+	unsigned int distance = 0;
 
-void Toy_freeTable(Toy_Table* table) {
-	//TODO: slip in a call to free the complex values here
+	while (true) {
+		//found the entry
+		if (table->data[probe].hash == hash && TOY_VALUES_ARE_EQUAL(table->data[probe].key, key)) {
+			return &(table->data[probe].value);
+		}
 
-	free(table);
+		//if its an empty slot, or one nearer its home than the key would be, since insertion would have displaced it
+		if (TOY_VALUE_IS_NULL(table->data[probe].key) || table->data[probe].psl < distance) {
+			return NULL;
+		}
+
+		//adjust and continue
+		probe = (probe + 1) & mask;
+		distance++;
+	}
 }
 
 void Toy_insertTable(Toy_Table** tableHandle, Toy_Value key, Toy_Value value) {
@@ -104,7 +359,7 @@ void Toy_insertTable(Toy_Table** tableHandle, Toy_Value key, Toy_Value value) {
 		(*tableHandle) = Toy_private_adjustTableCapacity((*tableHandle), (*tableHandle)->capacity * TOY_TABLE_EXPANSION_RATE);
 	}
 
-	probeAndInsert(tableHandle, key, value);
+	probeAndInsert(tableHandle, key, value, Toy_hashValue(key));
 }
 
 Toy_Value Toy_lookupTable(Toy_Table** tableHandle, Toy_Value key) {
@@ -112,23 +367,8 @@ Toy_Value Toy_lookupTable(Toy_Table** tableHandle, Toy_Value key) {
 		Toy_error(TOY_CC_ERROR "ERROR: Bad table key\n" TOY_CC_RESET);
 	}
 
-	//lookup
-	unsigned int probe = Toy_hashValue(key) % (*tableHandle)->capacity;
-
-	while (true) {
-		//found the entry
-		if (TOY_VALUES_ARE_EQUAL((*tableHandle)->data[probe].key, key)) {
-			return (*tableHandle)->data[probe].value;
-		}
-
-		//if its an empty slot
-		if (TOY_VALUE_IS_NULL((*tableHandle)->data[probe].key)) {
-			return TOY_VALUE_FROM_NULL();
-		}
-
-		//adjust and continue
-		probe = (probe + 1) % (*tableHandle)->capacity;
-	}
+	Toy_Value* value = Toy_private_lookupTableValue((*tableHandle), key, Toy_hashValue(key));
+	return value != NULL ? (*value) : TOY_VALUE_FROM_NULL();
 }
 
 void Toy_removeTable(Toy_Table** tableHandle, Toy_Value key) {
@@ -137,40 +377,54 @@ void Toy_removeTable(Toy_Table** tableHandle, Toy_Value key) {
 	}
 
 	//lookup
-	unsigned int probe = Toy_hashValue(key) % (*tableHandle)->capacity;
-	unsigned int wipe = probe; //wiped at the end
+	unsigned int hash = Toy_hashValue(key);
+	unsigned int mask = (*tableHandle)->capacity - 1;
+	unsigned int probe = hash & mask;
+	unsigned int distance = 0;
 
 	while (true) {
 		//found the entry
-		if (TOY_VALUES_ARE_EQUAL((*tableHandle)->data[probe].key, key)) {
+		if ((*tableHandle)->data[probe].hash == hash && TOY_VALUES_ARE_EQUAL((*tableHandle)->data[probe].key, key)) {
 			break;
 		}
 
-		//if its an empty slot
-		if (TOY_VALUE_IS_NULL((*tableHandle)->data[probe].key)) {
+		//if its an empty slot, or the key can't be any further along
+		if (TOY_VALUE_IS_NULL((*tableHandle)->data[probe].key) || (*tableHandle)->data[probe].psl < distance) {
 			return;
 		}
 
 		//adjust and continue
-		probe = (probe + 1) % (*tableHandle)->capacity;
+		probe = (probe + 1) & mask;
+		distance++;
 	}
 
-	//shift along the later entries
-	for (unsigned int i = (*tableHandle)->minPsl; i < (*tableHandle)->maxPsl; i++) {
-		unsigned int p = (probe + i + 0) % (*tableHandle)->capacity; //prev
-		unsigned int u = (probe + i + 1) % (*tableHandle)->capacity; //current
-
-		(*tableHandle)->data[p] = (*tableHandle)->data[u];
-		(*tableHandle)->data[p].psl--;
+	//shift back the later entries, until one is already where it should be, or there's nothing at all
+	while (true) {
+		unsigned int next = (probe + 1) & mask;
 
-		//if you hit something where it should be, or nothing at all, stop
-		if (TOY_VALUE_IS_NULL((*tableHandle)->data[u].key) || (*tableHandle)->data[p].psl == 0) {
-			wipe = u;
+		if (TOY_VALUE_IS_NULL((*tableHandle)->data[next].key) || (*tableHandle)->data[next].psl == 0) {
 			break;
 		}
+
+		(*tableHandle)->data[probe] = (*tableHandle)->data[next];
+		(*tableHandle)->data[probe].psl--;
+		probe = next;
 	}
 
-	//finally, wipe the removed entry
-	(*tableHandle)->data[wipe] = (Toy_TableEntry){ .key = TOY_VALUE_FROM_NULL(), .value = TOY_VALUE_FROM_NULL(), .psl = 0 };
+	//finally, wipe the last entry moved, or the removed entry
+	(*tableHandle)->data[probe] = (Toy_TableEntry){ .key = TOY_VALUE_FROM_NULL(), .value = TOY_VALUE_FROM_NULL(), .psl = 0, .hash = 0 };
 	(*tableHandle)->count--;
 }
+
+#endif
+
+//exposed functions, shared by both layouts
+Toy_Table* Toy_allocateTable() {
+	return Toy_private_adjustTableCapacity(NULL, TOY_TABLE_INITIAL_CAPACITY);
+}
+
+void Toy_freeTable(Toy_Table* table) {
+	//TODO: slip in a call to free the complex values here
+
+	free(table);
+}
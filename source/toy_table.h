@@ -3,14 +3,46 @@
 #include "toy_common.h"
 #include "toy_value.h"
 
-//key-value entry, and probe sequence length - https://programming.guide/robin-hood-hashing.html
+//the layout Toy_Table uses: Robin Hood entries (0), or SwissTable-style control bytes beside parallel arrays of keys and values (1)
+#ifndef TOY_TABLE_SWISS
+#define TOY_TABLE_SWISS 0
+#endif
+
+#if TOY_TABLE_SWISS
+
+//control bytes hold the low 7 bits of an occupied slot's hash, or one of these markers, and are matched a group at a time
+#define TOY_TABLE_CTRL_EMPTY 0x80
+#define TOY_TABLE_CTRL_DELETED 0xFE
+#define TOY_TABLE_GROUP_WIDTH 16
+
+//key-value table, where the capacity is a power of two and a multiple of the group width - https://abseil.io/about/design/swisstables
+typedef struct Toy_Table { //32 | 64 BITNESS
+	unsigned int capacity; //4  | 4
+	unsigned int count;    //4  | 4
+	unsigned int deleted;  //4  | 4  tombstones, which count towards the expansion threshold
+	unsigned int mask;     //4  | 4  the number of groups, minus one
+	Toy_Value* keys;       //4  | 8
+	Toy_Value* values;     //4  | 8
+	unsigned char ctrl[];  //-  | -  followed by the keys and values, in the same allocation
+} Toy_Table;               //24 | 32
+
+#define TOY_TABLE_SIZE(capacity) (sizeof(Toy_Table) + (capacity) * (1 + sizeof(Toy_Value) * 2))
+
+//either layout can be walked from 0 to the capacity, where unused slots have null keys
+#define TOY_TABLE_KEY(table, index) ((table)->keys[index])
+#define TOY_TABLE_VALUE(table, index) ((table)->values[index])
+
+#else
+
+//key-value entry, probe sequence length, and the key's hash, so growing never rehashes - https://programming.guide/robin-hood-hashing.html
 typedef struct Toy_TableEntry { //32 | 64 BITNESS
-	Toy_Value key;              //8  | 8
-	Toy_Value value;            //8  | 8
+	Toy_Value key;              //8  | 16
+	Toy_Value value;            //8  | 16
 	unsigned int psl;			//4  | 4
-} Toy_TableEntry;               //20 | 20
+	unsigned int hash;			//4  | 4  - fills what was padding on 64-bit
+} Toy_TableEntry;               //24 | 40
 
-//key-value table (contains = count + tombstones)
+//key-value table, where the capacity is a power of two so the index is a mask (contains = count + tombstones)
 typedef struct Toy_Table { //32 | 64 BITNESS
 	unsigned int capacity; //4  | 4
 	unsigned int count;    //4  | 4
@@ -19,6 +51,14 @@ typedef struct Toy_Table { //32 | 64 BITNESS
 	Toy_TableEntry data[]; //-  | -
 } Toy_Table;               //16 | 16
 
+#define TOY_TABLE_SIZE(capacity) (sizeof(Toy_Table) + (capacity) * sizeof(Toy_TableEntry))
+
+//either layout can be walked from 0 to the capacity, where unused slots have null keys
+#define TOY_TABLE_KEY(table, index) ((table)->data[index].key)
+#define TOY_TABLE_VALUE(table, index) ((table)->data[index].value)
+
+#endif
+
 TOY_API Toy_Table* Toy_allocateTable();
 TOY_API void Toy_freeTable(Toy_Table* table);
 TOY_API void Toy_insertTable(Toy_Table** tableHandle, Toy_Value key, Toy_Value value);
@@ -28,6 +68,9 @@ TOY_API void Toy_removeTable(Toy_Table** tableHandle, Toy_Value key);
 //NOTE: exposed to skip unnecessary allocations within Toy_Scope
 TOY_API Toy_Table* Toy_private_adjustTableCapacity(Toy_Table* oldTable, unsigned int newCapacity);
 
+//NOTE: exposed so Toy_Scope can hash a name once for the whole chain, and assign in place; NULL when missing
+TOY_API Toy_Value* Toy_private_lookupTableValue(Toy_Table* table, Toy_Value key, unsigned int hash);
+
 //some useful sizes, could be swapped out as needed
 #ifndef TOY_TABLE_INITIAL_CAPACITY
 #define TOY_TABLE_INITIAL_CAPACITY 8
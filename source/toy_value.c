@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 bool Toy_private_isTruthy(Toy_Value value) {
 	//null is an error
@@ -22,13 +23,53 @@ bool Toy_private_isTruthy(Toy_Value value) {
 	return true;
 }
 
+//inline strings are compared by their contents, as an identical Toy_String can exist too
+static bool isEqualString(Toy_Value left, Toy_Value right) {
+	if (!TOY_VALUE_IS_SHORT_STRING(left) && !TOY_VALUE_IS_SHORT_STRING(right)) {
+		return Toy_equalStrings(TOY_VALUE_AS_STRING(left), TOY_VALUE_AS_STRING(right));
+	}
+
+	//the padding is always zeroed, so the payloads can be compared whole
+	if (TOY_VALUE_IS_SHORT_STRING(left) && TOY_VALUE_IS_SHORT_STRING(right)) {
+#if TOY_VALUE_PACKED
+		return left.bits == right.bits;
+#else
+		return memcmp(left.as.shortString, right.as.shortString, TOY_VALUE_SHORT_STRING_CAPACITY) == 0;
+#endif
+	}
+
+	//one of each
+	Toy_Value inlined = TOY_VALUE_IS_SHORT_STRING(left) ? left : right;
+	Toy_String* str = TOY_VALUE_AS_STRING(TOY_VALUE_IS_SHORT_STRING(left) ? right : left);
+
+	char buffer[TOY_VALUE_SHORT_STRING_CAPACITY + 1];
+	unsigned int length = TOY_VALUE_AS_SHORT_STRING(inlined, buffer);
+
+	if (str->length != length) {
+		return false;
+	}
+
+	Toy_StringIterator iter;
+	Toy_initStringIterator(&iter, str);
+
+	const char* head = buffer;
+	while (Toy_nextStringChunk(&iter)) {
+		if (memcmp(head, iter.chunk, iter.length) != 0) {
+			return false;
+		}
+		head += iter.length;
+	}
+
+	return true;
+}
+
 bool Toy_private_isEqual(Toy_Value left, Toy_Value right) {
 	//temp check
-	if (right.type > TOY_VALUE_STRING) {
+	if (TOY_VALUE_GET_TYPE(right) > TOY_VALUE_STRING) {
 		Toy_error(TOY_CC_ERROR "ERROR: Unknown types in value equality comparison\n" TOY_CC_RESET);
 	}
 
-	switch(left.type) {
+	switch(TOY_VALUE_GET_TYPE(left)) {
 		case TOY_VALUE_NULL:
 			return TOY_VALUE_IS_NULL(right);
 
@@ -36,26 +77,26 @@ bool Toy_private_isEqual(Toy_Value left, Toy_Value right) {
 			return TOY_VALUE_IS_BOOLEAN(right) && TOY_VALUE_AS_BOOLEAN(left) == TOY_VALUE_AS_BOOLEAN(right);
 
 		case TOY_VALUE_INTEGER:
-			if (TOY_VALUE_AS_INTEGER(right)) {
+			if (TOY_VALUE_IS_INTEGER(right)) {
 				return TOY_VALUE_AS_INTEGER(left) == TOY_VALUE_AS_INTEGER(right);
 			}
-			if (TOY_VALUE_AS_FLOAT(right)) {
+			if (TOY_VALUE_IS_FLOAT(right)) {
 				return TOY_VALUE_AS_INTEGER(left) == TOY_VALUE_AS_FLOAT(right);
 			}
 			return false;
 
 		case TOY_VALUE_FLOAT:
-			if (TOY_VALUE_AS_FLOAT(right)) {
+			if (TOY_VALUE_IS_FLOAT(right)) {
 				return TOY_VALUE_AS_FLOAT(left) == TOY_VALUE_AS_FLOAT(right);
 			}
-			if (TOY_VALUE_AS_INTEGER(right)) {
+			if (TOY_VALUE_IS_INTEGER(right)) {
 				return TOY_VALUE_AS_FLOAT(left) == TOY_VALUE_AS_INTEGER(right);
 			}
 			return false;
 
 		case TOY_VALUE_STRING:
 			if (TOY_VALUE_IS_STRING(right)) {
-				return Toy_compareStrings(TOY_VALUE_AS_STRING(left), TOY_VALUE_AS_STRING(right)) == 0;
+				return isEqualString(left, right);
 			}
 			return false;
 
@@ -79,7 +120,7 @@ static unsigned int hashUInt(unsigned int x) {
 }
 
 unsigned int Toy_hashValue(Toy_Value value) {
-	switch(value.type) {
+	switch(TOY_VALUE_GET_TYPE(value)) {
 		case TOY_VALUE_NULL:
 			return 0;
 
@@ -89,10 +130,18 @@ unsigned int Toy_hashValue(Toy_Value value) {
 		case TOY_VALUE_INTEGER:
 			return hashUInt(TOY_VALUE_AS_INTEGER(value));
 
-		case TOY_VALUE_FLOAT:
-			return hashUInt( *((int*)(&TOY_VALUE_AS_FLOAT(value))) );
+		case TOY_VALUE_FLOAT: {
+			//BUGFIX: casting the pointer breaks strict aliasing when optimised
+			union { float f; unsigned int u; } bits = { .f = TOY_VALUE_AS_FLOAT(value) };
+			return hashUInt(bits.u);
+		}
 
 		case TOY_VALUE_STRING:
+			if (TOY_VALUE_IS_SHORT_STRING(value)) {
+				char buffer[TOY_VALUE_SHORT_STRING_CAPACITY + 1];
+				unsigned int length = TOY_VALUE_AS_SHORT_STRING(value, buffer);
+				return Toy_hashCString(buffer, length);
+			}
 			return Toy_hashString(TOY_VALUE_AS_STRING(value));
 
 		case TOY_VALUE_ARRAY:
@@ -105,3 +154,17 @@ unsigned int Toy_hashValue(Toy_Value value) {
 
 	return 0;
 }
+
+Toy_Value Toy_copyValue(Toy_Value value) {
+	if (TOY_VALUE_IS_STRING(value) && !TOY_VALUE_IS_SHORT_STRING(value)) {
+		Toy_copyString(TOY_VALUE_AS_STRING(value));
+	}
+
+	return value;
+}
+
+void Toy_freeValue(Toy_Value value) {
+	if (TOY_VALUE_IS_STRING(value) && !TOY_VALUE_IS_SHORT_STRING(value)) {
+		Toy_freeString(TOY_VALUE_AS_STRING(value));
+	}
+}
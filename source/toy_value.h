@@ -4,6 +4,7 @@
 
 //forward declarations
 struct Toy_String;
+struct Toy_Dictionary;
 
 typedef enum Toy_ValueType {
 	TOY_VALUE_NULL,
@@ -19,6 +20,103 @@ typedef enum Toy_ValueType {
 	//TODO: type, any, consider 'stack' as a possible addition
 } Toy_ValueType;
 
+//pack each value into a single tagged 64-bit word - can be overridden at build time
+//NOTE: pointers are stored in the low 48 bits, so hosts with 5-level paging, or with tagged pointers such as ARM's TBI and MTE, can't use this layout - debug builds assert on it
+#ifndef TOY_VALUE_PACKED
+#define TOY_VALUE_PACKED 0
+#endif
+
+//store short strings inside the value itself, rather than as a Toy_String - can be overridden at build time
+#ifndef TOY_VALUE_SHORT_STRINGS
+#define TOY_VALUE_SHORT_STRINGS 1
+#endif
+
+//marks a string stored inline, above the type's own bits - TOY_VALUE_GET_TYPE() still reports TOY_VALUE_STRING
+#define TOY_VALUE_SHORT_FLAG					0x100
+
+#if TOY_VALUE_PACKED
+
+#include <assert.h>
+
+//8 bytes in size, the type lives in the top 16 bits, leaving 48 bits for the payload
+//NOTE: floats are only 32 bits, so no double needs the NaN space; the tag is stored as-is, keeping a zeroed value null
+typedef struct Toy_Value {          //32 | 64 BITNESS
+	uint64_t bits;                  //8  | 8
+} Toy_Value;                        //8  | 8
+
+#define TOY_VALUE_PAYLOAD_MASK					((uint64_t)0x0000FFFFFFFFFFFF)
+
+//the most characters an inline string can hold, without a terminator
+#define TOY_VALUE_SHORT_STRING_CAPACITY			6
+
+#define TOY_VALUE_GET_TYPE(value)				((Toy_ValueType)(((value).bits >> 48) & 0xFF))
+
+#define TOY_VALUE_IS_NULL(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_NULL)
+#define TOY_VALUE_IS_BOOLEAN(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_BOOLEAN)
+#define TOY_VALUE_IS_INTEGER(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_INTEGER)
+#define TOY_VALUE_IS_FLOAT(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_FLOAT)
+#define TOY_VALUE_IS_STRING(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_STRING)
+#define TOY_VALUE_IS_ARRAY(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_ARRAY)
+#define TOY_VALUE_IS_DICTIONARY(value)			(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_DICTIONARY)
+#define TOY_VALUE_IS_FUNCTION(value)			(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_FUNCTION)
+#define TOY_VALUE_IS_OPAQUE(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_OPAQUE)
+#define TOY_VALUE_IS_SHORT_STRING(value)		(((value).bits >> 48) == (TOY_VALUE_STRING | TOY_VALUE_SHORT_FLAG))
+
+#define TOY_VALUE_AS_BOOLEAN(value)				((bool)((value).bits & 1))
+#define TOY_VALUE_AS_INTEGER(value)				((int)(uint32_t)(value).bits)
+#define TOY_VALUE_AS_FLOAT(value)				(Toy_private_asFloat(value))
+#define TOY_VALUE_AS_STRING(value)				((struct Toy_String*)(uintptr_t)((value).bits & TOY_VALUE_PAYLOAD_MASK))
+#define TOY_VALUE_AS_DICTIONARY(value)			((struct Toy_Dictionary*)(uintptr_t)((value).bits & TOY_VALUE_PAYLOAD_MASK))
+//TODO: more
+
+#define TOY_VALUE_FROM_TYPE(type, payload)		((Toy_Value){ ((uint64_t)(type) << 48) | ((uint64_t)(payload) & TOY_VALUE_PAYLOAD_MASK) })
+
+#define TOY_VALUE_FROM_NULL()					TOY_VALUE_FROM_TYPE(TOY_VALUE_NULL, 0)
+#define TOY_VALUE_FROM_BOOLEAN(value)			TOY_VALUE_FROM_TYPE(TOY_VALUE_BOOLEAN, (value) ? 1 : 0)
+#define TOY_VALUE_FROM_INTEGER(value)			TOY_VALUE_FROM_TYPE(TOY_VALUE_INTEGER, (uint32_t)(value))
+#define TOY_VALUE_FROM_FLOAT(value)				(Toy_private_fromFloat(value))
+#define TOY_VALUE_FROM_STRING(value)			TOY_VALUE_FROM_TYPE(TOY_VALUE_STRING, Toy_private_fromPointer(value))
+#define TOY_VALUE_FROM_DICTIONARY(value)		TOY_VALUE_FROM_TYPE(TOY_VALUE_DICTIONARY, Toy_private_fromPointer(value))
+//TODO: more
+
+//the top 16 bits hold the tag, so a pointer using them would be silently truncated into a different one
+static inline uint64_t Toy_private_fromPointer(const void* ptr) {
+	assert(((uint64_t)(uintptr_t)ptr & ~TOY_VALUE_PAYLOAD_MASK) == 0 && "pointer doesn't fit in a packed Toy_Value");
+	return (uint64_t)(uintptr_t)ptr;
+}
+
+//floats are reinterpreted through a union, to respect strict aliasing
+static inline float Toy_private_asFloat(Toy_Value value) {
+	union { uint32_t u; float f; } bits = { .u = (uint32_t)value.bits };
+	return bits.f;
+}
+
+static inline Toy_Value Toy_private_fromFloat(float value) {
+	union { float f; uint32_t u; } bits = { .f = value };
+	return TOY_VALUE_FROM_TYPE(TOY_VALUE_FLOAT, bits.u);
+}
+
+//the characters fill the payload from the lowest byte up, with zeroes after them
+static inline Toy_Value Toy_private_fromShortString(const char* cstring, unsigned int length) {
+	uint64_t payload = 0;
+	for (unsigned int i = 0; i < length; i++) {
+		payload |= (uint64_t)(unsigned char)cstring[i] << (i * 8);
+	}
+	return TOY_VALUE_FROM_TYPE(TOY_VALUE_STRING | TOY_VALUE_SHORT_FLAG, payload);
+}
+
+static inline unsigned int Toy_private_asShortString(Toy_Value value, char* buffer) {
+	unsigned int length = 0;
+	while (length < TOY_VALUE_SHORT_STRING_CAPACITY && ((value.bits >> (length * 8)) & 0xFF) != 0) {
+		buffer[length] = (char)(value.bits >> (length * 8));
+		length++;
+	}
+	buffer[length] = '\0';
+	return length;
+}
+
+#else
+
 //8 bytes in size
 typedef struct Toy_Value {          //32 | 64 BITNESS
 	union {
@@ -26,8 +124,9 @@ typedef struct Toy_Value {          //32 | 64 BITNESS
 		int integer;                //4  | 4
 		float number;               //4  | 4
 		struct Toy_String* string;  //4  | 8
+		char shortString[TOY_BITNESS / 8]; //4  | 8  - not null-terminated when full
 		//TODO: arrays
-		//TODO: dictonaries
+		struct Toy_Dictionary* dictionary; //4  | 8
 		//TODO: functions
 		//TODO: opaque
 	} as;                           //4  | 8
@@ -35,20 +134,27 @@ typedef struct Toy_Value {          //32 | 64 BITNESS
 	Toy_ValueType type;             //4  | 4
 } Toy_Value;                        //8  | 16
 
+//the most characters an inline string can hold, without a terminator
+#define TOY_VALUE_SHORT_STRING_CAPACITY			(TOY_BITNESS / 8)
+
+#define TOY_VALUE_GET_TYPE(value)				((Toy_ValueType)((value).type & 0xFF))
+
 #define TOY_VALUE_IS_NULL(value)				((value).type == TOY_VALUE_NULL)
 #define TOY_VALUE_IS_BOOLEAN(value)				((value).type == TOY_VALUE_BOOLEAN)
 #define TOY_VALUE_IS_INTEGER(value)				((value).type == TOY_VALUE_INTEGER)
 #define TOY_VALUE_IS_FLOAT(value)				((value).type == TOY_VALUE_FLOAT)
-#define TOY_VALUE_IS_STRING(value)				((value).type == TOY_VALUE_STRING)
+#define TOY_VALUE_IS_STRING(value)				(TOY_VALUE_GET_TYPE(value) == TOY_VALUE_STRING)
 #define TOY_VALUE_IS_ARRAY(value)				((value).type == TOY_VALUE_ARRAY)
 #define TOY_VALUE_IS_DICTIONARY(value)			((value).type == TOY_VALUE_DICTIONARY)
 #define TOY_VALUE_IS_FUNCTION(value)			((value).type == TOY_VALUE_FUNCTION)
 #define TOY_VALUE_IS_OPAQUE(value)				((value).type == TOY_VALUE_OPAQUE)
+#define TOY_VALUE_IS_SHORT_STRING(value)		((value).type == (TOY_VALUE_STRING | TOY_VALUE_SHORT_FLAG))
 
 #define TOY_VALUE_AS_BOOLEAN(value)				((value).as.boolean)
 #define TOY_VALUE_AS_INTEGER(value)				((value).as.integer)
 #define TOY_VALUE_AS_FLOAT(value)				((value).as.number)
 #define TOY_VALUE_AS_STRING(value)				((value).as.string)
+#define TOY_VALUE_AS_DICTIONARY(value)			((value).as.dictionary)
 //TODO: more
 
 #define TOY_VALUE_FROM_NULL()					((Toy_Value){{ .integer = 0 }, TOY_VALUE_NULL})
@@ -56,8 +162,34 @@ typedef struct Toy_Value {          //32 | 64 BITNESS
 #define TOY_VALUE_FROM_INTEGER(value)			((Toy_Value){{ .integer = value }, TOY_VALUE_INTEGER})
 #define TOY_VALUE_FROM_FLOAT(value)				((Toy_Value){{ .number = value }, TOY_VALUE_FLOAT})
 #define TOY_VALUE_FROM_STRING(value)			((Toy_Value){{ .string = value }, TOY_VALUE_STRING})
+#define TOY_VALUE_FROM_DICTIONARY(value)		((Toy_Value){{ .dictionary = value }, TOY_VALUE_DICTIONARY})
 //TODO: more
 
+static inline Toy_Value Toy_private_fromShortString(const char* cstring, unsigned int length) {
+	Toy_Value value;
+	value.type = TOY_VALUE_STRING | TOY_VALUE_SHORT_FLAG;
+	for (unsigned int i = 0; i < TOY_VALUE_SHORT_STRING_CAPACITY; i++) {
+		value.as.shortString[i] = i < length ? cstring[i] : '\0';
+	}
+	return value;
+}
+
+static inline unsigned int Toy_private_asShortString(Toy_Value value, char* buffer) {
+	unsigned int length = 0;
+	while (length < TOY_VALUE_SHORT_STRING_CAPACITY && value.as.shortString[length] != '\0') {
+		buffer[length] = value.as.shortString[length];
+		length++;
+	}
+	buffer[length] = '\0';
+	return length;
+}
+
+#endif
+
+//inline strings can't be used as a Toy_String, so they're copied out - the buffer needs TOY_VALUE_SHORT_STRING_CAPACITY + 1 bytes
+#define TOY_VALUE_FROM_SHORT_STRING(cstring, length)	Toy_private_fromShortString(cstring, length)
+#define TOY_VALUE_AS_SHORT_STRING(value, buffer)		Toy_private_asShortString(value, buffer)
+
 #define TOY_VALUE_IS_TRUTHY(value) Toy_private_isTruthy(value)
 TOY_API bool Toy_private_isTruthy(Toy_Value value);
 
@@ -66,3 +198,7 @@ TOY_API bool Toy_private_isEqual(Toy_Value left, Toy_Value right);
 
 unsigned int Toy_hashValue(Toy_Value value);
 
+//strings are reference counted, so a copy shares the same one, while everything else is copied as-is
+TOY_API Toy_Value Toy_copyValue(Toy_Value value);
+TOY_API void Toy_freeValue(Toy_Value value);
+
@@ -3,13 +3,24 @@
 
 #include "toy_print.h"
 #include "toy_opcodes.h"
+#include "toy_routine.h"
 #include "toy_value.h"
 #include "toy_string.h"
+#include "toy_table.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if TOY_VM_PROFILE
+	#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		#include <x86intrin.h>
+		#define TOY_VM_PROFILE_RDTSC 1
+	#else
+		#include <time.h>
+	#endif
+#endif
+
 //utilities
 #define READ_BYTE(vm) \
 	vm->routine[vm->routineCounter++]
@@ -17,6 +28,9 @@
 #define READ_UNSIGNED_INT(vm) \
 	*((unsigned int*)(vm->routine + readPostfixUtil(&(vm->routineCounter), 4)))
 
+#define READ_UNSIGNED_SHORT(vm) \
+	*((unsigned short*)(vm->routine + readPostfixUtil(&(vm->routineCounter), 2)))
+
 #define READ_INT(vm) \
 	*((int*)(vm->routine + readPostfixUtil(&(vm->routineCounter), 4)))
 
@@ -34,10 +48,24 @@ static inline void fixAlignment(Toy_VM* vm) {
 	vm->routineCounter = (vm->routineCounter + 3) & ~0b11;
 }
 
-//instruction handlers
-static void processRead(Toy_VM* vm) {
-	Toy_ValueType type = READ_BYTE(vm);
+//the stack, slots and registers each own a reference to any string that isn't stored inline
+static inline Toy_Value retainValue(Toy_Value value) {
+	if (TOY_VALUE_IS_STRING(value) && !TOY_VALUE_IS_SHORT_STRING(value)) {
+		Toy_copyString(TOY_VALUE_AS_STRING(value));
+	}
+
+	return value;
+}
 
+static inline void releaseValue(Toy_Value value) {
+	if (TOY_VALUE_IS_STRING(value) && !TOY_VALUE_IS_SHORT_STRING(value)) {
+		Toy_freeString(TOY_VALUE_AS_STRING(value));
+	}
+}
+
+//instruction handlers
+static inline Toy_Value readValue(Toy_VM* vm, Toy_ValueType type) {
+	//booleans are stored in the next byte, larger values in the next word
 	Toy_Value value = TOY_VALUE_FROM_NULL();
 
 	switch(type) {
@@ -65,14 +93,10 @@ static void processRead(Toy_VM* vm) {
 
 		case TOY_VALUE_STRING: {
 			fixAlignment(vm);
-			//grab the jump as an integer
-			unsigned int jump = *(unsigned int*)(vm->routine + vm->jumpsAddr + READ_INT(vm));
-
-			//jumps are relative to the data address
-			char* cstring = (char*)(vm->routine + vm->dataAddr + jump);
+			unsigned int index = READ_UNSIGNED_INT(vm);
 
-			//build a string from the data section
-			value = TOY_VALUE_FROM_STRING(Toy_createString(&vm->stringBucket, cstring));
+			//share the string already built from the data section, unless it's stored inline
+			value = retainValue(vm->constants->data[index]);
 
 			break;
 		}
@@ -102,44 +126,148 @@ static void processRead(Toy_VM* vm) {
 			exit(-1);
 	}
 
+	return value;
+}
+
+static inline void processRead(Toy_VM* vm) {
+	Toy_ValueType type = READ_BYTE(vm);
+
 	//push onto the stack
-	Toy_pushStack(&vm->stack, value);
+	TOY_STACK_PUSH_UNCHECKED(vm->stack, readValue(vm, type));
 
 	//leave the counter in a good spot
 	fixAlignment(vm);
 }
 
-static void processDeclare(Toy_VM* vm) {
-	Toy_ValueType type = READ_BYTE(vm); //variable type
-	unsigned int len = READ_BYTE(vm); //name length
-	fixAlignment(vm); //one spare byte
+static inline const char* readData(Toy_VM* vm, unsigned int index) {
+	unsigned int jump = ((unsigned int*)(vm->routine + vm->jumpsAddr))[index];
+
+	//jumps are relative to the data address
+	return (const char*)(vm->routine + vm->dataAddr + jump);
+}
 
-	//grab the jump
-	unsigned int jump = *(unsigned int*)(vm->routine + vm->jumpsAddr + READ_INT(vm));
+#if TOY_ROUTINE_DATA_HASHES
+//written by the compiler just before each entry's characters
+#define DATA_LENGTH(cstring)	(((const unsigned int*)(cstring))[-2])
+#define DATA_HASH(cstring)		(((const unsigned int*)(cstring))[-1])
+#else
+#define DATA_LENGTH(cstring)	((unsigned int)strlen(cstring))
+#define DATA_HASH(cstring)		0 //calculated when needed
+#endif
 
+static Toy_String* internName(Toy_VM* vm, unsigned int index, unsigned int len) {
 	//grab the data
-	char* cstring = (char*)(vm->routine + vm->dataAddr + jump);
+	const char* cstring = readData(vm, index);
 
-	//build the name string
-	Toy_String* name = Toy_createNameStringLength(&vm->stringBucket, cstring, len, type);
+	//the type belongs to the declaration, not the name, so canonical names don't carry one
+	Toy_String* name = Toy_createNameStringLength(&vm->stringBucket, cstring, len, TOY_VALUE_NULL);
+	name->cachedHash = DATA_HASH(cstring); //so neither the intern table nor the scopes hash it again
+	Toy_Value existing = Toy_lookupTable(&vm->interned, TOY_VALUE_FROM_STRING(name));
+
+	if (TOY_VALUE_IS_NULL(existing)) {
+		Toy_insertTable(&vm->interned, TOY_VALUE_FROM_STRING(name), TOY_VALUE_FROM_STRING(name));
+		existing = TOY_VALUE_FROM_STRING(name);
+	}
+	else {
+		Toy_freeString(name);
+	}
+
+	//the pool holds its own reference
+	return Toy_copyString(TOY_VALUE_AS_STRING(existing));
+}
+
+static inline Toy_String* readName(Toy_VM* vm, unsigned int len) {
+	fixAlignment(vm); //skip to the index
+
+	unsigned int index = READ_UNSIGNED_INT(vm);
+
+	//only the first use of each name in a routine touches the intern table
+	if (TOY_VALUE_IS_NULL(vm->names->data[index])) {
+		vm->names->data[index] = TOY_VALUE_FROM_STRING(internName(vm, index, len));
+	}
+
+	return TOY_VALUE_AS_STRING(vm->names->data[index]);
+}
+
+static inline Toy_String* readNameString(Toy_VM* vm) {
+	vm->routineCounter++; //variable type, unused for now
+	unsigned int len = READ_BYTE(vm); //name length
+
+	return readName(vm, len);
+}
+
+static inline void processDeclare(Toy_VM* vm) {
+	Toy_String* name = readNameString(vm);
 
 	//get the value
-	Toy_Value value = Toy_popStack(&vm->stack);
+	Toy_Value value = TOY_STACK_POP_UNCHECKED(vm->stack);
 
 	//declare it
 	Toy_declareScope(vm->scope, name, value);
 
-	//cleanup
-	Toy_freeString(name);
+	//shared scopes keep their own copy
+	if (vm->scope->shared != NULL) {
+		releaseValue(value);
+	}
+}
+
+static inline void processAssign(Toy_VM* vm) {
+	Toy_String* name = readNameString(vm);
+
+	//get the value
+	Toy_Value value = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+	//assign it, releasing whatever it replaced
+	releaseValue(Toy_assignScope(vm->scope, name, value));
+}
+
+static inline void processAccess(Toy_VM* vm) {
+	Toy_String* name = readNameString(vm);
+
+	//find and push the value, which the stack holds its own reference to
+	TOY_STACK_PUSH_UNCHECKED(vm->stack, retainValue(Toy_accessScope(vm->scope, name)));
 }
 
-static void processArithmetic(Toy_VM* vm, Toy_OpcodeType opcode) {
-	Toy_Value right = Toy_popStack(&vm->stack);
-	Toy_Value left = Toy_popStack(&vm->stack);
+static inline void processDeclareSlot(Toy_VM* vm) {
+	Toy_ValueType type = READ_BYTE(vm); //variable type, unused for now
+	unsigned int slot = READ_UNSIGNED_SHORT(vm);
+
+	//sibling scopes reuse slots, so only grow when needed
+	while (slot >= vm->slots->capacity) {
+		vm->slots = Toy_resizeArray(vm->slots, vm->slots->capacity * TOY_ARRAY_EXPANSION_RATE);
+	}
+
+	//a slot reused by a sibling scope still holds that scope's value
+	if (slot < vm->slots->count) {
+		releaseValue(vm->slots->data[slot]);
+	}
 
+	while (slot >= vm->slots->count) {
+		vm->slots->data[vm->slots->count++] = TOY_VALUE_FROM_NULL();
+	}
+
+	vm->slots->data[slot] = TOY_STACK_POP_UNCHECKED(vm->stack);
+}
+
+static inline void processAssignSlot(Toy_VM* vm) {
+	vm->routineCounter++; //one spare byte
+	unsigned int slot = READ_UNSIGNED_SHORT(vm);
+
+	releaseValue(vm->slots->data[slot]);
+	vm->slots->data[slot] = TOY_STACK_POP_UNCHECKED(vm->stack);
+}
+
+static inline void processAccessSlot(Toy_VM* vm) {
+	vm->routineCounter++; //one spare byte
+	unsigned int slot = READ_UNSIGNED_SHORT(vm);
+
+	TOY_STACK_PUSH_UNCHECKED(vm->stack, retainValue(vm->slots->data[slot]));
+}
+
+static inline Toy_Value applyArithmetic(Toy_OpcodeType opcode, Toy_Value left, Toy_Value right) {
 	//check types
 	if ((!TOY_VALUE_IS_INTEGER(left) && !TOY_VALUE_IS_FLOAT(left)) || (!TOY_VALUE_IS_INTEGER(right) && !TOY_VALUE_IS_FLOAT(right))) {
-		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid types %d and %d passed to processArithmetic, exiting\n" TOY_CC_RESET, left.type, right.type);
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid types %d and %d passed to applyArithmetic, exiting\n" TOY_CC_RESET, TOY_VALUE_GET_TYPE(left), TOY_VALUE_GET_TYPE(right));
 		exit(-1);
 	}
 
@@ -185,31 +313,24 @@ static void processArithmetic(Toy_VM* vm, Toy_OpcodeType opcode) {
 		result = TOY_VALUE_FROM_INTEGER( TOY_VALUE_AS_INTEGER(left) % TOY_VALUE_AS_INTEGER(right) );
 	}
 	else {
-		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid opcode %d passed to processArithmetic, exiting\n" TOY_CC_RESET, opcode);
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid opcode %d passed to applyArithmetic, exiting\n" TOY_CC_RESET, opcode);
 		exit(-1);
 	}
 
-	//finally
-	Toy_pushStack(&vm->stack, result);
+	return result;
 }
 
-static void processComparison(Toy_VM* vm, Toy_OpcodeType opcode) {
-	Toy_Value right = Toy_popStack(&vm->stack);
-	Toy_Value left = Toy_popStack(&vm->stack);
+static inline void processArithmetic(Toy_VM* vm, Toy_OpcodeType opcode) {
+	Toy_Value right = TOY_STACK_POP_UNCHECKED(vm->stack);
+	Toy_Value left = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+	TOY_STACK_PUSH_UNCHECKED(vm->stack, applyArithmetic(opcode, left, right));
+}
 
+static inline Toy_Value applyComparison(Toy_OpcodeType opcode, Toy_Value left, Toy_Value right) {
 	//most things can be equal, so handle it separately
 	if (opcode == TOY_OPCODE_COMPARE_EQUAL) {
-		bool equal = TOY_VALUES_ARE_EQUAL(left, right);
-
-		//equality has an optional "negate" opcode within it's word
-		if (READ_BYTE(vm) != TOY_OPCODE_NEGATE) {
-			Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN(equal) );
-		}
-		else {
-			Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN(!equal) );
-		}
-
-		return;
+		return TOY_VALUE_FROM_BOOLEAN( TOY_VALUES_ARE_EQUAL(left, right) );
 	}
 
 	//coerce ints into floats if needed
@@ -223,58 +344,137 @@ static void processComparison(Toy_VM* vm, Toy_OpcodeType opcode) {
 
 	//other opcodes
 	if (opcode == TOY_OPCODE_COMPARE_LESS) {
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) < TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) < TOY_VALUE_AS_INTEGER(right)) );
+		return TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) < TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) < TOY_VALUE_AS_INTEGER(right));
 	}
 	else if (opcode == TOY_OPCODE_COMPARE_LESS_EQUAL) {
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) <= TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) <= TOY_VALUE_AS_INTEGER(right)) );
+		return TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) <= TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) <= TOY_VALUE_AS_INTEGER(right));
 	}
 	else if (opcode == TOY_OPCODE_COMPARE_GREATER) {
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) > TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) > TOY_VALUE_AS_INTEGER(right)) );
+		return TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) > TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) > TOY_VALUE_AS_INTEGER(right));
 	}
 	else if (opcode == TOY_OPCODE_COMPARE_GREATER_EQUAL) {
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) >= TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) >= TOY_VALUE_AS_INTEGER(right)) );
+		return TOY_VALUE_FROM_BOOLEAN(TOY_VALUE_IS_FLOAT(left) ? TOY_VALUE_AS_FLOAT(left) >= TOY_VALUE_AS_FLOAT(right) : TOY_VALUE_AS_INTEGER(left) >= TOY_VALUE_AS_INTEGER(right));
 	}
 	else {
-		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid opcode %d passed to processComparison, exiting\n" TOY_CC_RESET, opcode);
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid opcode %d passed to applyComparison, exiting\n" TOY_CC_RESET, opcode);
 		exit(-1);
 	}
 }
 
-static void processLogical(Toy_VM* vm, Toy_OpcodeType opcode) {
-	if (opcode == TOY_OPCODE_AND) {
-		Toy_Value right = Toy_popStack(&vm->stack);
-		Toy_Value left = Toy_popStack(&vm->stack);
+static inline void processComparison(Toy_VM* vm, Toy_OpcodeType opcode) {
+	Toy_Value right = TOY_STACK_POP_UNCHECKED(vm->stack);
+	Toy_Value left = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+	Toy_Value result = applyComparison(opcode, left, right);
+
+	releaseValue(left);
+	releaseValue(right);
 
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(left) && TOY_VALUE_IS_TRUTHY(right) ));
+	//equality has an optional "negate" opcode within it's word
+	if (opcode == TOY_OPCODE_COMPARE_EQUAL && READ_BYTE(vm) == TOY_OPCODE_NEGATE) {
+		result = TOY_VALUE_FROM_BOOLEAN( !TOY_VALUE_AS_BOOLEAN(result) );
 	}
-	else if (opcode == TOY_OPCODE_OR) {
-		Toy_Value right = Toy_popStack(&vm->stack);
-		Toy_Value left = Toy_popStack(&vm->stack);
 
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(left) || TOY_VALUE_IS_TRUTHY(right) ));
+	TOY_STACK_PUSH_UNCHECKED(vm->stack, result);
+}
+
+static inline Toy_Value applyLogical(Toy_OpcodeType opcode, Toy_Value left, Toy_Value right) {
+	//unary opcodes only use the left
+	if (opcode == TOY_OPCODE_AND) {
+		return TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(left) && TOY_VALUE_IS_TRUTHY(right) );
+	}
+	else if (opcode == TOY_OPCODE_OR) {
+		return TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(left) || TOY_VALUE_IS_TRUTHY(right) );
 	}
 	else if (opcode == TOY_OPCODE_TRUTHY) {
-		Toy_Value top = Toy_popStack(&vm->stack);
-
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(top) ));
+		return TOY_VALUE_FROM_BOOLEAN( TOY_VALUE_IS_TRUTHY(left) );
 	}
 	else if (opcode == TOY_OPCODE_NEGATE) {
-		Toy_Value top = Toy_popStack(&vm->stack);
-
-		Toy_pushStack(&vm->stack, TOY_VALUE_FROM_BOOLEAN( !TOY_VALUE_IS_TRUTHY(top) ));
+		return TOY_VALUE_FROM_BOOLEAN( !TOY_VALUE_IS_TRUTHY(left) );
 	}
 	else {
-		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid opcode %d passed to processLogical, exiting\n" TOY_CC_RESET, opcode);
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid opcode %d passed to applyLogical, exiting\n" TOY_CC_RESET, opcode);
 		exit(-1);
 	}
 }
 
-static void processPrint(Toy_VM* vm) {
-	//print the value on top of the stack, popping it
-	Toy_Value value = Toy_popStack(&vm->stack);
+static inline void processLogical(Toy_VM* vm, Toy_OpcodeType opcode) {
+	if (opcode == TOY_OPCODE_AND || opcode == TOY_OPCODE_OR) {
+		Toy_Value right = TOY_STACK_POP_UNCHECKED(vm->stack);
+		Toy_Value left = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+		Toy_Value result = applyLogical(opcode, left, right);
+		releaseValue(left);
+		releaseValue(right);
+
+		TOY_STACK_PUSH_UNCHECKED(vm->stack, result);
+	}
+	else {
+		Toy_Value top = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+		Toy_Value result = applyLogical(opcode, top, TOY_VALUE_FROM_NULL());
+		releaseValue(top);
+
+		TOY_STACK_PUSH_UNCHECKED(vm->stack, result);
+	}
+}
+
+//scalars are formatted the way print shows them, with integers written directly rather than through printf
+#define FORMAT_BUFFER_SIZE 64
+
+static unsigned int formatScalar(Toy_Value value, char* buffer) {
+	switch(TOY_VALUE_GET_TYPE(value)) {
+		case TOY_VALUE_NULL:
+			memcpy(buffer, "null", 5);
+			return 4;
+
+		case TOY_VALUE_BOOLEAN:
+			if (TOY_VALUE_AS_BOOLEAN(value)) {
+				memcpy(buffer, "true", 5);
+				return 4;
+			}
+			memcpy(buffer, "false", 6);
+			return 5;
+
+		case TOY_VALUE_INTEGER: {
+			int integer = TOY_VALUE_AS_INTEGER(value);
+			unsigned int magnitude = integer < 0 ? 0u - (unsigned int)integer : (unsigned int)integer;
+
+			//digits come out backwards
+			char digits[16];
+			unsigned int count = 0;
+
+			do {
+				digits[count++] = '0' + magnitude % 10;
+				magnitude /= 10;
+			} while (magnitude > 0);
 
+			unsigned int length = 0;
+
+			if (integer < 0) {
+				buffer[length++] = '-';
+			}
+
+			while (count > 0) {
+				buffer[length++] = digits[--count];
+			}
+
+			buffer[length] = '\0';
+			return length;
+		}
+
+		case TOY_VALUE_FLOAT:
+			return snprintf(buffer, FORMAT_BUFFER_SIZE, "%f", TOY_VALUE_AS_FLOAT(value));
+
+		default:
+			buffer[0] = '\0';
+			return 0;
+	}
+}
+
+static inline void printValue(Toy_Value value) {
 	//NOTE: don't append a newline - leave that choice to the host
-	switch(value.type) {
+	switch(TOY_VALUE_GET_TYPE(value)) {
 		case TOY_VALUE_NULL:
 			Toy_print("null");
 			break;
@@ -283,25 +483,42 @@ static void processPrint(Toy_VM* vm) {
 			Toy_print(TOY_VALUE_AS_BOOLEAN(value) ? "true" : "false");
 			break;
 
-		case TOY_VALUE_INTEGER: {
-			char buffer[16];
-			sprintf(buffer, "%d", TOY_VALUE_AS_INTEGER(value));
-			Toy_print(buffer);
-			break;
-		}
-
+		case TOY_VALUE_INTEGER:
 		case TOY_VALUE_FLOAT: {
-			char buffer[16];
-			sprintf(buffer, "%f", TOY_VALUE_AS_FLOAT(value));
+			char buffer[FORMAT_BUFFER_SIZE];
+			formatScalar(value, buffer);
 			Toy_print(buffer);
 			break;
 		}
 
 		case TOY_VALUE_STRING: {
+			if (TOY_VALUE_IS_SHORT_STRING(value)) {
+				char buffer[TOY_VALUE_SHORT_STRING_CAPACITY + 1];
+				TOY_VALUE_AS_SHORT_STRING(value, buffer);
+				Toy_print(buffer);
+				break;
+			}
+
 			Toy_String* str = TOY_VALUE_AS_STRING(value);
 
 			//TODO: decide on how long strings, etc. live for in memory
-			if (str->type == TOY_STRING_NODE) {
+			if ((str->type == TOY_STRING_NODE || str->type == TOY_STRING_VIEW) && str->length < TOY_VM_PRINT_BUFFER_SIZE) {
+				//short ropes and views are gathered on the stack, as the callback needs a single null-terminated buffer
+				char buffer[TOY_VM_PRINT_BUFFER_SIZE];
+				unsigned int length = 0;
+
+				Toy_StringIterator iter;
+				Toy_initStringIterator(&iter, str);
+
+				while (Toy_nextStringChunk(&iter)) {
+					memcpy(buffer + length, iter.chunk, iter.length);
+					length += iter.length;
+				}
+
+				buffer[length] = '\0';
+				Toy_print(buffer);
+			}
+			else if (str->type == TOY_STRING_NODE || str->type == TOY_STRING_VIEW) {
 				char* buffer = Toy_getStringRawBuffer(str);
 				Toy_print(buffer);
 				free(buffer);
@@ -319,100 +536,760 @@ static void processPrint(Toy_VM* vm) {
 		case TOY_VALUE_DICTIONARY:
 		case TOY_VALUE_FUNCTION:
 		case TOY_VALUE_OPAQUE:
-			fprintf(stderr, TOY_CC_ERROR "ERROR: Unknown value type %d passed to processPrint, exiting\n" TOY_CC_RESET, value.type);
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unknown value type %d passed to printValue, exiting\n" TOY_CC_RESET, TOY_VALUE_GET_TYPE(value));
 			exit(-1);
 	}
 }
 
-static void processConcat(Toy_VM* vm) {
-	Toy_Value right = Toy_popStack(&vm->stack);
-	Toy_Value left = Toy_popStack(&vm->stack);
+static inline void processPrint(Toy_VM* vm) {
+	//print the value on top of the stack, popping it
+	Toy_Value value = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+	printValue(value);
+	releaseValue(value);
+}
 
-	if (!TOY_VALUE_IS_STRING(left)) {
-		Toy_error("Failed to concatenate a value that is not a string");
-		return;
+//the characters a value contributes to a concatenation, writing them if 'dest' isn't NULL
+static unsigned int writeConcatOperand(Toy_Value value, char* dest) {
+	char buffer[FORMAT_BUFFER_SIZE];
+
+	if (TOY_VALUE_IS_SHORT_STRING(value)) {
+		unsigned int length = TOY_VALUE_AS_SHORT_STRING(value, buffer);
+		if (dest != NULL) {
+			memcpy(dest, buffer, length);
+		}
+		return length;
 	}
 
-	if (!TOY_VALUE_IS_STRING(left)) {
-		Toy_error("Failed to concatenate a value that is not a string");
-		return;
+	if (TOY_VALUE_IS_STRING(value)) {
+		Toy_String* str = TOY_VALUE_AS_STRING(value);
+
+		if (dest != NULL) {
+			Toy_StringIterator iter;
+			Toy_initStringIterator(&iter, str);
+
+			while (Toy_nextStringChunk(&iter)) {
+				memcpy(dest, iter.chunk, iter.length);
+				dest += iter.length;
+			}
+		}
+
+		return str->length;
+	}
+
+	unsigned int length = formatScalar(value, buffer);
+	if (dest != NULL) {
+		memcpy(dest, buffer, length);
+	}
+	return length;
+}
+
+//anything else is moved into the bucket when it joins a rope, returning a new reference either way
+static Toy_String* toRopeString(Toy_VM* vm, Toy_Value value) {
+	if (TOY_VALUE_IS_STRING(value) && !TOY_VALUE_IS_SHORT_STRING(value)) {
+		return Toy_copyString(TOY_VALUE_AS_STRING(value));
+	}
+
+	char buffer[FORMAT_BUFFER_SIZE];
+	unsigned int length = writeConcatOperand(value, buffer);
+	return Toy_createStringLength(&vm->stringBucket, buffer, length);
+}
+
+static bool concatValues(Toy_VM* vm, Toy_Value* operands, unsigned int count, Toy_Value* result) {
+	//measure, so the result can be allocated once
+	unsigned int total = 0;
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (TOY_VALUE_GET_TYPE(operands[i]) > TOY_VALUE_STRING) {
+			Toy_error("Failed to concatenate a value that can't be converted to a string");
+			return false;
+		}
+
+		total += writeConcatOperand(operands[i], NULL);
+	}
+
+	//long results share their pieces, rather than copying them
+	if (total > TOY_VM_CONCAT_FLATTEN_LENGTH) {
+		Toy_String* joined = toRopeString(vm, operands[0]);
+
+		for (unsigned int i = 1; i < count; i++) {
+			Toy_String* next = toRopeString(vm, operands[i]);
+			Toy_String* tmp = Toy_concatStrings(&vm->stringBucket, joined, next);
+
+			Toy_freeString(joined);
+			Toy_freeString(next);
+			joined = tmp;
+		}
+
+		(*result) = TOY_VALUE_FROM_STRING(joined);
+		return true;
+	}
+
+	//short results are copied into one place, inline if they fit
+	char buffer[TOY_VALUE_SHORT_STRING_CAPACITY + 1];
+	Toy_String* leaf = NULL;
+	char* dest = buffer;
+
+	if (!TOY_VALUE_SHORT_STRINGS || total > TOY_VALUE_SHORT_STRING_CAPACITY) {
+		leaf = Toy_reserveStringLength(&vm->stringBucket, total);
+		dest = leaf->as.leaf.data;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		dest += writeConcatOperand(operands[i], dest);
+	}
+
+	(*result) = leaf != NULL ? TOY_VALUE_FROM_STRING(leaf) : TOY_VALUE_FROM_SHORT_STRING(buffer, total);
+	return true;
+}
+
+static inline void concatStack(Toy_VM* vm, unsigned int count) {
+	//the operands are read in place, then replaced by the result
+	vm->stack->count -= count;
+
+	Toy_Value* operands = (Toy_Value*)(vm->stack + 1) + vm->stack->count;
+	Toy_Value result;
+	bool joined = concatValues(vm, operands, count, &result);
+
+	//the result holds its own references to any pieces it shares
+	for (unsigned int i = 0; i < count; i++) {
+		releaseValue(operands[i]);
+	}
+
+	if (joined) {
+		TOY_STACK_PUSH_UNCHECKED(vm->stack, result);
+	}
+}
+
+static inline void processConcat(Toy_VM* vm) {
+	concatStack(vm, 2);
+}
+
+static inline void processConcatN(Toy_VM* vm) {
+	unsigned int count = READ_BYTE(vm);
+	fixAlignment(vm);
+
+	concatStack(vm, count);
+}
+
+static inline void processArithmeticImmediate(Toy_VM* vm) {
+	Toy_ValueType type = READ_BYTE(vm);
+	Toy_OpcodeType opcode = READ_BYTE(vm);
+
+	Toy_Value right = readValue(vm, type);
+	Toy_Value left = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+	TOY_STACK_PUSH_UNCHECKED(vm->stack, applyArithmetic(opcode, left, right));
+}
+
+static inline void processComparisonImmediate(Toy_VM* vm) {
+	Toy_ValueType type = READ_BYTE(vm);
+	Toy_OpcodeType opcode = READ_BYTE(vm);
+	bool negate = READ_BYTE(vm) == TOY_OPCODE_NEGATE;
+
+	Toy_Value right = readValue(vm, type);
+	Toy_Value left = TOY_STACK_POP_UNCHECKED(vm->stack);
+
+	Toy_Value result = applyComparison(opcode, left, right);
+	releaseValue(left);
+
+	if (negate) {
+		result = TOY_VALUE_FROM_BOOLEAN( !TOY_VALUE_AS_BOOLEAN(result) );
 	}
 
-	//all good
-	Toy_String* result = Toy_concatStrings(&vm->stringBucket, TOY_VALUE_AS_STRING(left), TOY_VALUE_AS_STRING(right));
-	Toy_pushStack(&vm->stack, TOY_VALUE_FROM_STRING(result));
+	TOY_STACK_PUSH_UNCHECKED(vm->stack, result);
+}
+
+static inline void processPrintImmediate(Toy_VM* vm) {
+	Toy_ValueType type = READ_BYTE(vm);
+
+	//never touches the stack
+	Toy_Value value = readValue(vm, type);
+
+	printValue(value);
+	releaseValue(value);
+}
+
+#if TOY_VM_PROFILE
+static inline unsigned long long readTicks() {
+#ifdef TOY_VM_PROFILE_RDTSC
+	return __rdtsc();
+#else
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
 }
 
+static void profileOpcode(Toy_VM* vm, Toy_OpcodeType opcode) {
+	Toy_VMProfile* profile = vm->profile;
+	unsigned long long now = readTicks();
+
+	//the previous instruction ends where this one begins
+	if (profile->lastOpcode >= 0) {
+		profile->opcodeTicks[profile->lastOpcode] += now - profile->lastTicks;
+		profile->opcodePairs[profile->lastOpcode][opcode]++;
+	}
+
+	profile->opcodeCounts[opcode]++;
+	profile->lastOpcode = opcode;
+
+	if (vm->stack->count > profile->stackPeak) {
+		profile->stackPeak = vm->stack->count;
+	}
+
+	//only walk the scope chain when it changes
+	if (vm->scope != profile->lastScope) {
+		unsigned int depth = 0;
+		for (Toy_Scope* iter = vm->scope; iter != NULL; iter = iter->next) {
+			depth++;
+		}
+
+		if (depth > profile->scopePeak) {
+			profile->scopePeak = depth;
+		}
+
+		profile->lastScope = vm->scope;
+	}
+
+	//don't charge the bookkeeping to the instruction
+	profile->lastTicks = readTicks();
+}
+
+	#define VM_PROFILE(vm, opcode) profileOpcode(vm, opcode)
+#else
+	#define VM_PROFILE(vm, opcode)
+#endif
+
 static void process(Toy_VM* vm) {
+#if TOY_VM_COMPUTED_GOTO
+	//direct-threaded dispatch, each handler jumps straight to the next one
+	static const void* const dispatchTable[256] = {
+		[TOY_OPCODE_READ] = &&label_TOY_OPCODE_READ,
+		[TOY_OPCODE_DECLARE] = &&label_TOY_OPCODE_DECLARE,
+		[TOY_OPCODE_ASSIGN] = &&label_TOY_OPCODE_ASSIGN,
+		[TOY_OPCODE_ACCESS] = &&label_TOY_OPCODE_ACCESS,
+
+		[TOY_OPCODE_DECLARE_SLOT] = &&label_TOY_OPCODE_DECLARE_SLOT,
+		[TOY_OPCODE_ASSIGN_SLOT] = &&label_TOY_OPCODE_ASSIGN_SLOT,
+		[TOY_OPCODE_ACCESS_SLOT] = &&label_TOY_OPCODE_ACCESS_SLOT,
+
+		[TOY_OPCODE_ADD] = &&label_TOY_OPCODE_ADD,
+		[TOY_OPCODE_SUBTRACT] = &&label_TOY_OPCODE_SUBTRACT,
+		[TOY_OPCODE_MULTIPLY] = &&label_TOY_OPCODE_MULTIPLY,
+		[TOY_OPCODE_DIVIDE] = &&label_TOY_OPCODE_DIVIDE,
+		[TOY_OPCODE_MODULO] = &&label_TOY_OPCODE_MODULO,
+
+		[TOY_OPCODE_COMPARE_EQUAL] = &&label_TOY_OPCODE_COMPARE_EQUAL,
+		[TOY_OPCODE_COMPARE_LESS] = &&label_TOY_OPCODE_COMPARE_LESS,
+		[TOY_OPCODE_COMPARE_LESS_EQUAL] = &&label_TOY_OPCODE_COMPARE_LESS_EQUAL,
+		[TOY_OPCODE_COMPARE_GREATER] = &&label_TOY_OPCODE_COMPARE_GREATER,
+		[TOY_OPCODE_COMPARE_GREATER_EQUAL] = &&label_TOY_OPCODE_COMPARE_GREATER_EQUAL,
+
+		[TOY_OPCODE_AND] = &&label_TOY_OPCODE_AND,
+		[TOY_OPCODE_OR] = &&label_TOY_OPCODE_OR,
+		[TOY_OPCODE_TRUTHY] = &&label_TOY_OPCODE_TRUTHY,
+		[TOY_OPCODE_NEGATE] = &&label_TOY_OPCODE_NEGATE,
+
+		[TOY_OPCODE_RETURN] = &&label_TOY_OPCODE_RETURN,
+
+		[TOY_OPCODE_PRINT] = &&label_TOY_OPCODE_PRINT,
+		[TOY_OPCODE_CONCAT] = &&label_TOY_OPCODE_CONCAT,
+		[TOY_OPCODE_CONCAT_N] = &&label_TOY_OPCODE_CONCAT_N,
+
+		[TOY_OPCODE_ARITHMETIC_IMM] = &&label_TOY_OPCODE_ARITHMETIC_IMM,
+		[TOY_OPCODE_COMPARE_IMM] = &&label_TOY_OPCODE_COMPARE_IMM,
+		[TOY_OPCODE_PRINT_IMM] = &&label_TOY_OPCODE_PRINT_IMM,
+
+		[TOY_OPCODE_PASS] = &&label_TOY_OPCODE_PASS,
+		[TOY_OPCODE_ERROR] = &&label_TOY_OPCODE_ERROR,
+		[TOY_OPCODE_ERROR + 1 ... TOY_OPCODE_EOF] = &&label_TOY_OPCODE_EOF, //NOTE: no overlaps, clang warns about overridden initializers
+	};
+
+	//the switch below is only used for the first instruction
+	#define VM_CASE(opcode) case opcode: label_##opcode
+	#define VM_NEXT() fixAlignment(vm); opcode = READ_BYTE(vm); VM_PROFILE(vm, opcode); goto *dispatchTable[opcode]
+#else
+	#define VM_CASE(opcode) case opcode
+	#define VM_NEXT() fixAlignment(vm); continue
+#endif
+
 	while(true) {
 		Toy_OpcodeType opcode = READ_BYTE(vm);
+		VM_PROFILE(vm, opcode);
 
+		//each opcode has its own handler, so the helpers can be specialized by the compiler
 		switch(opcode) {
 			//variable instructions
-			case TOY_OPCODE_READ:
+			VM_CASE(TOY_OPCODE_READ):
 				processRead(vm);
-				break;
+				VM_NEXT();
 
-			case TOY_OPCODE_DECLARE:
+			VM_CASE(TOY_OPCODE_DECLARE):
 				processDeclare(vm);
-				break;
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_ASSIGN):
+				processAssign(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_ACCESS):
+				processAccess(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_DECLARE_SLOT):
+				processDeclareSlot(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_ASSIGN_SLOT):
+				processAssignSlot(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_ACCESS_SLOT):
+				processAccessSlot(vm);
+				VM_NEXT();
 
 			//arithmetic instructions
-			case TOY_OPCODE_ADD:
-			case TOY_OPCODE_SUBTRACT:
-			case TOY_OPCODE_MULTIPLY:
-			case TOY_OPCODE_DIVIDE:
-			case TOY_OPCODE_MODULO:
-				processArithmetic(vm, opcode);
-				break;
+			VM_CASE(TOY_OPCODE_ADD):
+				processArithmetic(vm, TOY_OPCODE_ADD);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_SUBTRACT):
+				processArithmetic(vm, TOY_OPCODE_SUBTRACT);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_MULTIPLY):
+				processArithmetic(vm, TOY_OPCODE_MULTIPLY);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_DIVIDE):
+				processArithmetic(vm, TOY_OPCODE_DIVIDE);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_MODULO):
+				processArithmetic(vm, TOY_OPCODE_MODULO);
+				VM_NEXT();
 
 			//comparison instructions
-			case TOY_OPCODE_COMPARE_EQUAL:
-			case TOY_OPCODE_COMPARE_LESS:
-			case TOY_OPCODE_COMPARE_LESS_EQUAL:
-			case TOY_OPCODE_COMPARE_GREATER:
-			case TOY_OPCODE_COMPARE_GREATER_EQUAL:
-				processComparison(vm, opcode);
-				break;
+			VM_CASE(TOY_OPCODE_COMPARE_EQUAL):
+				processComparison(vm, TOY_OPCODE_COMPARE_EQUAL);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_LESS):
+				processComparison(vm, TOY_OPCODE_COMPARE_LESS);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_LESS_EQUAL):
+				processComparison(vm, TOY_OPCODE_COMPARE_LESS_EQUAL);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_GREATER):
+				processComparison(vm, TOY_OPCODE_COMPARE_GREATER);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_GREATER_EQUAL):
+				processComparison(vm, TOY_OPCODE_COMPARE_GREATER_EQUAL);
+				VM_NEXT();
 
 			//logical instructions
-			case TOY_OPCODE_AND:
-			case TOY_OPCODE_OR:
-			case TOY_OPCODE_TRUTHY:
-			case TOY_OPCODE_NEGATE:
-				processLogical(vm, opcode);
-				break;
+			VM_CASE(TOY_OPCODE_AND):
+				processLogical(vm, TOY_OPCODE_AND);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_OR):
+				processLogical(vm, TOY_OPCODE_OR);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_TRUTHY):
+				processLogical(vm, TOY_OPCODE_TRUTHY);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_NEGATE):
+				processLogical(vm, TOY_OPCODE_NEGATE);
+				VM_NEXT();
 
 			//control instructions
-			case TOY_OPCODE_RETURN:
+			VM_CASE(TOY_OPCODE_RETURN):
 				//temp terminator
 				return;
 
 			//various action instructions
-			case TOY_OPCODE_PRINT:
+			VM_CASE(TOY_OPCODE_PRINT):
 				processPrint(vm);
-				break;
+				VM_NEXT();
 
-			case TOY_OPCODE_CONCAT:
+			VM_CASE(TOY_OPCODE_CONCAT):
 				processConcat(vm);
-				break;
+				VM_NEXT();
 
-			//not yet implemented
-			case TOY_OPCODE_ASSIGN:
-			case TOY_OPCODE_ACCESS:
-				fprintf(stderr, TOY_CC_ERROR "ERROR: Incomplete opcode %d found, exiting\n" TOY_CC_RESET, opcode);
-				exit(-1);
+			VM_CASE(TOY_OPCODE_CONCAT_N):
+				processConcatN(vm);
+				VM_NEXT();
+
+			//superinstructions
+			VM_CASE(TOY_OPCODE_ARITHMETIC_IMM):
+				processArithmeticImmediate(vm);
+				VM_NEXT();
 
-			case TOY_OPCODE_PASS:
-			case TOY_OPCODE_ERROR:
-			case TOY_OPCODE_EOF:
+			VM_CASE(TOY_OPCODE_COMPARE_IMM):
+				processComparisonImmediate(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_PRINT_IMM):
+				processPrintImmediate(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_PASS):
+			VM_CASE(TOY_OPCODE_ERROR):
+			VM_CASE(TOY_OPCODE_EOF):
 				fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid opcode %d found, exiting\n" TOY_CC_RESET, opcode);
 				exit(-1);
 		}
 
-		//prepare for the next instruction
-		fixAlignment(vm);
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Unknown opcode %d found, exiting\n" TOY_CC_RESET, opcode);
+		exit(-1);
+	}
+
+#undef VM_CASE
+#undef VM_NEXT
+}
+
+//register instruction handlers, each word is [opcode, destination, left, right]
+#define REGISTER(vm, index) \
+	(vm->slots->data[index])
+
+static inline void processRegisterRead(Toy_VM* vm) {
+	Toy_ValueType type = READ_BYTE(vm);
+	unsigned int dst = READ_BYTE(vm);
+
+	releaseValue(REGISTER(vm, dst));
+	REGISTER(vm, dst) = readValue(vm, type);
+
+	//leave the counter in a good spot
+	fixAlignment(vm);
+}
+
+static inline void processRegisterDeclare(Toy_VM* vm) {
+	vm->routineCounter++; //variable type, unused for now
+	unsigned int len = READ_BYTE(vm);
+	unsigned int src = READ_BYTE(vm);
+
+	//the register keeps its own reference, and shared scopes keep their own copy
+	Toy_String* name = readName(vm, len);
+	Toy_declareScope(vm->scope, name, vm->scope->shared != NULL ? REGISTER(vm, src) : retainValue(REGISTER(vm, src)));
+}
+
+static inline void processRegisterAssign(Toy_VM* vm) {
+	unsigned int src = READ_BYTE(vm);
+	unsigned int len = READ_BYTE(vm);
+
+	Toy_String* name = readName(vm, len);
+	releaseValue(Toy_assignScope(vm->scope, name, retainValue(REGISTER(vm, src))));
+}
+
+static inline void processRegisterAccess(Toy_VM* vm) {
+	unsigned int dst = READ_BYTE(vm);
+	unsigned int len = READ_BYTE(vm);
+
+	Toy_String* name = readName(vm, len);
+	Toy_Value value = retainValue(Toy_accessScope(vm->scope, name));
+
+	releaseValue(REGISTER(vm, dst));
+	REGISTER(vm, dst) = value;
+}
+
+static inline void processRegisterMove(Toy_VM* vm) {
+	unsigned int dst = READ_BYTE(vm);
+	unsigned int src = READ_BYTE(vm);
+
+	//retained first, in case both are the same register
+	Toy_Value value = retainValue(REGISTER(vm, src));
+
+	releaseValue(REGISTER(vm, dst));
+	REGISTER(vm, dst) = value;
+}
+
+static inline void processRegisterBinary(Toy_VM* vm, Toy_OpcodeType opcode) {
+	unsigned int dst = READ_BYTE(vm);
+	Toy_Value left = REGISTER(vm, READ_BYTE(vm));
+	Toy_Value right = REGISTER(vm, READ_BYTE(vm));
+	Toy_Value result;
+
+	if (opcode >= TOY_OPCODE_ADD && opcode <= TOY_OPCODE_MODULO) {
+		result = applyArithmetic(opcode, left, right);
+	}
+	else if (opcode >= TOY_OPCODE_COMPARE_EQUAL && opcode <= TOY_OPCODE_COMPARE_GREATER_EQUAL) {
+		result = applyComparison(opcode, left, right);
+	}
+	else {
+		result = applyLogical(opcode, left, right);
+	}
+
+	//the destination may be one of the operands, so it's only released once they've been used
+	releaseValue(REGISTER(vm, dst));
+	REGISTER(vm, dst) = result;
+}
+
+static inline void processRegisterPrint(Toy_VM* vm) {
+	printValue(REGISTER(vm, READ_BYTE(vm)));
+}
+
+static inline void processRegisterConcat(Toy_VM* vm) {
+	unsigned int dst = READ_BYTE(vm);
+	Toy_Value operands[2];
+	operands[0] = REGISTER(vm, READ_BYTE(vm));
+	operands[1] = REGISTER(vm, READ_BYTE(vm));
+
+	Toy_Value result;
+	if (concatValues(vm, operands, 2, &result)) {
+		releaseValue(REGISTER(vm, dst));
+		REGISTER(vm, dst) = result;
+	}
+}
+
+static inline void processRegisterConcatN(Toy_VM* vm) {
+	unsigned int dst = READ_BYTE(vm);
+	unsigned int first = READ_BYTE(vm);
+	unsigned int count = READ_BYTE(vm);
+
+	Toy_Value result;
+	if (concatValues(vm, &REGISTER(vm, first), count, &result)) {
+		releaseValue(REGISTER(vm, dst));
+		REGISTER(vm, dst) = result;
+	}
+}
+
+static void processRegisters(Toy_VM* vm) {
+#if TOY_VM_COMPUTED_GOTO
+	static const void* const dispatchTable[256] = {
+		[TOY_OPCODE_READ] = &&label_TOY_OPCODE_READ,
+		[TOY_OPCODE_DECLARE] = &&label_TOY_OPCODE_DECLARE,
+		[TOY_OPCODE_ASSIGN] = &&label_TOY_OPCODE_ASSIGN,
+		[TOY_OPCODE_ACCESS] = &&label_TOY_OPCODE_ACCESS,
+
+		[TOY_OPCODE_DECLARE_SLOT] = &&label_TOY_OPCODE_DECLARE_SLOT,
+		[TOY_OPCODE_ASSIGN_SLOT] = &&label_TOY_OPCODE_ASSIGN_SLOT,
+		[TOY_OPCODE_ACCESS_SLOT] = &&label_TOY_OPCODE_ACCESS_SLOT,
+
+		[TOY_OPCODE_ADD] = &&label_TOY_OPCODE_ADD,
+		[TOY_OPCODE_SUBTRACT] = &&label_TOY_OPCODE_SUBTRACT,
+		[TOY_OPCODE_MULTIPLY] = &&label_TOY_OPCODE_MULTIPLY,
+		[TOY_OPCODE_DIVIDE] = &&label_TOY_OPCODE_DIVIDE,
+		[TOY_OPCODE_MODULO] = &&label_TOY_OPCODE_MODULO,
+
+		[TOY_OPCODE_COMPARE_EQUAL] = &&label_TOY_OPCODE_COMPARE_EQUAL,
+		[TOY_OPCODE_COMPARE_LESS] = &&label_TOY_OPCODE_COMPARE_LESS,
+		[TOY_OPCODE_COMPARE_LESS_EQUAL] = &&label_TOY_OPCODE_COMPARE_LESS_EQUAL,
+		[TOY_OPCODE_COMPARE_GREATER] = &&label_TOY_OPCODE_COMPARE_GREATER,
+		[TOY_OPCODE_COMPARE_GREATER_EQUAL] = &&label_TOY_OPCODE_COMPARE_GREATER_EQUAL,
+
+		[TOY_OPCODE_AND] = &&label_TOY_OPCODE_AND,
+		[TOY_OPCODE_OR] = &&label_TOY_OPCODE_OR,
+		[TOY_OPCODE_TRUTHY] = &&label_TOY_OPCODE_TRUTHY,
+		[TOY_OPCODE_NEGATE] = &&label_TOY_OPCODE_NEGATE,
+
+		[TOY_OPCODE_RETURN] = &&label_TOY_OPCODE_RETURN,
+
+		[TOY_OPCODE_PRINT] = &&label_TOY_OPCODE_PRINT,
+		[TOY_OPCODE_CONCAT] = &&label_TOY_OPCODE_CONCAT,
+		[TOY_OPCODE_CONCAT_N] = &&label_TOY_OPCODE_CONCAT_N,
+
+		[TOY_OPCODE_ARITHMETIC_IMM] = &&label_TOY_OPCODE_ARITHMETIC_IMM,
+		[TOY_OPCODE_COMPARE_IMM] = &&label_TOY_OPCODE_COMPARE_IMM,
+		[TOY_OPCODE_PRINT_IMM] = &&label_TOY_OPCODE_PRINT_IMM,
+
+		[TOY_OPCODE_PASS] = &&label_TOY_OPCODE_PASS,
+		[TOY_OPCODE_ERROR] = &&label_TOY_OPCODE_ERROR,
+		[TOY_OPCODE_ERROR + 1 ... TOY_OPCODE_EOF] = &&label_TOY_OPCODE_EOF,
+	};
+
+	#define VM_CASE(opcode) case opcode: label_##opcode
+	#define VM_NEXT() fixAlignment(vm); opcode = READ_BYTE(vm); VM_PROFILE(vm, opcode); goto *dispatchTable[opcode]
+#else
+	#define VM_CASE(opcode) case opcode
+	#define VM_NEXT() fixAlignment(vm); continue
+#endif
+
+	while(true) {
+		Toy_OpcodeType opcode = READ_BYTE(vm);
+		VM_PROFILE(vm, opcode);
+
+		switch(opcode) {
+			//variable instructions
+			VM_CASE(TOY_OPCODE_READ):
+				processRegisterRead(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_DECLARE):
+				processRegisterDeclare(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_ASSIGN):
+				processRegisterAssign(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_ACCESS):
+				processRegisterAccess(vm);
+				VM_NEXT();
+
+			//locals are registers, so these are plain copies
+			VM_CASE(TOY_OPCODE_ASSIGN_SLOT):
+			VM_CASE(TOY_OPCODE_ACCESS_SLOT):
+				processRegisterMove(vm);
+				VM_NEXT();
+
+			//arithmetic instructions
+			VM_CASE(TOY_OPCODE_ADD):
+				processRegisterBinary(vm, TOY_OPCODE_ADD);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_SUBTRACT):
+				processRegisterBinary(vm, TOY_OPCODE_SUBTRACT);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_MULTIPLY):
+				processRegisterBinary(vm, TOY_OPCODE_MULTIPLY);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_DIVIDE):
+				processRegisterBinary(vm, TOY_OPCODE_DIVIDE);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_MODULO):
+				processRegisterBinary(vm, TOY_OPCODE_MODULO);
+				VM_NEXT();
+
+			//comparison instructions
+			VM_CASE(TOY_OPCODE_COMPARE_EQUAL):
+				processRegisterBinary(vm, TOY_OPCODE_COMPARE_EQUAL);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_LESS):
+				processRegisterBinary(vm, TOY_OPCODE_COMPARE_LESS);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_LESS_EQUAL):
+				processRegisterBinary(vm, TOY_OPCODE_COMPARE_LESS_EQUAL);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_GREATER):
+				processRegisterBinary(vm, TOY_OPCODE_COMPARE_GREATER);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_COMPARE_GREATER_EQUAL):
+				processRegisterBinary(vm, TOY_OPCODE_COMPARE_GREATER_EQUAL);
+				VM_NEXT();
+
+			//logical instructions, the unary ones ignore their right operand
+			VM_CASE(TOY_OPCODE_AND):
+				processRegisterBinary(vm, TOY_OPCODE_AND);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_OR):
+				processRegisterBinary(vm, TOY_OPCODE_OR);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_TRUTHY):
+				processRegisterBinary(vm, TOY_OPCODE_TRUTHY);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_NEGATE):
+				processRegisterBinary(vm, TOY_OPCODE_NEGATE);
+				VM_NEXT();
+
+			//control instructions
+			VM_CASE(TOY_OPCODE_RETURN):
+				//temp terminator
+				return;
+
+			//various action instructions
+			VM_CASE(TOY_OPCODE_PRINT):
+				processRegisterPrint(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_CONCAT):
+				processRegisterConcat(vm);
+				VM_NEXT();
+
+			VM_CASE(TOY_OPCODE_CONCAT_N):
+				processRegisterConcatN(vm);
+				VM_NEXT();
+
+			//locals are written directly by the register backend, and literals are read straight into registers
+			VM_CASE(TOY_OPCODE_DECLARE_SLOT):
+			VM_CASE(TOY_OPCODE_ARITHMETIC_IMM):
+			VM_CASE(TOY_OPCODE_COMPARE_IMM):
+			VM_CASE(TOY_OPCODE_PRINT_IMM):
+			VM_CASE(TOY_OPCODE_PASS):
+			VM_CASE(TOY_OPCODE_ERROR):
+			VM_CASE(TOY_OPCODE_EOF):
+				fprintf(stderr, TOY_CC_ERROR "ERROR: Invalid register opcode %d found, exiting\n" TOY_CC_RESET, opcode);
+				exit(-1);
+		}
+
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Unknown register opcode %d found, exiting\n" TOY_CC_RESET, opcode);
+		exit(-1);
+	}
+
+#undef VM_CASE
+#undef VM_NEXT
+}
+
+#undef REGISTER
+#undef VM_PROFILE
+
+static void buildConstants(Toy_VM* vm) {
+	unsigned int count = vm->jumpsSize / sizeof(unsigned int);
+
+	vm->constants = Toy_resizeArray(NULL, count > 0 ? count : 1);
+	vm->constants->count = count;
+
+	//the compiler writes each distinct string once, so there's nothing to share within a routine
+	for (unsigned int i = 0; i < count; i++) {
+		const char* cstring = readData(vm, i);
+		unsigned int length = DATA_LENGTH(cstring);
+
+		if (TOY_VALUE_SHORT_STRINGS && length <= TOY_VALUE_SHORT_STRING_CAPACITY) {
+			vm->constants->data[i] = TOY_VALUE_FROM_SHORT_STRING(cstring, length);
+		}
+		else {
+			Toy_String* str = Toy_createStringLength(&vm->stringBucket, cstring, length);
+			str->cachedHash = DATA_HASH(cstring);
+			vm->constants->data[i] = TOY_VALUE_FROM_STRING(str);
+		}
+	}
+
+	//names are interned on first use, as most entries are only literals
+	vm->names = Toy_resizeArray(NULL, count > 0 ? count : 1);
+	vm->names->count = count;
+
+	for (unsigned int i = 0; i < count; i++) {
+		vm->names->data[i] = TOY_VALUE_FROM_NULL();
+	}
+}
+
+static void freeConstants(Toy_VM* vm) {
+	if (vm->constants == NULL) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < vm->constants->count; i++) {
+		if (!TOY_VALUE_IS_SHORT_STRING(vm->constants->data[i])) {
+			Toy_freeString(TOY_VALUE_AS_STRING(vm->constants->data[i]));
+		}
+	}
+
+	TOY_ARRAY_FREE(vm->constants);
+	vm->constants = NULL;
+
+	for (unsigned int i = 0; i < vm->names->count; i++) {
+		if (!TOY_VALUE_IS_NULL(vm->names->data[i])) {
+			Toy_freeString(TOY_VALUE_AS_STRING(vm->names->data[i]));
+		}
 	}
+
+	TOY_ARRAY_FREE(vm->names);
+	vm->names = NULL;
 }
 
 //exposed functions
@@ -422,6 +1299,19 @@ void Toy_initVM(Toy_VM* vm) {
 	vm->scopeBucket = NULL;
 	vm->stack = NULL;
 	vm->scope = NULL;
+	vm->slots = NULL;
+	vm->constants = NULL;
+	vm->names = NULL;
+	vm->interned = NULL;
+
+#if TOY_VM_PROFILE
+	vm->profile = calloc(1, sizeof(Toy_VMProfile));
+
+	if (vm->profile == NULL) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to allocate a 'Toy_VMProfile' of %d bytes\n" TOY_CC_RESET, (int)sizeof(Toy_VMProfile));
+		exit(1);
+	}
+#endif
 
 	Toy_resetVM(vm);
 }
@@ -454,6 +1344,9 @@ void Toy_bindVM(Toy_VM* vm, unsigned char* bytecode) {
 }
 
 void Toy_bindVMToRoutine(Toy_VM* vm, unsigned char* routine) {
+	//release the previous routine's constants
+	freeConstants(vm);
+
 	vm->routine = routine;
 
 	//read the header metadata
@@ -462,6 +1355,8 @@ void Toy_bindVMToRoutine(Toy_VM* vm, unsigned char* routine) {
 	vm->jumpsSize = READ_UNSIGNED_INT(vm);
 	vm->dataSize = READ_UNSIGNED_INT(vm);
 	vm->subsSize = READ_UNSIGNED_INT(vm);
+	vm->backend = READ_UNSIGNED_INT(vm);
+	vm->frameSize = READ_UNSIGNED_INT(vm);
 
 	//read the header addresses
 	if (vm->paramSize > 0) {
@@ -482,11 +1377,44 @@ void Toy_bindVMToRoutine(Toy_VM* vm, unsigned char* routine) {
 		vm->subsAddr = READ_UNSIGNED_INT(vm);
 	}
 
-	//allocate the stack, scope, and memory
-	vm->stringBucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
-	vm->scopeBucket = Toy_allocateBucket(TOY_BUCKET_SMALL);
-	vm->stack = Toy_allocateStack();
-	vm->scope = Toy_pushScope(&vm->scopeBucket, NULL);
+	//allocate the stack, scope, and memory, keeping any from a previous bind
+	if (vm->stringBucket == NULL) {
+		vm->stringBucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	}
+	if (vm->scopeBucket == NULL) {
+		vm->scopeBucket = Toy_allocateBucket(TOY_BUCKET_SMALL);
+	}
+	if (vm->stack == NULL) {
+		vm->stack = Toy_allocateStack();
+	}
+	if (vm->scope == NULL) {
+		vm->scope = Toy_pushScope(&vm->scopeBucket, NULL);
+	}
+	if (vm->slots == NULL) {
+		vm->slots = TOY_ARRAY_ALLOCATE();
+	}
+	if (vm->interned == NULL) {
+		vm->interned = Toy_allocateTable();
+	}
+
+	//register routines index their whole frame directly
+	if (vm->backend == TOY_BACKEND_REGISTER) {
+		if (vm->slots->capacity < vm->frameSize) {
+			vm->slots = Toy_resizeArray(vm->slots, vm->frameSize);
+		}
+
+		//registers beyond this frame are released, and new ones start out empty
+		while (vm->slots->count > vm->frameSize) {
+			releaseValue(vm->slots->data[--vm->slots->count]);
+		}
+
+		while (vm->slots->count < vm->frameSize) {
+			vm->slots->data[vm->slots->count++] = TOY_VALUE_FROM_NULL();
+		}
+	}
+
+	//build the constant pool
+	buildConstants(vm);
 }
 
 void Toy_runVM(Toy_VM* vm) {
@@ -495,20 +1423,55 @@ void Toy_runVM(Toy_VM* vm) {
 	//prep the routine counter for execution
 	vm->routineCounter = vm->codeAddr;
 
-	//begin
-	process(vm);
+#if TOY_VM_PROFILE
+	//pairs don't span runs
+	vm->profile->lastOpcode = -1;
+	vm->profile->lastScope = NULL;
+#endif
+
+	//begin, based on the routine's encoding
+	if (vm->backend == TOY_BACKEND_REGISTER) {
+		processRegisters(vm);
+	}
+	else {
+		//the stack routines never check the stack's bounds, so reserve the deepest it can get, on top of any leftovers
+		Toy_reserveStack(&vm->stack, vm->stack->count + vm->frameSize);
+
+		process(vm);
+	}
+}
+
+void Toy_clearVMStack(Toy_VM* vm) {
+	while (vm->stack->count > 0) {
+		releaseValue(TOY_STACK_POP_UNCHECKED(vm->stack));
+	}
 }
 
 void Toy_freeVM(Toy_VM* vm) {
+	//the constants live in the string bucket
+	freeConstants(vm);
+
 	//clear the stack, scope and memory
 	Toy_freeStack(vm->stack);
 	Toy_popScope(vm->scope);
 	Toy_freeBucket(&vm->stringBucket);
 	Toy_freeBucket(&vm->scopeBucket);
+	TOY_ARRAY_FREE(vm->slots);
+	Toy_freeTable(vm->interned); //the names themselves live in the string bucket
+
+	vm->stack = NULL;
+	vm->scope = NULL;
+	vm->slots = NULL;
+	vm->interned = NULL;
 
 	//free the bytecode
 	free(vm->bc);
 
+#if TOY_VM_PROFILE
+	free(vm->profile);
+	vm->profile = NULL;
+#endif
+
 	Toy_resetVM(vm);
 }
 
@@ -523,6 +1486,9 @@ void Toy_resetVM(Toy_VM* vm) {
 	vm->dataSize = 0;
 	vm->subsSize = 0;
 
+	vm->backend = TOY_BACKEND_STACK;
+	vm->frameSize = 0;
+
 	vm->paramAddr = 0;
 	vm->codeAddr = 0;
 	vm->jumpsAddr = 0;
@@ -531,5 +1497,66 @@ void Toy_resetVM(Toy_VM* vm) {
 
 	vm->routineCounter = 0;
 
+	//the constants belong to the routine
+	freeConstants(vm);
+
 	//NOTE: stack, scope and memory are not altered during resets
 }
+
+static unsigned int countBucketBytes(Toy_Bucket* bucket) {
+	unsigned int total = 0;
+
+	for (Toy_Bucket* iter = bucket; iter != NULL; iter = iter->next) {
+		total += iter->count;
+	}
+
+	return total;
+}
+
+Toy_VMProfile* Toy_getVMProfile(Toy_VM* vm) {
+#if TOY_VM_PROFILE
+	vm->profile->stringBucketBytes = countBucketBytes(vm->stringBucket);
+	vm->profile->scopeBucketBytes = countBucketBytes(vm->scopeBucket);
+	return vm->profile;
+#else
+	return NULL;
+#endif
+}
+
+const char* Toy_getOpcodeName(Toy_OpcodeType opcode) {
+	switch(opcode) {
+		case TOY_OPCODE_READ: return "READ";
+		case TOY_OPCODE_DECLARE: return "DECLARE";
+		case TOY_OPCODE_ASSIGN: return "ASSIGN";
+		case TOY_OPCODE_ACCESS: return "ACCESS";
+		case TOY_OPCODE_DECLARE_SLOT: return "DECLARE_SLOT";
+		case TOY_OPCODE_ASSIGN_SLOT: return "ASSIGN_SLOT";
+		case TOY_OPCODE_ACCESS_SLOT: return "ACCESS_SLOT";
+		case TOY_OPCODE_ADD: return "ADD";
+		case TOY_OPCODE_SUBTRACT: return "SUBTRACT";
+		case TOY_OPCODE_MULTIPLY: return "MULTIPLY";
+		case TOY_OPCODE_DIVIDE: return "DIVIDE";
+		case TOY_OPCODE_MODULO: return "MODULO";
+		case TOY_OPCODE_COMPARE_EQUAL: return "COMPARE_EQUAL";
+		case TOY_OPCODE_COMPARE_LESS: return "COMPARE_LESS";
+		case TOY_OPCODE_COMPARE_LESS_EQUAL: return "COMPARE_LESS_EQUAL";
+		case TOY_OPCODE_COMPARE_GREATER: return "COMPARE_GREATER";
+		case TOY_OPCODE_COMPARE_GREATER_EQUAL: return "COMPARE_GREATER_EQUAL";
+		case TOY_OPCODE_AND: return "AND";
+		case TOY_OPCODE_OR: return "OR";
+		case TOY_OPCODE_TRUTHY: return "TRUTHY";
+		case TOY_OPCODE_NEGATE: return "NEGATE";
+		case TOY_OPCODE_RETURN: return "RETURN";
+		case TOY_OPCODE_PRINT: return "PRINT";
+		case TOY_OPCODE_CONCAT: return "CONCAT";
+		case TOY_OPCODE_CONCAT_N: return "CONCAT_N";
+		case TOY_OPCODE_ARITHMETIC_IMM: return "ARITHMETIC_IMM";
+		case TOY_OPCODE_COMPARE_IMM: return "COMPARE_IMM";
+		case TOY_OPCODE_PRINT_IMM: return "PRINT_IMM";
+		case TOY_OPCODE_PASS: return "PASS";
+		case TOY_OPCODE_ERROR: return "ERROR";
+		case TOY_OPCODE_EOF: return "EOF";
+	}
+
+	return "UNKNOWN";
+}
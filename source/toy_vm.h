@@ -5,6 +5,31 @@
 #include "toy_bucket.h"
 #include "toy_stack.h"
 #include "toy_scope.h"
+#include "toy_array.h"
+#include "toy_table.h"
+#include "toy_opcodes.h"
+
+//opt-in execution profiling, compiled out entirely unless enabled at build time
+#ifndef TOY_VM_PROFILE
+	#define TOY_VM_PROFILE 0
+#endif
+
+typedef struct Toy_VMProfile {
+	unsigned long long opcodeCounts[256]; //times each opcode was dispatched
+	unsigned long long opcodeTicks[256]; //time spent in each opcode - cycles on x86, otherwise nanoseconds
+	unsigned int opcodePairs[256][256]; //times each opcode was followed by another, indexed [first][second]
+
+	unsigned int stackPeak; //deepest the stack has been
+	unsigned int scopePeak; //longest the scope chain has been
+
+	unsigned int stringBucketBytes; //bytes partitioned from the string bucket, updated by Toy_getVMProfile()
+	unsigned int scopeBucketBytes; //bytes partitioned from the scope bucket, updated by Toy_getVMProfile()
+
+	//internal
+	int lastOpcode;
+	unsigned long long lastTicks;
+	Toy_Scope* lastScope;
+} Toy_VMProfile;
 
 typedef struct Toy_VM {
 	//hold the raw bytecode
@@ -19,6 +44,9 @@ typedef struct Toy_VM {
 	unsigned int dataSize;
 	unsigned int subsSize;
 
+	Toy_RoutineBackend backend; //how the instructions are encoded
+	unsigned int frameSize; //registers needed by register routines, or stack depth needed by stack routines
+
 	unsigned int paramAddr;
 	unsigned int codeAddr;
 	unsigned int jumpsAddr;
@@ -27,15 +55,32 @@ typedef struct Toy_VM {
 
 	unsigned int routineCounter;
 
+	//constant pool - the data section's strings, built once per bind and indexed by jump
+	Toy_Array* constants;
+
+	//name pool - the data section's identifiers, interned the first time each one is used
+	Toy_Array* names;
+
+	//every identifier seen by this VM, so each name has one canonical string, and scope lookups can compare pointers
+	Toy_Table* interned;
+
 	//stack - immediate-level values only
 	Toy_Stack* stack;
 
 	//scope - block-level key/value pairs
 	Toy_Scope* scope;
 
+	//slots - local variables, indexed by the compiler; register routines use this as their register file
+	Toy_Array* slots;
+
 	//easy access to memory
-	Toy_Bucket* stringBucket; //stores the string literals
+	Toy_Bucket* stringBucket; //stores the string literals and constants
 	Toy_Bucket* scopeBucket; //stores the scopes
+
+#if TOY_VM_PROFILE
+	//accumulated across runs, until the VM is freed
+	Toy_VMProfile* profile;
+#endif
 } Toy_VM;
 
 TOY_API void Toy_initVM(Toy_VM* vm);
@@ -43,8 +88,31 @@ TOY_API void Toy_bindVM(Toy_VM* vm, unsigned char* bytecode); //process the vers
 TOY_API void Toy_bindVMToRoutine(Toy_VM* vm, unsigned char* routine); //process the routine only
 
 TOY_API void Toy_runVM(Toy_VM* vm);
+TOY_API void Toy_clearVMStack(Toy_VM* vm); //releases whatever expression statements left on the stack, which is otherwise kept across runs
 TOY_API void Toy_freeVM(Toy_VM* vm);
 
 TOY_API void Toy_resetVM(Toy_VM* vm); //prepares for another run without deleting stack, scope and memory
 
+TOY_API Toy_VMProfile* Toy_getVMProfile(Toy_VM* vm); //NULL unless built with TOY_VM_PROFILE
+TOY_API const char* Toy_getOpcodeName(Toy_OpcodeType opcode);
+
 //TODO: inject extra data
+
+//use labels-as-values for dispatch where supported, otherwise fallback to a switch - can be overridden at build time
+#ifndef TOY_VM_COMPUTED_GOTO
+	#if defined(__GNUC__) || defined(__clang__)
+		#define TOY_VM_COMPUTED_GOTO 1
+	#else
+		#define TOY_VM_COMPUTED_GOTO 0
+	#endif
+#endif
+
+//ropes shorter than this are printed from the stack, rather than flattened on the heap
+#ifndef TOY_VM_PRINT_BUFFER_SIZE
+	#define TOY_VM_PRINT_BUFFER_SIZE 256
+#endif
+
+//concatenations up to this long are copied into a single leaf, while longer ones are joined as ropes, so appending to a long string doesn't copy it
+#ifndef TOY_VM_CONCAT_FLATTEN_LENGTH
+	#define TOY_VM_CONCAT_FLATTEN_LENGTH 256
+#endif
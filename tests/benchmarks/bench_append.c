@@ -0,0 +1,97 @@
+#include "toy_string.h"
+#include "toy_console_colors.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long measureBucket(Toy_Bucket* bucket) {
+	unsigned long bytes = 0;
+
+	while (bucket != NULL) {
+		bytes += bucket->count;
+		bucket = bucket->next;
+	}
+
+	return bytes;
+}
+
+//append one character at a time, the way a script building a string in a loop would
+int main(int argc, char* argv[]) {
+	unsigned int appends = argc > 1 ? (unsigned int)atoi(argv[1]) : 100000;
+
+	printf("Appends: %u, max depth %d, flatten length %d\n", appends, TOY_STRING_MAX_DEPTH, TOY_STRING_FLATTEN_LENGTH);
+
+	//through the rope, as CONCAT does
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		double start = nowSeconds();
+
+		Toy_String* str = Toy_createString(&bucket, "");
+		for (unsigned int i = 0; i < appends; i++) {
+			char c[2] = { 'a' + (i % 26), '\0' };
+			Toy_String* piece = Toy_createString(&bucket, c);
+
+			Toy_String* next = Toy_concatStrings(&bucket, str, piece);
+			Toy_freeString(piece);
+			Toy_freeString(str);
+			str = next;
+		}
+
+		double appended = nowSeconds();
+
+		//read it back, as print and hashing do
+		char* buffer = Toy_getStringRawBuffer(str);
+		unsigned int hash = Toy_hashString(str);
+
+		double read = nowSeconds();
+
+		printf("rope:    append %.3fs, read %.3fs, depth %d, %lu bucket bytes (hash %08x)\n", appended - start, read - appended, (int)str->depth, measureBucket(bucket), hash);
+
+		free(buffer);
+		Toy_freeString(str);
+		Toy_freeBucket(&bucket);
+	}
+
+	//through the builder, then a single string at the end
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		double start = nowSeconds();
+
+		Toy_StringBuilder builder;
+		Toy_initStringBuilder(&builder);
+
+		for (unsigned int i = 0; i < appends; i++) {
+			char c = 'a' + (i % 26);
+			Toy_appendCStringBuilder(&builder, &c, 1);
+		}
+
+		Toy_String* str = Toy_buildString(&bucket, &builder);
+
+		double appended = nowSeconds();
+
+		char* buffer = Toy_getStringRawBuffer(str);
+		unsigned int hash = Toy_hashString(str);
+
+		double read = nowSeconds();
+
+		printf("builder: append %.3fs, read %.3fs, depth %d, %lu bucket bytes (hash %08x)\n", appended - start, read - appended, (int)str->depth, measureBucket(bucket), hash);
+
+		free(buffer);
+		Toy_freeStringBuilder(&builder);
+		Toy_freeString(str);
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "toy_vm.h"
+#include "toy_console_colors.h"
+
+#include "toy_lexer.h"
+#include "toy_parser.h"
+#include "toy_routine.h"
+#include "toy_opcodes.h"
+#include "toy_print.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static char* readFile(const char* path) {
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0L, SEEK_END);
+	long size = ftell(file);
+	rewind(file);
+
+	char* buffer = malloc(size + 1);
+	if (buffer == NULL || fread(buffer, sizeof(char), size, file) < (size_t)size) {
+		free(buffer);
+		fclose(file);
+		return NULL;
+	}
+
+	buffer[size] = '\0';
+	fclose(file);
+	return buffer;
+}
+
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void silentCallback(const char* msg) {
+	//EMPTY
+}
+
+//walk the code section, counting the instructions executed by a single run (there are no jumps yet)
+static unsigned int countInstructions(Toy_VM* vm) {
+	unsigned int count = 0;
+	unsigned int counter = vm->codeAddr;
+
+	while (true) {
+		unsigned char opcode = vm->routine[counter];
+		count++;
+
+		if (opcode == TOY_OPCODE_RETURN) {
+			return count;
+		}
+
+		//values stored after the first word, the same in both encodings
+		if (((opcode == TOY_OPCODE_READ || opcode == TOY_OPCODE_PRINT_IMM) && vm->routine[counter + 1] >= TOY_VALUE_INTEGER) || opcode == TOY_OPCODE_DECLARE || opcode == TOY_OPCODE_ASSIGN || opcode == TOY_OPCODE_ACCESS || opcode == TOY_OPCODE_ARITHMETIC_IMM || opcode == TOY_OPCODE_COMPARE_IMM) {
+			counter += 4;
+		}
+
+		counter += 4;
+	}
+}
+
+static void measure(const char* label, Toy_Ast* ast, Toy_RoutineBackend backend, unsigned int iterations) {
+	unsigned char* routine = Toy_compileRoutineWithBackend(ast, backend);
+
+	Toy_VM vm;
+	Toy_initVM(&vm);
+	Toy_bindVMToRoutine(&vm, routine);
+
+	unsigned int instructions = countInstructions(&vm);
+
+	//run many times, clearing any leftovers between runs
+	double start = nowSeconds();
+
+	for (unsigned int it = 0; it < iterations; it++) {
+		Toy_runVM(&vm);
+
+		Toy_clearVMStack(&vm);
+		Toy_freeTable(vm.scope->table);
+		vm.scope->table = Toy_allocateTable();
+	}
+
+	double elapsed = nowSeconds() - start;
+
+	printf("%s, %s: %u instructions, %u byte routine, %u registers, %u runs in %.3fs\n", label, backend == TOY_BACKEND_REGISTER ? "register" : "stack", instructions, vm.routineSize, vm.frameSize, iterations, elapsed);
+
+	//cleanup
+	Toy_freeVM(&vm);
+	free(routine);
+}
+
+//compile the same scripts for both backends, comparing the instruction counts and wall time
+int main(int argc, char* argv[]) {
+	unsigned int iterations = 200000;
+
+	//locals and arithmetic are where the encodings differ the most
+	const char* builtin = "{ var a = 1; var b = 2; var c = 3; a = a + b * c; b = (a - c) * (b + c); c = a * b - c / 2; a += b % 5; b -= c; var d = a < b; var e = a + b + c; }";
+
+	Toy_setPrintCallback(silentCallback);
+
+	for (int i = 0; i < argc; i++) {
+		char* source = i == 0 ? (char*)builtin : readFile(argv[i]);
+		if (source == NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to read '%s'\n" TOY_CC_RESET, argv[i]);
+			return -1;
+		}
+
+		//parse once
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_Lexer lexer;
+		Toy_bindLexer(&lexer, source);
+		Toy_Parser parser;
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(&bucket, &parser);
+
+		const char* label = i == 0 ? "locals and arithmetic" : argv[i];
+
+		measure(label, ast, TOY_BACKEND_STACK, iterations);
+		measure(label, ast, TOY_BACKEND_REGISTER, iterations);
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+		if (i != 0) {
+			free(source);
+		}
+	}
+
+	return 0;
+}
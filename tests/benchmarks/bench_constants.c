@@ -0,0 +1,78 @@
+#include "toy_vm.h"
+#include "toy_console_colors.h"
+
+#include "toy_lexer.h"
+#include "toy_parser.h"
+#include "toy_bytecode.h"
+#include "toy_print.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void silentCallback(const char* msg) {
+	//EMPTY
+}
+
+static void measureBucket(Toy_Bucket* bucket, unsigned int* links, unsigned long* bytes) {
+	(*links) = 0;
+	(*bytes) = 0;
+
+	while (bucket != NULL) {
+		(*links)++;
+		(*bytes) += bucket->count;
+		bucket = bucket->next;
+	}
+}
+
+//re-run a routine full of string literals, watching the string bucket
+int main(int argc, char* argv[]) {
+	unsigned int iterations = 1000000;
+	unsigned int reportEvery = iterations / 5;
+
+	const char* source = "print \"alpha\"; print \"beta\"; print \"gamma\"; print \"alpha\"; print \"a somewhat longer string literal\";";
+
+	Toy_setPrintCallback(silentCallback);
+
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+	Toy_Lexer lexer;
+	Toy_bindLexer(&lexer, source);
+	Toy_Parser parser;
+	Toy_bindParser(&parser, &lexer);
+	Toy_Ast* ast = Toy_scanParser(&bucket, &parser);
+	Toy_Bytecode bc = Toy_compileBytecode(ast);
+
+	Toy_VM vm;
+	Toy_initVM(&vm);
+	Toy_bindVM(&vm, bc.ptr);
+
+	printf("String literals: %u runs of: %s\n", iterations, source);
+
+	double start = nowSeconds();
+
+	for (unsigned int it = 1; it <= iterations; it++) {
+		Toy_runVM(&vm);
+
+		if (it % reportEvery == 0) {
+			unsigned int links;
+			unsigned long bytes;
+			measureBucket(vm.stringBucket, &links, &bytes);
+
+			printf("after %u runs: %.3fs, string bucket has %u links holding %lu bytes\n", it, nowSeconds() - start, links, bytes);
+		}
+	}
+
+	//cleanup
+	Toy_freeVM(&vm);
+	Toy_freeBucket(&bucket);
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "toy_dictionary.h"
+#include "toy_table.h"
+#include "toy_console_colors.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int rng = 12345;
+static unsigned int nextRandom() {
+	rng = rng * 1103515245u + 12345u;
+	return rng >> 8;
+}
+
+//the same integer keys in both, then memory, full walks, and random lookups
+static void runCompare(unsigned int count) {
+	unsigned int walks = 40000000 / count + 1;
+	unsigned int operations = 4000000;
+
+	double start = nowSeconds();
+	Toy_Table* table = Toy_allocateTable();
+	for (unsigned int i = 0; i < count; i++) {
+		Toy_insertTable(&table, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+	}
+	double tableInsert = nowSeconds() - start;
+
+	start = nowSeconds();
+	Toy_Dictionary* dictionary = Toy_allocateDictionary();
+	for (unsigned int i = 0; i < count; i++) {
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+	}
+	double dictionaryInsert = nowSeconds() - start;
+
+	long long sink = 0;
+
+	//walk every entry
+	start = nowSeconds();
+	for (unsigned int w = 0; w < walks; w++) {
+		for (unsigned int i = 0; i < table->capacity; i++) {
+			if (!TOY_VALUE_IS_NULL(TOY_TABLE_KEY(table, i))) {
+				sink += TOY_VALUE_AS_INTEGER(TOY_TABLE_VALUE(table, i));
+			}
+		}
+	}
+	double tableWalk = nowSeconds() - start;
+
+	start = nowSeconds();
+	for (unsigned int w = 0; w < walks; w++) {
+		for (unsigned int i = 0; i < dictionary->used; i++) {
+			if (!TOY_VALUE_IS_NULL(dictionary->entries[i].key)) {
+				sink += TOY_VALUE_AS_INTEGER(dictionary->entries[i].value);
+			}
+		}
+	}
+	double dictionaryWalk = nowSeconds() - start;
+
+	//random lookups, all hits
+	start = nowSeconds();
+	for (unsigned int i = 0; i < operations; i++) {
+		sink += TOY_VALUE_AS_INTEGER(Toy_lookupTable(&table, TOY_VALUE_FROM_INTEGER(nextRandom() % count)));
+	}
+	double tableLookup = nowSeconds() - start;
+
+	start = nowSeconds();
+	for (unsigned int i = 0; i < operations; i++) {
+		sink += TOY_VALUE_AS_INTEGER(Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(nextRandom() % count)));
+	}
+	double dictionaryLookup = nowSeconds() - start;
+
+	printf("  %7u keys, table:      %9lu bytes, insert %6.1f ns, walk %6.2f ns per key, lookup %6.1f ns\n", count, (unsigned long)TOY_TABLE_SIZE(table->capacity), tableInsert * 1e9 / count, tableWalk * 1e9 / ((double)walks * count), tableLookup * 1e9 / operations);
+	printf("  %7u keys, dictionary: %9lu bytes, insert %6.1f ns, walk %6.2f ns per key, lookup %6.1f ns (sink %lld)\n", count, (unsigned long)TOY_DICTIONARY_SIZE(dictionary->capacity, dictionary->usable), dictionaryInsert * 1e9 / count, dictionaryWalk * 1e9 / ((double)walks * count), dictionaryLookup * 1e9 / operations, sink);
+
+	//cleanup
+	Toy_freeTable(table);
+	Toy_freeDictionary(dictionary);
+}
+
+//bytes per key, averaged over sizes spread between each growth, since any one size lands somewhere arbitrary in the cycle
+static void runMemorySweep(unsigned int from, unsigned int to) {
+	double tableBytes = 0, dictionaryBytes = 0;
+	unsigned int samples = 0;
+
+	Toy_Table* table = Toy_allocateTable();
+	Toy_Dictionary* dictionary = Toy_allocateDictionary();
+	unsigned int next = from;
+
+	for (unsigned int i = 0; i < to; i++) {
+		Toy_insertTable(&table, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+
+		if (i + 1 == next) {
+			tableBytes += (double)TOY_TABLE_SIZE(table->capacity) / (i + 1);
+			dictionaryBytes += (double)TOY_DICTIONARY_SIZE(dictionary->capacity, dictionary->usable) / (i + 1);
+			samples++;
+			next = next * 21 / 20 + 1;
+		}
+	}
+
+	printf("  %u to %u keys: table %.1f bytes per key, dictionary %.1f bytes per key, averaged over %u sizes\n", from, to, tableBytes / samples, dictionaryBytes / samples, samples);
+
+	//cleanup
+	Toy_freeTable(table);
+	Toy_freeDictionary(dictionary);
+}
+
+int main(int argc, char* argv[]) {
+	printf("Dictionary vs table: %s table layout, integer keys\n", TOY_TABLE_SWISS ? "swiss" : "robin hood");
+
+	const unsigned int sizes[] = { 5, 50, 500, 5000, 50000, 500000 };
+
+	for (int s = 0; s < 6; s++) {
+		runCompare(sizes[s]);
+	}
+
+	runMemorySweep(10, 1000000);
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include "toy_string.h"
+#include "toy_console_colors.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//one character at a time, onto either end, so the two ropes hold the same text in different shapes
+static Toy_String* buildRope(Toy_Bucket** bucketHandle, unsigned int length, bool prepend) {
+	Toy_String* str = Toy_createString(bucketHandle, "");
+
+	for (unsigned int i = 0; i < length; i++) {
+		unsigned int index = prepend ? length - 1 - i : i;
+		char c[2] = { 'a' + (index % 26), '\0' };
+		Toy_String* piece = Toy_createString(bucketHandle, c);
+
+		Toy_String* next = prepend ? Toy_concatStrings(bucketHandle, piece, str) : Toy_concatStrings(bucketHandle, str, piece);
+		Toy_freeString(piece);
+		Toy_freeString(str);
+		str = next;
+	}
+
+	return str;
+}
+
+//walk deep ropes the ways the VM does: comparing, hashing and flattening
+int main(int argc, char* argv[]) {
+	unsigned int lengths[] = { 100, 1000, 10000, 100000 };
+
+	for (unsigned int l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+		unsigned int length = lengths[l];
+		unsigned int rounds = 10000000 / length;
+
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_String* appended = buildRope(&bucket, length, false);
+		Toy_String* prepended = buildRope(&bucket, length, true);
+
+		//compare the whole length, as the contents are equal
+		double start = nowSeconds();
+		int compared = 0;
+
+		for (unsigned int r = 0; r < rounds; r++) {
+			compared += Toy_compareStrings(appended, prepended) == 0;
+		}
+
+		double compareTime = nowSeconds() - start;
+
+		//hash from scratch each round
+		start = nowSeconds();
+		unsigned int hash = 0;
+
+		for (unsigned int r = 0; r < rounds; r++) {
+			appended->cachedHash = 0;
+			hash += Toy_hashString(appended);
+		}
+
+		double hashTime = nowSeconds() - start;
+
+		//flatten, as printing a long rope does
+		start = nowSeconds();
+		unsigned int flattened = 0;
+
+		for (unsigned int r = 0; r < rounds; r++) {
+			char* buffer = Toy_getStringRawBuffer(prepended);
+			flattened += buffer[length / 2];
+			free(buffer);
+		}
+
+		double flattenTime = nowSeconds() - start;
+
+		printf("length %6u, depth %2d/%2d, %7u rounds: compare %.3fs, hash %.3fs, flatten %.3fs (%d %08x %u)\n", length, (int)appended->depth, (int)prepended->depth, rounds, compareTime, hashTime, flattenTime, compared, hash, flattened);
+
+		Toy_freeString(appended);
+		Toy_freeString(prepended);
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
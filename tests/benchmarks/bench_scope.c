@@ -0,0 +1,81 @@
+#include "toy_scope.h"
+#include "toy_console_colors.h"
+
+#include "toy_bucket.h"
+#include "toy_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static Toy_String* makeName(Toy_Bucket** bucketHandle, const char* prefix, unsigned int index) {
+	char buffer[32];
+	unsigned int length = snprintf(buffer, sizeof(buffer), "%s%u", prefix, index);
+	return Toy_createNameStringLength(bucketHandle, buffer, length, TOY_VALUE_INTEGER);
+}
+
+//a script's shape: plenty of globals, then nested blocks with a few locals each, read from the innermost block
+int main(int argc, char* argv[]) {
+	unsigned int globals = 200;
+	unsigned int depth = 16;
+	unsigned int locals = 4;
+	unsigned int operations = 2000000;
+
+	printf("Scope chain: %s bloom filter, %u globals, %u nested scopes of %u locals\n", TOY_SCOPE_BLOOM_FILTER ? "with" : "without", globals, depth, locals);
+
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	Toy_Scope* scope = Toy_pushScope(&bucket, NULL);
+
+	Toy_String** globalNames = malloc(sizeof(Toy_String*) * globals);
+	for (unsigned int i = 0; i < globals; i++) {
+		globalNames[i] = makeName(&bucket, "global", i);
+		Toy_declareScope(scope, globalNames[i], TOY_VALUE_FROM_INTEGER(i));
+	}
+
+	Toy_String** localNames = malloc(sizeof(Toy_String*) * depth * locals);
+	for (unsigned int d = 0; d < depth; d++) {
+		scope = Toy_pushScope(&bucket, scope);
+
+		for (unsigned int i = 0; i < locals; i++) {
+			localNames[d * locals + i] = makeName(&bucket, "local", d * locals + i);
+			Toy_declareScope(scope, localNames[d * locals + i], TOY_VALUE_FROM_INTEGER(i));
+		}
+	}
+
+	long long sink = 0;
+
+	//every access walks the whole chain to the root
+	double start = nowSeconds();
+	for (unsigned int i = 0; i < operations; i++) {
+		sink += TOY_VALUE_AS_INTEGER(Toy_accessScope(scope, globalNames[i % globals]));
+	}
+	double globalTime = nowSeconds() - start;
+
+	//every access stops partway along the chain
+	start = nowSeconds();
+	for (unsigned int i = 0; i < operations; i++) {
+		sink += TOY_VALUE_AS_INTEGER(Toy_accessScope(scope, localNames[i % (depth * locals)]));
+	}
+	double localTime = nowSeconds() - start;
+
+	printf("  global access %6.1f ns, local access %6.1f ns (sink %lld)\n", globalTime * 1e9 / operations, localTime * 1e9 / operations, sink);
+
+	//cleanup
+	while (scope != NULL) {
+		scope = Toy_popScope(scope);
+	}
+
+	free(globalNames);
+	free(localNames);
+	Toy_freeBucket(&bucket);
+
+	return 0;
+}
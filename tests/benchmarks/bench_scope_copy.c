@@ -0,0 +1,76 @@
+#include "toy_scope.h"
+#include "toy_console_colors.h"
+
+#include "toy_bucket.h"
+#include "toy_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//snapshot a scope the way a closure would, change one name in the snapshot, then read from both
+static void runCopies(unsigned int count, bool persistent) {
+	unsigned int copies = 4000000 / count + 1000;
+
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	Toy_Scope* scope = persistent ? Toy_pushPersistentScope(&bucket, NULL) : Toy_pushScope(&bucket, NULL);
+
+	Toy_String** names = malloc(sizeof(Toy_String*) * count);
+	for (unsigned int i = 0; i < count; i++) {
+		char buffer[32];
+		unsigned int length = snprintf(buffer, sizeof(buffer), "name%u", i);
+		names[i] = Toy_createNameStringLength(&bucket, buffer, length, TOY_VALUE_INTEGER);
+		Toy_declareScope(scope, names[i], TOY_VALUE_FROM_INTEGER(i));
+	}
+
+	long long sink = 0;
+
+	//copy, modify, read, discard
+	double start = nowSeconds();
+	for (unsigned int c = 0; c < copies; c++) {
+		Toy_Scope* copy = Toy_deepCopyScope(&bucket, scope);
+
+		Toy_assignScope(copy, names[c % count], TOY_VALUE_FROM_INTEGER(-1));
+		sink += TOY_VALUE_AS_INTEGER(Toy_accessScope(copy, names[c % count]));
+		sink += TOY_VALUE_AS_INTEGER(Toy_accessScope(scope, names[c % count]));
+
+		Toy_popScope(copy);
+	}
+	double copyTime = nowSeconds() - start;
+
+	//plain reads, without any copies around
+	unsigned int reads = 4000000;
+	start = nowSeconds();
+	for (unsigned int i = 0; i < reads; i++) {
+		sink += TOY_VALUE_AS_INTEGER(Toy_accessScope(scope, names[i % count]));
+	}
+	double readTime = nowSeconds() - start;
+
+	printf("  %5u names, %-10s: copy-then-modify %9.1f ns, read %6.1f ns (sink %lld)\n", count, persistent ? "persistent" : "table", copyTime * 1e9 / copies, readTime * 1e9 / reads, sink);
+
+	//cleanup
+	Toy_popScope(scope);
+	free(names);
+	Toy_freeBucket(&bucket);
+}
+
+int main(int argc, char* argv[]) {
+	printf("Scope copies: deep copied tables against persistent scopes\n");
+
+	const unsigned int sizes[] = { 4, 16, 64, 256, 1024, 4096 };
+
+	for (int s = 0; s < 6; s++) {
+		runCopies(sizes[s], false);
+		runCopies(sizes[s], true);
+	}
+
+	return 0;
+}
@@ -0,0 +1,173 @@
+//for nanosleep
+#define _POSIX_C_SOURCE 200809L
+
+#include "toy_scope.h"
+#include "toy_shared_table.h"
+#include "toy_console_colors.h"
+
+#include "toy_bucket.h"
+#include "toy_string.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NAME_COUNT 256
+#define READS_PER_THREAD 4000000
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//the globals every worker reads, owned by the host
+static Toy_Bucket* hostBucket;
+static Toy_String* hostNames[NAME_COUNT];
+static Toy_SharedTable* shared;
+
+static atomic_bool writing;
+static atomic_long badReads;
+
+typedef struct Worker {
+	pthread_t thread;
+	bool useShared;
+	double setupTime;
+	double readTime;
+} Worker;
+
+//each worker stands in for a VM, with its own bucket, names and scope chain
+static void* runWorker(void* arg) {
+	Worker* worker = arg;
+
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	Toy_String* names[NAME_COUNT];
+	for (unsigned int i = 0; i < NAME_COUNT; i++) {
+		names[i] = Toy_createNameStringLength(&bucket, hostNames[i]->as.name.data, hostNames[i]->length, TOY_VALUE_INTEGER);
+	}
+
+	//chain onto the shared globals, or rebuild them
+	double start = nowSeconds();
+	Toy_Scope* root = NULL;
+	if (worker->useShared) {
+		root = Toy_pushSharedScope(&bucket, NULL, shared);
+	}
+	else {
+		root = Toy_pushScope(&bucket, NULL);
+		for (unsigned int i = 0; i < NAME_COUNT; i++) {
+			Toy_declareScope(root, names[i], TOY_VALUE_FROM_INTEGER(i));
+		}
+	}
+	Toy_Scope* scope = Toy_pushScope(&bucket, root);
+	worker->setupTime = nowSeconds() - start;
+
+	//values are only ever i, or -i while the writer is running
+	long bad = 0;
+	start = nowSeconds();
+	for (unsigned int i = 0; i < READS_PER_THREAD; i++) {
+		Toy_Value value = Toy_accessScope(scope, names[i % NAME_COUNT]);
+		int expected = i % NAME_COUNT;
+		bad += !TOY_VALUE_IS_INTEGER(value) || (TOY_VALUE_AS_INTEGER(value) != expected && TOY_VALUE_AS_INTEGER(value) != -expected);
+	}
+	worker->readTime = nowSeconds() - start;
+
+	atomic_fetch_add(&badReads, bad);
+
+	//cleanup
+	while ((scope = Toy_popScope(scope)) != NULL) /* */;
+	Toy_freeBucket(&bucket);
+
+	return NULL;
+}
+
+//flips the shared globals between i and -i every 100us, until the readers are done
+static void* runWriter(void* arg) {
+	long* writes = arg;
+
+	for (unsigned int i = 0; atomic_load(&writing); i++) {
+		unsigned int n = i % NAME_COUNT;
+		int value = (i / NAME_COUNT) % 2 ? -(int)n : (int)n;
+		Toy_insertSharedTable(shared, TOY_VALUE_FROM_STRING(hostNames[n]), TOY_VALUE_FROM_INTEGER(value));
+		(*writes)++;
+
+		nanosleep(&(struct timespec){ .tv_sec = 0, .tv_nsec = 100000 }, NULL);
+	}
+
+	return NULL;
+}
+
+static void runThreads(unsigned int threadCount, bool useShared, bool withWriter) {
+	Worker* workers = malloc(sizeof(Worker) * threadCount);
+	pthread_t writer;
+	long writes = 0;
+
+	atomic_store(&badReads, 0);
+	atomic_store(&writing, true);
+	if (withWriter) {
+		pthread_create(&writer, NULL, runWriter, &writes);
+	}
+
+	double start = nowSeconds();
+	for (unsigned int t = 0; t < threadCount; t++) {
+		workers[t].useShared = useShared;
+		pthread_create(&workers[t].thread, NULL, runWorker, &workers[t]);
+	}
+
+	double setupTime = 0, readTime = 0;
+	for (unsigned int t = 0; t < threadCount; t++) {
+		pthread_join(workers[t].thread, NULL);
+		setupTime += workers[t].setupTime;
+		readTime += workers[t].readTime;
+	}
+	double wallTime = nowSeconds() - start;
+
+	atomic_store(&writing, false);
+	if (withWriter) {
+		pthread_join(writer, NULL);
+	}
+
+	printf("  %2u threads, %-14s: setup %8.1f us, read %6.1f ns, wall %7.1f ms, %8ld writes, %ld bad reads\n",
+		threadCount,
+		useShared ? (withWriter ? "shared+writer" : "shared") : "rebuilt",
+		setupTime * 1e6 / threadCount,
+		readTime * 1e9 / threadCount / READS_PER_THREAD,
+		wallTime * 1e3,
+		writes,
+		atomic_load(&badReads)
+	);
+
+	free(workers);
+}
+
+int main(int argc, char* argv[]) {
+	printf("Shared globals: %d names read by worker threads, each rebuilding its own root scope, or chaining onto one shared scope\n", NAME_COUNT);
+
+	//setup
+	hostBucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	shared = Toy_allocateSharedTable();
+
+	for (unsigned int i = 0; i < NAME_COUNT; i++) {
+		char buffer[32];
+		unsigned int length = snprintf(buffer, sizeof(buffer), "global%u", i);
+		hostNames[i] = Toy_createNameStringLength(&hostBucket, buffer, length, TOY_VALUE_INTEGER);
+		Toy_insertSharedTable(shared, TOY_VALUE_FROM_STRING(hostNames[i]), TOY_VALUE_FROM_INTEGER(i));
+	}
+
+	const unsigned int counts[] = { 1, 2, 4, 8, 16 };
+
+	for (int c = 0; c < 5; c++) {
+		runThreads(counts[c], false, false);
+		runThreads(counts[c], true, false);
+		runThreads(counts[c], true, true);
+	}
+
+	//cleanup
+	Toy_freeSharedTable(shared);
+	Toy_freeBucket(&hostBucket);
+
+	return 0;
+}
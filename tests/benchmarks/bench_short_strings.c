@@ -0,0 +1,112 @@
+#include "toy_table.h"
+#include "toy_console_colors.h"
+
+#include "toy_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long measureBucket(Toy_Bucket* bucket) {
+	unsigned long bytes = 0;
+
+	while (bucket != NULL) {
+		bytes += bucket->count;
+		bucket = bucket->next;
+	}
+
+	return bytes;
+}
+
+//make a string value the way the VM does, inline when it fits
+static Toy_Value makeKey(Toy_Bucket** bucketHandle, const char* cstring, unsigned int length) {
+	if (TOY_VALUE_SHORT_STRINGS && length <= TOY_VALUE_SHORT_STRING_CAPACITY) {
+		return TOY_VALUE_FROM_SHORT_STRING(cstring, length);
+	}
+
+	return TOY_VALUE_FROM_STRING(Toy_createStringLength(bucketHandle, cstring, length));
+}
+
+static void freeKey(Toy_Value key) {
+	if (TOY_VALUE_IS_STRING(key) && !TOY_VALUE_IS_SHORT_STRING(key)) {
+		Toy_freeString(TOY_VALUE_AS_STRING(key));
+	}
+}
+
+//a table keyed by short identifiers, the way a scope full of variables is
+int main(int argc, char* argv[]) {
+	unsigned int count = argc > 1 ? (unsigned int)atoi(argv[1]) : 4000;
+	unsigned int rounds = 200;
+
+	printf("Short strings: %s, capacity %d, %u keys x %u rounds\n", TOY_VALUE_SHORT_STRINGS ? "inline" : "off", TOY_VALUE_SHORT_STRING_CAPACITY, count, rounds);
+
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	Toy_Value* keys = malloc(sizeof(Toy_Value) * count);
+
+	//build the keys, like "k0", "ke1", "key2"
+	char buffer[32];
+	for (unsigned int i = 0; i < count; i++) {
+		unsigned int length = snprintf(buffer, sizeof(buffer), "%.*s%u", 1 + (int)(i % 3), "key", i);
+		keys[i] = makeKey(&bucket, buffer, length);
+	}
+
+	unsigned long keyBytes = measureBucket(bucket);
+
+	//insert, then look up with freshly made keys, as each READ of a name would
+	double start = nowSeconds();
+	long long sink = 0;
+
+	Toy_Table* table = NULL;
+	for (unsigned int r = 0; r < rounds; r++) {
+		if (table != NULL) {
+			Toy_freeTable(table);
+		}
+		table = Toy_allocateTable();
+
+		for (unsigned int i = 0; i < count; i++) {
+			Toy_insertTable(&table, keys[i], TOY_VALUE_FROM_INTEGER(i));
+		}
+	}
+
+	double inserted = nowSeconds();
+
+	Toy_Bucket* lookupBucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+	for (unsigned int r = 0; r < rounds; r++) {
+		for (unsigned int i = 0; i < count; i++) {
+			unsigned int length = snprintf(buffer, sizeof(buffer), "%.*s%u", 1 + (int)(i % 3), "key", i);
+			Toy_Value key = makeKey(&lookupBucket, buffer, length);
+			sink += TOY_VALUE_AS_INTEGER(Toy_lookupTable(&table, key));
+			freeKey(key);
+		}
+	}
+
+	double looked = nowSeconds();
+
+	unsigned int inlined = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		inlined += TOY_VALUE_IS_SHORT_STRING(keys[i]);
+	}
+
+	printf("insert %.3fs, lookup %.3fs, %u of %u keys inline, %lu key bytes in buckets, %lu table bytes (sink %lld)\n", inserted - start, looked - inserted, inlined, count, keyBytes, (unsigned long)TOY_TABLE_SIZE(table->capacity), sink);
+
+	//cleanup
+	for (unsigned int i = 0; i < count; i++) {
+		freeKey(keys[i]);
+	}
+
+	Toy_freeTable(table);
+	Toy_freeBucket(&lookupBucket);
+	Toy_freeBucket(&bucket);
+	free(keys);
+
+	return 0;
+}
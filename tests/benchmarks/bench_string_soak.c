@@ -0,0 +1,155 @@
+#include "toy_vm.h"
+#include "toy_console_colors.h"
+
+#include "toy_lexer.h"
+#include "toy_parser.h"
+#include "toy_optimizer.h"
+#include "toy_routine.h"
+#include "toy_print.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//resident set size in KB, where the platform reports it
+static long measureRSS() {
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file == NULL) {
+		return -1;
+	}
+
+	long size = 0, resident = 0;
+	if (fscanf(file, "%ld %ld", &size, &resident) != 2) {
+		resident = -1;
+	}
+
+	fclose(file);
+	return resident >= 0 ? resident * 4 : -1; //assumes 4KB pages
+}
+
+static void measureBucket(Toy_Bucket* bucket, unsigned int* buckets, unsigned long* bytes) {
+	(*buckets) = 0;
+	(*bytes) = 0;
+
+	while (bucket != NULL) {
+		(*buckets)++;
+		(*bytes) += bucket->capacity;
+		bucket = bucket->next;
+	}
+}
+
+static unsigned long printed = 0;
+
+static void countingCallback(const char* msg) {
+	printed += strlen(msg);
+}
+
+static unsigned char* compileSource(const char* source, Toy_RoutineBackend backend) {
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+	Toy_Lexer lexer;
+	Toy_bindLexer(&lexer, source);
+	Toy_Parser parser;
+	Toy_bindParser(&parser, &lexer);
+	Toy_Ast* ast = Toy_scanParser(&bucket, &parser);
+	Toy_optimizeAst(&bucket, ast);
+
+	unsigned char* routine = Toy_compileRoutineWithBackend(ast, backend);
+
+	Toy_freeBucket(&bucket);
+	return routine;
+}
+
+//a long-running VM's string traffic: globals declared once, then replaced, joined, printed and thrown away by every run
+static const char* setup =
+	"var greeting = \"hello there, \";"
+	"var name = \"long running world\";"
+	"var message = \"nothing yet\";"
+	"var padding = \"................................................................................................................................................\";";
+
+static const char* workload =
+	"message = greeting .. name .. \"!\";"
+	"print message;"
+	"print greeting .. message .. true;"
+	"name = message .. \" again\";"
+	"name = \"long running world\";"
+	"print padding .. message .. padding;"
+	"{ var local = message .. \" in a block\"; print local; local = padding .. local; }"
+	"message .. \" and left behind\";";
+
+static int soak(Toy_RoutineBackend backend, unsigned long iterations) {
+	unsigned char* setupRoutine = compileSource(setup, backend);
+	unsigned char* workloadRoutine = compileSource(workload, backend);
+
+	Toy_VM vm;
+	Toy_initVM(&vm);
+
+	Toy_bindVMToRoutine(&vm, setupRoutine);
+	Toy_runVM(&vm);
+	Toy_resetVM(&vm);
+	Toy_bindVMToRoutine(&vm, workloadRoutine);
+
+	printf("%s backend:\n", backend == TOY_BACKEND_REGISTER ? "Register" : "Stack");
+
+	double start = nowSeconds();
+	unsigned int firstBuckets = 0;
+	unsigned int buckets = 0;
+	unsigned long bytes = 0;
+
+	for (unsigned long i = 0; i < iterations; i++) {
+		Toy_runVM(&vm);
+
+		//the expression statement's result is dropped between runs
+		Toy_clearVMStack(&vm);
+
+		//report along the way
+		if ((i + 1) % (iterations / 10 > 0 ? iterations / 10 : 1) == 0) {
+			measureBucket(vm.stringBucket, &buckets, &bytes);
+
+			if (firstBuckets == 0) {
+				firstBuckets = buckets;
+			}
+
+			printf("%10lu: %.3fs, %5u buckets, %9lu bucket bytes, %8ld KB resident\n", i + 1, nowSeconds() - start, buckets, bytes, measureRSS());
+		}
+	}
+
+	//cleanup
+	Toy_freeVM(&vm);
+	free(setupRoutine);
+	free(workloadRoutine);
+
+	//everything a run allocates is given back by the end of it, so the bucket never grows past its first reports
+	if (buckets != firstBuckets) {
+		fprintf(stderr, TOY_CC_ERROR "ERROR: String bucket grew from %u to %u buckets\n" TOY_CC_RESET, firstBuckets, buckets);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned long iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+
+	printf("String soak: %lu runs of a string-heavy routine in one VM\n", iterations);
+
+	Toy_setPrintCallback(countingCallback);
+
+	int result = 0;
+	result |= soak(TOY_BACKEND_STACK, iterations);
+	result |= soak(TOY_BACKEND_REGISTER, iterations);
+
+	Toy_resetPrintCallback();
+
+	printf("(%lu characters printed)\n", printed);
+
+	return result;
+}
@@ -0,0 +1,168 @@
+#include "toy_vm.h"
+#include "toy_console_colors.h"
+
+#include "toy_lexer.h"
+#include "toy_parser.h"
+#include "toy_optimizer.h"
+#include "toy_routine.h"
+#include "toy_opcodes.h"
+#include "toy_print.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static char* readFile(const char* path) {
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0L, SEEK_END);
+	long size = ftell(file);
+	rewind(file);
+
+	char* buffer = malloc(size + 1);
+	if (buffer == NULL || fread(buffer, sizeof(char), size, file) < (size_t)size) {
+		free(buffer);
+		fclose(file);
+		return NULL;
+	}
+
+	buffer[size] = '\0';
+	fclose(file);
+	return buffer;
+}
+
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void silentCallback(const char* msg) {
+	//EMPTY
+}
+
+//opcode pair frequencies, accumulated over every script
+static unsigned int pairs[256][256];
+
+//walk the code section, counting the instructions and the pairs executed by a single run (there are no jumps yet)
+static unsigned int countInstructions(Toy_VM* vm) {
+	unsigned int count = 0;
+	unsigned int counter = vm->codeAddr;
+	int previous = -1;
+
+	while (true) {
+		unsigned char opcode = vm->routine[counter];
+		count++;
+
+		if (previous >= 0) {
+			pairs[previous][opcode]++;
+		}
+		previous = opcode;
+
+		if (opcode == TOY_OPCODE_RETURN) {
+			return count;
+		}
+
+		//values stored after the first word
+		if (((opcode == TOY_OPCODE_READ || opcode == TOY_OPCODE_PRINT_IMM) && vm->routine[counter + 1] >= TOY_VALUE_INTEGER) || opcode == TOY_OPCODE_DECLARE || opcode == TOY_OPCODE_ASSIGN || opcode == TOY_OPCODE_ACCESS || opcode == TOY_OPCODE_ARITHMETIC_IMM || opcode == TOY_OPCODE_COMPARE_IMM) {
+			counter += 4;
+		}
+
+		counter += 4;
+	}
+}
+
+static void printPairs(unsigned int limit) {
+	printf("most frequent opcode pairs:\n");
+
+	for (unsigned int n = 0; n < limit; n++) {
+		unsigned int best = 0, first = 0, second = 0;
+
+		for (unsigned int i = 0; i < 256; i++) {
+			for (unsigned int j = 0; j < 256; j++) {
+				if (pairs[i][j] > best) {
+					best = pairs[i][j];
+					first = i;
+					second = j;
+				}
+			}
+		}
+
+		if (best == 0) {
+			break;
+		}
+
+		printf("  %4u  %s -> %s\n", best, Toy_getOpcodeName(first), Toy_getOpcodeName(second));
+		pairs[first][second] = 0;
+	}
+}
+
+//compile each script with or without superinstructions, profiling the opcode pairs and timing the runs
+int main(int argc, char* argv[]) {
+	unsigned int iterations = 200000;
+
+	//'variable op literal' is the shape being fused
+	const char* builtin = "{ var a = 1; var b = a + 2; var c = b * 3 - 4; var d = c < 10; var e = a != 1; a = a + 1; b = b % 5; c = c / 2.5; var f = b >= 0; print a; print 42; }";
+
+	printf("Superinstructions: %s\n", TOY_ROUTINE_SUPERINSTRUCTIONS ? "fused" : "off");
+
+	Toy_setPrintCallback(silentCallback);
+
+	for (int i = 0; i < argc; i++) {
+		char* source = i == 0 ? (char*)builtin : readFile(argv[i]);
+		if (source == NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to read '%s'\n" TOY_CC_RESET, argv[i]);
+			return -1;
+		}
+
+		//compile once, the same way the repl does
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_Lexer lexer;
+		Toy_bindLexer(&lexer, source);
+		Toy_Parser parser;
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(&bucket, &parser);
+		Toy_optimizeAst(&bucket, ast);
+
+		unsigned char* routine = Toy_compileRoutineWithBackend(ast, TOY_BACKEND_STACK);
+
+		Toy_VM vm;
+		Toy_initVM(&vm);
+		Toy_bindVMToRoutine(&vm, routine);
+
+		unsigned int instructions = countInstructions(&vm);
+
+		//run many times, clearing any leftovers between runs
+		double start = nowSeconds();
+
+		for (unsigned int it = 0; it < iterations; it++) {
+			Toy_runVM(&vm);
+
+			Toy_clearVMStack(&vm);
+			Toy_freeTable(vm.scope->table);
+			vm.scope->table = Toy_allocateTable();
+		}
+
+		double elapsed = nowSeconds() - start;
+
+		printf("%s: %u instructions x %u runs in %.3fs\n", i == 0 ? "variable op literal" : argv[i], instructions, iterations, elapsed);
+
+		//cleanup
+		Toy_freeVM(&vm);
+		free(routine);
+		Toy_freeBucket(&bucket);
+		if (i != 0) {
+			free(source);
+		}
+	}
+
+	printPairs(8);
+
+	return 0;
+}
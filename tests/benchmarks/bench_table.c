@@ -0,0 +1,174 @@
+#include "toy_table.h"
+#include "toy_console_colors.h"
+
+#include "toy_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int rng = 12345;
+static unsigned int nextRandom() {
+	rng = rng * 1103515245u + 12345u;
+	return rng >> 8;
+}
+
+//keys are either integers, or heap strings with their hashes cached, the way a scope's names are
+static Toy_Value* makeKeys(Toy_Bucket** bucketHandle, unsigned int count, unsigned int offset, bool strings) {
+	Toy_Value* keys = malloc(sizeof(Toy_Value) * count);
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (strings) {
+			char buffer[32];
+			unsigned int length = snprintf(buffer, sizeof(buffer), "identifier%u", offset + i);
+			Toy_String* str = Toy_createStringLength(bucketHandle, buffer, length);
+			Toy_hashString(str);
+			keys[i] = TOY_VALUE_FROM_STRING(str);
+		}
+		else {
+			keys[i] = TOY_VALUE_FROM_INTEGER(offset + i);
+		}
+	}
+
+	return keys;
+}
+
+static void freeKeys(Toy_Value* keys, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++) {
+		if (TOY_VALUE_IS_STRING(keys[i]) && !TOY_VALUE_IS_SHORT_STRING(keys[i])) {
+			Toy_freeString(TOY_VALUE_AS_STRING(keys[i]));
+		}
+	}
+
+	free(keys);
+}
+
+//hits, misses, and a delete-heavy churn, over tables of a few sizes
+static void runMixes(unsigned int count, bool strings) {
+	unsigned int operations = 4000000;
+
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	Toy_Value* present = makeKeys(&bucket, count, 0, strings);
+	Toy_Value* absent = makeKeys(&bucket, count, count, strings);
+
+	Toy_Table* table = Toy_allocateTable();
+	for (unsigned int i = 0; i < count; i++) {
+		Toy_insertTable(&table, present[i], TOY_VALUE_FROM_INTEGER(i));
+	}
+
+	long long sink = 0;
+
+	//every lookup finds its key
+	double start = nowSeconds();
+	for (unsigned int i = 0; i < operations; i++) {
+		sink += TOY_VALUE_AS_INTEGER(Toy_lookupTable(&table, present[nextRandom() % count]));
+	}
+	double hits = nowSeconds() - start;
+
+	//no lookup finds its key
+	start = nowSeconds();
+	for (unsigned int i = 0; i < operations; i++) {
+		sink += TOY_VALUE_IS_NULL(Toy_lookupTable(&table, absent[nextRandom() % count]));
+	}
+	double misses = nowSeconds() - start;
+
+	//swap keys in and out, keeping the size steady, with a lookup between each pair
+	start = nowSeconds();
+	for (unsigned int i = 0; i < operations / 2; i++) {
+		unsigned int slot = nextRandom() % count;
+
+		Toy_removeTable(&table, present[slot]);
+		Toy_insertTable(&table, absent[slot], TOY_VALUE_FROM_INTEGER(slot));
+		sink += TOY_VALUE_AS_INTEGER(Toy_lookupTable(&table, absent[nextRandom() % count])) > 0;
+
+		//trade places, so the next pick of this slot removes the key just inserted
+		Toy_Value tmp = present[slot];
+		present[slot] = absent[slot];
+		absent[slot] = tmp;
+	}
+	double churn = nowSeconds() - start;
+
+	printf("  %6u %s keys: hit %6.1f ns, miss %6.1f ns, delete-heavy %6.1f ns, %8lu table bytes (sink %lld)\n",
+		count,
+		strings ? "string " : "integer",
+		hits * 1e9 / operations,
+		misses * 1e9 / operations,
+		churn * 1e9 / operations,
+		(unsigned long)TOY_TABLE_SIZE(table->capacity),
+		sink
+	);
+
+	//cleanup
+	Toy_freeTable(table);
+	freeKeys(present, count);
+	freeKeys(absent, count);
+	Toy_freeBucket(&bucket);
+}
+
+//grow one table from its initial capacity to 'count' entries, keyed by integers, inline strings, or ropes
+static void runGrowth(unsigned int count, int kind) {
+	const char* kinds[] = { "integer", "inline string", "rope string" };
+
+	Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+	Toy_Value* keys = malloc(sizeof(Toy_Value) * count);
+
+	for (unsigned int i = 0; i < count; i++) {
+		char buffer[32];
+		unsigned int length = snprintf(buffer, sizeof(buffer), "k%x", i); //fits inline either way
+
+		if (kind == 0) {
+			keys[i] = TOY_VALUE_FROM_INTEGER(i);
+		}
+		else if (kind == 1) {
+			keys[i] = TOY_VALUE_FROM_SHORT_STRING(buffer, length);
+		}
+		else {
+			Toy_String* left = Toy_createString(&bucket, "a rope string key, number ");
+			Toy_String* right = Toy_createStringLength(&bucket, buffer, length);
+			keys[i] = TOY_VALUE_FROM_STRING(Toy_concatStrings(&bucket, left, right));
+			Toy_freeString(left);
+			Toy_freeString(right);
+		}
+	}
+
+	double start = nowSeconds();
+
+	Toy_Table* table = Toy_allocateTable();
+	for (unsigned int i = 0; i < count; i++) {
+		Toy_insertTable(&table, keys[i], TOY_VALUE_FROM_INTEGER(i));
+	}
+
+	double elapsed = nowSeconds() - start;
+
+	printf("  growth to %7u %-13s keys: %7.3fs, %6.1f ns per insert, capacity %u\n", count, kinds[kind], elapsed, elapsed * 1e9 / count, table->capacity);
+
+	//cleanup
+	Toy_freeTable(table);
+	freeKeys(keys, count);
+	Toy_freeBucket(&bucket);
+}
+
+int main(int argc, char* argv[]) {
+	printf("Table layout: %s\n", TOY_TABLE_SWISS ? "swiss" : "robin hood");
+
+	const unsigned int sizes[] = { 16, 256, 4096, 65536 };
+
+	for (int s = 0; s < 4; s++) {
+		runMixes(sizes[s], false);
+		runMixes(sizes[s], true);
+	}
+
+	for (int kind = 0; kind < 3; kind++) {
+		runGrowth(1000000, kind);
+	}
+
+	return 0;
+}
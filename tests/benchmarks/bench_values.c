@@ -0,0 +1,80 @@
+#include "toy_value.h"
+#include "toy_console_colors.h"
+
+#include "toy_stack.h"
+#include "toy_table.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//stack and table throughput, under whichever value layout this was built with
+int main(int argc, char* argv[]) {
+	unsigned int depth = 1000;
+	unsigned int rounds = 20000;
+	unsigned int entries = 1000000;
+
+	printf("Values: %s layout, sizeof(Toy_Value) is %d, sizeof(Toy_TableEntry) is %d\n", TOY_VALUE_PACKED ? "packed" : "tagged union", (int)sizeof(Toy_Value), (int)sizeof(Toy_TableEntry));
+
+	//fill and drain the stack repeatedly
+	{
+		Toy_Stack* stack = Toy_allocateStack();
+		int checksum = 0;
+
+		double start = nowSeconds();
+
+		for (unsigned int r = 0; r < rounds; r++) {
+			for (unsigned int i = 0; i < depth; i++) {
+				Toy_pushStack(&stack, TOY_VALUE_FROM_INTEGER(i));
+			}
+			for (unsigned int i = 0; i < depth; i++) {
+				checksum += TOY_VALUE_AS_INTEGER(Toy_popStack(&stack));
+			}
+		}
+
+		double elapsed = nowSeconds() - start;
+
+		printf("stack: %u pushes and pops in %.3fs, %.2f million per second (checksum %d)\n", depth * rounds, elapsed, (double)depth * rounds / elapsed / 1e6, checksum);
+
+		Toy_freeStack(stack);
+	}
+
+	//insert, lookup and remove integer keys
+	{
+		Toy_Table* table = Toy_allocateTable();
+		int checksum = 0;
+
+		double start = nowSeconds();
+
+		for (unsigned int i = 0; i < entries; i++) {
+			Toy_insertTable(&table, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		double inserted = nowSeconds();
+
+		for (unsigned int i = 0; i < entries; i++) {
+			checksum += TOY_VALUE_AS_INTEGER(Toy_lookupTable(&table, TOY_VALUE_FROM_INTEGER(i)));
+		}
+
+		double looked = nowSeconds();
+
+		for (unsigned int i = 0; i < entries; i++) {
+			Toy_removeTable(&table, TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		double removed = nowSeconds();
+
+		printf("table: %u entries, insert %.3fs, lookup %.3fs, remove %.3fs (checksum %d)\n", entries, inserted - start, looked - inserted, removed - looked, checksum);
+
+		Toy_freeTable(table);
+	}
+
+	return 0;
+}
@@ -18,10 +18,12 @@ int test_sizeof_ast_64bit() {
 	TEST_SIZEOF(Toy_AstType, 4);
 	TEST_SIZEOF(Toy_AstBlock, 32);
 	TEST_SIZEOF(Toy_AstVarDeclare, 24);
-	TEST_SIZEOF(Toy_AstValue, 24);
+	TEST_SIZEOF(Toy_AstVarAccess, 16);
+	TEST_SIZEOF(Toy_AstValue, (TOY_VALUE_PACKED ? 16 : 24));
 	TEST_SIZEOF(Toy_AstUnary, 16);
 	TEST_SIZEOF(Toy_AstBinary, 24);
 	TEST_SIZEOF(Toy_AstGroup, 16);
+	TEST_SIZEOF(Toy_AstScope, 16);
 	TEST_SIZEOF(Toy_AstPrint, 16);
 	TEST_SIZEOF(Toy_AstPass, 4);
 	TEST_SIZEOF(Toy_AstError, 4);
@@ -47,10 +49,12 @@ int test_sizeof_ast_32bit() {
 	TEST_SIZEOF(Toy_AstType, 4);
 	TEST_SIZEOF(Toy_AstBlock, 16);
 	TEST_SIZEOF(Toy_AstVarDeclare, 12);
+	TEST_SIZEOF(Toy_AstVarAccess, 8);
 	TEST_SIZEOF(Toy_AstValue, 12);
 	TEST_SIZEOF(Toy_AstUnary, 12);
 	TEST_SIZEOF(Toy_AstBinary, 16);
 	TEST_SIZEOF(Toy_AstGroup, 8);
+	TEST_SIZEOF(Toy_AstScope, 8);
 	TEST_SIZEOF(Toy_AstPrint, 8);
 	TEST_SIZEOF(Toy_AstPass, 4);
 	TEST_SIZEOF(Toy_AstError, 4);
@@ -249,6 +253,51 @@ int test_type_emission(Toy_Bucket** bucketHandle) {
 		Toy_freeString(name);
 	}
 
+	//emit var access
+	{
+		//build the AST
+		Toy_Ast* ast = NULL;
+		Toy_String* name = Toy_createNameStringLength(bucketHandle, "foobar", 6, TOY_VALUE_NULL);
+
+		Toy_private_emitAstVariableAccess(bucketHandle, &ast, name);
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_VAR_ACCESS ||
+
+			ast->varAccess.name == NULL ||
+			ast->varAccess.name->type != TOY_STRING_NAME ||
+			strcmp(ast->varAccess.name->as.name.data, "foobar") != 0)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to emit a var access as 'Toy_Ast', state unknown\n" TOY_CC_RESET);
+			Toy_freeString(name);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeString(name);
+	}
+
+	//emit scope
+	{
+		//build the AST
+		Toy_Ast* ast = NULL;
+		Toy_private_initAstBlock(bucketHandle, &ast);
+		Toy_private_emitAstScope(bucketHandle, &ast);
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_SCOPE ||
+			ast->scope.child == NULL ||
+			ast->scope.child->type != TOY_AST_BLOCK)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to emit a scope as 'Toy_Ast', state unknown\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
 	return 0;
 }
 
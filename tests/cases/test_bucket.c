@@ -72,6 +72,105 @@ int test_buckets() {
 	return 0;
 }
 
+int test_bucket_blocks() {
+	//give a block back, and get the same one again
+	{
+		//init
+		Toy_Bucket* bucket = Toy_allocateBucket(128);
+
+		//grab some memory, keeping the first partition from being the last
+		void* a = Toy_partitionBucketBlock(&bucket, 24);
+		void* b = Toy_partitionBucketBlock(&bucket, 20);
+
+		Toy_releaseBucketBlock(bucket, a, 24);
+
+		void* c = Toy_partitionBucketBlock(&bucket, 17); //same size class
+
+		//checks
+		if (
+			a != c ||
+			bucket->count != 48 ||
+			bucket->released != 0)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to reuse a block in 'Toy_Bucket'\n" TOY_CC_RESET);
+			return -1;
+		}
+
+		//giving everything back empties the bucket
+		Toy_releaseBucketBlock(bucket, c, 17);
+		Toy_releaseBucketBlock(bucket, b, 20);
+
+		if (
+			bucket->count != 0 ||
+			bucket->released != 0 ||
+			bucket->blocks[2] != NULL ||
+			bucket->chain->freeBuckets[2] != NULL)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to empty 'Toy_Bucket' after its blocks were given back\n" TOY_CC_RESET);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
+	//release whole buckets from further along the chain, and reuse blocks from older buckets
+	{
+		//init
+		Toy_Bucket* bucket = Toy_allocateBucket(32);
+
+		void* a = Toy_partitionBucketBlock(&bucket, 16);
+		void* b = Toy_partitionBucketBlock(&bucket, 16);
+		void* c = Toy_partitionBucketBlock(&bucket, 16);
+		void* d = Toy_partitionBucketBlock(&bucket, 16);
+		void* e = Toy_partitionBucketBlock(&bucket, 16); //three buckets, 'e' is in the front
+
+		//empty the middle bucket, which is released
+		Toy_releaseBucketBlock(bucket->next, d, 16);
+		Toy_releaseBucketBlock(bucket->next, c, 16);
+
+		if (
+			bucket->next == NULL ||
+			bucket->next->next != NULL ||
+			bucket->next->prev != bucket ||
+			bucket->next->count != 32)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to release an empty 'Toy_Bucket' from the chain\n" TOY_CC_RESET);
+			return -1;
+		}
+
+		//free a block in the oldest bucket, then grab it again, without walking the chain or moving the bucket
+		Toy_Bucket* front = bucket;
+		Toy_Bucket* oldest = bucket->next;
+		Toy_releaseBucketBlock(oldest, a, 16);
+
+		bool listed = bucket->chain->freeBuckets[1] == oldest;
+
+		void* f = Toy_partitionBucketBlock(&bucket, 8); //the front bucket has space for this one
+		void* g = Toy_partitionBucketBlock(&bucket, 16);
+
+		if (
+			!listed ||
+			f == a ||
+			g != a ||
+			bucket != front ||
+			bucket->chain->freeBuckets[1] != NULL ||
+			bucket->prev != NULL ||
+			bucket->next != oldest ||
+			oldest->prev != bucket ||
+			oldest->next != NULL)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to reuse a block from further along a 'Toy_Bucket' chain\n" TOY_CC_RESET);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
 int main() {
 	//run each test set, returning the total errors given
 	int total = 0, res = 0;
@@ -85,5 +184,14 @@ int main() {
 		}
 	}
 
+	{
+		res = test_bucket_blocks();
+		total += res;
+
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+	}
+
 	return total;
 }
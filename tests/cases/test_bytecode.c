@@ -2,6 +2,7 @@
 #include "toy_console_colors.h"
 
 #include "toy_opcodes.h"
+#include "toy_routine.h"
 #include "toy_lexer.h"
 #include "toy_parser.h"
 
@@ -93,11 +94,13 @@ int test_bytecode_from_source(Toy_Bucket** bucketHandle) {
 
 		int* ptr = (int*)(bc.ptr + offset);
 
-		if ((ptr++)[0] != 72 || //total size
+		if ((ptr++)[0] != (TOY_ROUTINE_SUPERINSTRUCTIONS ? 72 : 80) || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 3) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header within bytecode, source: %s\n" TOY_CC_RESET, source);
 
@@ -107,54 +110,95 @@ int test_bytecode_from_source(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
+#if TOY_ROUTINE_SUPERINSTRUCTIONS
 		if (
 			//left hand side
-			*((unsigned char*)(offset + bc.ptr + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(offset + bc.ptr + 25)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(offset + bc.ptr + 26)) != 0 ||
-			*((unsigned char*)(offset + bc.ptr + 27)) != 0 ||
-			*(int*)(offset + bc.ptr + 28) != 1 ||
+			*((unsigned char*)(offset + bc.ptr + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(offset + bc.ptr + 33)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(offset + bc.ptr + 34)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 35)) != 0 ||
+			*(int*)(offset + bc.ptr + 36) != 1 ||
 
+			*((unsigned char*)(offset + bc.ptr + 40)) != TOY_OPCODE_ARITHMETIC_IMM ||
+			*((unsigned char*)(offset + bc.ptr + 41)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(offset + bc.ptr + 42)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(offset + bc.ptr + 43)) != 0 ||
+			*(int*)(offset + bc.ptr + 44) != 2 ||
+
+			//right hand side
+			*((unsigned char*)(offset + bc.ptr + 48)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(offset + bc.ptr + 49)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(offset + bc.ptr + 50)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 51)) != 0 ||
+			*(int*)(offset + bc.ptr + 52) != 3 ||
+
+			*((unsigned char*)(offset + bc.ptr + 56)) != TOY_OPCODE_ARITHMETIC_IMM ||
+			*((unsigned char*)(offset + bc.ptr + 57)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(offset + bc.ptr + 58)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(offset + bc.ptr + 59)) != 0 ||
+			*(int*)(offset + bc.ptr + 60) != 4 ||
+
+			//multiply the two values
+			*((unsigned char*)(offset + bc.ptr + 64)) != TOY_OPCODE_MULTIPLY ||
+			*((unsigned char*)(offset + bc.ptr + 65)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 66)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 67)) != 0 ||
+
+			*((unsigned char*)(offset + bc.ptr + 68)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(offset + bc.ptr + 69)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 70)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 71)) != 0
+		)
+#else
+		if (
+			//left hand side
 			*((unsigned char*)(offset + bc.ptr + 32)) != TOY_OPCODE_READ ||
 			*((unsigned char*)(offset + bc.ptr + 33)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(offset + bc.ptr + 34)) != 0 ||
 			*((unsigned char*)(offset + bc.ptr + 35)) != 0 ||
-			*(int*)(offset + bc.ptr + 36) != 2 ||
+			*(int*)(offset + bc.ptr + 36) != 1 ||
 
-			*((unsigned char*)(offset + bc.ptr + 40)) != TOY_OPCODE_ADD ||
-			*((unsigned char*)(offset + bc.ptr + 41)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 40)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(offset + bc.ptr + 41)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(offset + bc.ptr + 42)) != 0 ||
 			*((unsigned char*)(offset + bc.ptr + 43)) != 0 ||
+			*(int*)(offset + bc.ptr + 44) != 2 ||
 
-			//right hand side
-			*((unsigned char*)(offset + bc.ptr + 44)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(offset + bc.ptr + 45)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(offset + bc.ptr + 46)) != 0 ||
-			*((unsigned char*)(offset + bc.ptr + 47)) != 0 ||
-			*(int*)(offset + bc.ptr + 48) != 3 ||
+			*((unsigned char*)(offset + bc.ptr + 48)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(offset + bc.ptr + 49)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 50)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 51)) != 0 ||
 
+			//right hand side
 			*((unsigned char*)(offset + bc.ptr + 52)) != TOY_OPCODE_READ ||
 			*((unsigned char*)(offset + bc.ptr + 53)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(offset + bc.ptr + 54)) != 0 ||
 			*((unsigned char*)(offset + bc.ptr + 55)) != 0 ||
-			*(int*)(offset + bc.ptr + 56) != 4 ||
+			*(int*)(offset + bc.ptr + 56) != 3 ||
 
-			*((unsigned char*)(offset + bc.ptr + 60)) != TOY_OPCODE_ADD ||
-			*((unsigned char*)(offset + bc.ptr + 61)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 60)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(offset + bc.ptr + 61)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(offset + bc.ptr + 62)) != 0 ||
 			*((unsigned char*)(offset + bc.ptr + 63)) != 0 ||
+			*(int*)(offset + bc.ptr + 64) != 4 ||
 
-			//multiply the two values
-			*((unsigned char*)(offset + bc.ptr + 64)) != TOY_OPCODE_MULTIPLY ||
-			*((unsigned char*)(offset + bc.ptr + 65)) != 0 ||
-			*((unsigned char*)(offset + bc.ptr + 66)) != 0 ||
-			*((unsigned char*)(offset + bc.ptr + 67)) != 0 ||
-
-			*((unsigned char*)(offset + bc.ptr + 68)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(offset + bc.ptr + 68)) != TOY_OPCODE_ADD ||
 			*((unsigned char*)(offset + bc.ptr + 69)) != 0 ||
 			*((unsigned char*)(offset + bc.ptr + 70)) != 0 ||
-			*((unsigned char*)(offset + bc.ptr + 71)) != 0
+			*((unsigned char*)(offset + bc.ptr + 71)) != 0 ||
+
+			//multiply the two values
+			*((unsigned char*)(offset + bc.ptr + 72)) != TOY_OPCODE_MULTIPLY ||
+			*((unsigned char*)(offset + bc.ptr + 73)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 74)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 75)) != 0 ||
+
+			*((unsigned char*)(offset + bc.ptr + 76)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(offset + bc.ptr + 77)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 78)) != 0 ||
+			*((unsigned char*)(offset + bc.ptr + 79)) != 0
 		)
+#endif
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code within bytecode, source: %s\n" TOY_CC_RESET, source);
 
@@ -0,0 +1,276 @@
+#include "toy_dictionary.h"
+#include "toy_console_colors.h"
+
+#include "toy_bucket.h"
+#include "toy_string.h"
+
+#include <stdio.h>
+
+int test_dictionary_allocation() {
+	//allocate and free a dictionary
+	{
+		//setup
+		Toy_Dictionary* dictionary = Toy_allocateDictionary();
+
+		//check
+		if (dictionary == NULL ||
+			dictionary->capacity != TOY_DICTIONARY_INITIAL_CAPACITY ||
+			dictionary->count != 0 ||
+			dictionary->used != 0 ||
+			dictionary->usable != TOY_DICTIONARY_USABLE(TOY_DICTIONARY_INITIAL_CAPACITY)
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to allocate a dictionary\n" TOY_CC_RESET);
+			Toy_freeDictionary(dictionary);
+			return -1;
+		}
+
+		//free
+		Toy_freeDictionary(dictionary);
+	}
+
+	//the index narrows the entries it points to
+	{
+		if (TOY_DICTIONARY_INDEX_WIDTH(8) != 1 ||
+			TOY_DICTIONARY_INDEX_WIDTH(256) != 1 ||
+			TOY_DICTIONARY_INDEX_WIDTH(512) != 2 ||
+			TOY_DICTIONARY_INDEX_WIDTH(65536) != 2 ||
+			TOY_DICTIONARY_INDEX_WIDTH(131072) != 4 ||
+			TOY_DICTIONARY_INDEX_SIZE(8) % sizeof(Toy_DictionaryEntry*) != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected dictionary index widths\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int test_dictionary_insert_lookup_and_remove() {
+	//insert, lookup, override and remove
+	{
+		//setup
+		Toy_Dictionary* dictionary = Toy_allocateDictionary();
+
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(1), TOY_VALUE_FROM_INTEGER(42));
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(2), TOY_VALUE_FROM_INTEGER(69));
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(1), TOY_VALUE_FROM_INTEGER(8891));
+
+		Toy_Value first = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(1));
+		Toy_Value second = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(2));
+		Toy_Value missing = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(3));
+
+		//check
+		if (dictionary->count != 2 ||
+			dictionary->used != 2 ||
+			!TOY_VALUE_IS_INTEGER(first) || TOY_VALUE_AS_INTEGER(first) != 8891 ||
+			!TOY_VALUE_IS_INTEGER(second) || TOY_VALUE_AS_INTEGER(second) != 69 ||
+			!TOY_VALUE_IS_NULL(missing)
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to insert and lookup in a dictionary\n" TOY_CC_RESET);
+			Toy_freeDictionary(dictionary);
+			return -1;
+		}
+
+		//remove one, and something absent
+		Toy_removeDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(1));
+		Toy_removeDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(3));
+
+		first = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(1));
+		second = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(2));
+
+		if (dictionary->count != 1 ||
+			dictionary->used != 2 ||
+			!TOY_VALUE_IS_NULL(dictionary->entries[0].key) ||
+			!TOY_VALUE_IS_NULL(first) ||
+			!TOY_VALUE_IS_INTEGER(second) || TOY_VALUE_AS_INTEGER(second) != 69
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to remove from a dictionary\n" TOY_CC_RESET);
+			Toy_freeDictionary(dictionary);
+			return -1;
+		}
+
+		//free
+		Toy_freeDictionary(dictionary);
+	}
+
+	return 0;
+}
+
+int test_dictionary_insertion_order() {
+	//entries stay in insertion order through expansions, overrides, removals and compaction
+	{
+		//setup
+		Toy_Dictionary* dictionary = Toy_allocateDictionary();
+
+		for (int i = 0; i < 1000; i++) {
+			Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i * 7), TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		//remove the odd positions, override the multiples of 10, then re-add the first odd key at the end
+		for (int i = 1; i < 1000; i += 2) {
+			Toy_removeDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i * 7));
+		}
+
+		for (int i = 0; i < 1000; i += 10) {
+			Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i * 7), TOY_VALUE_FROM_INTEGER(-i));
+		}
+
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(7), TOY_VALUE_FROM_INTEGER(1));
+
+		//walk the entries
+		int failures = 0;
+		int expected = 0;
+		int last = -1;
+
+		for (unsigned int i = 0; i < dictionary->used; i++) {
+			Toy_DictionaryEntry* entry = &dictionary->entries[i];
+
+			if (TOY_VALUE_IS_NULL(entry->key)) {
+				continue;
+			}
+
+			if (expected < 1000) {
+				failures += TOY_VALUE_AS_INTEGER(entry->key) != expected * 7;
+				failures += TOY_VALUE_AS_INTEGER(entry->value) != (expected % 10 == 0 ? -expected : expected);
+				expected += 2;
+			}
+			else {
+				last = TOY_VALUE_AS_INTEGER(entry->key);
+			}
+		}
+
+		if (failures != 0 ||
+			expected != 1000 ||
+			last != 7 ||
+			dictionary->count != 501 ||
+			(dictionary->capacity & (dictionary->capacity - 1)) != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Dictionary insertion order failed, %d bad entries\n" TOY_CC_RESET, failures);
+			Toy_freeDictionary(dictionary);
+			return -1;
+		}
+
+		//free
+		Toy_freeDictionary(dictionary);
+	}
+
+	//churn keeps the size steady, compacting in place rather than growing without bound
+	{
+		//setup
+		Toy_Dictionary* dictionary = Toy_allocateDictionary();
+
+		for (int i = 0; i < 20; i++) {
+			Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		unsigned int capacity = dictionary->capacity;
+
+		for (int i = 20; i < 10000; i++) {
+			Toy_removeDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i - 20));
+			Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		int failures = 0;
+		for (int i = 9980; i < 10000; i++) {
+			Toy_Value result = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_INTEGER(i));
+			failures += !TOY_VALUE_IS_INTEGER(result) || TOY_VALUE_AS_INTEGER(result) != i;
+		}
+
+		if (failures != 0 ||
+			dictionary->count != 20 ||
+			dictionary->capacity > capacity * 2
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Dictionary churn failed, %d bad lookups, capacity %u\n" TOY_CC_RESET, failures, dictionary->capacity);
+			Toy_freeDictionary(dictionary);
+			return -1;
+		}
+
+		//free
+		Toy_freeDictionary(dictionary);
+	}
+
+	return 0;
+}
+
+int test_dictionary_values() {
+	//string keys, and a dictionary held as a value
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Dictionary* dictionary = Toy_allocateDictionary();
+
+		Toy_String* key = Toy_createString(&bucket, "a key too long to be inline");
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_STRING(key), TOY_VALUE_FROM_INTEGER(42));
+		Toy_insertDictionary(&dictionary, TOY_VALUE_FROM_SHORT_STRING("short", 5), TOY_VALUE_FROM_INTEGER(69));
+
+		Toy_String* lookupKey = Toy_createString(&bucket, "short");
+
+		Toy_Value value = TOY_VALUE_FROM_DICTIONARY(dictionary);
+		Toy_Value result = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_STRING(Toy_createString(&bucket, "a key too long to be inline")));
+		Toy_Value shortResult = Toy_lookupDictionary(&dictionary, TOY_VALUE_FROM_STRING(lookupKey));
+
+		//check
+		if (!TOY_VALUE_IS_DICTIONARY(value) ||
+			TOY_VALUE_AS_DICTIONARY(value) != dictionary ||
+			!TOY_VALUE_IS_INTEGER(result) || TOY_VALUE_AS_INTEGER(result) != 42 ||
+			!TOY_VALUE_IS_INTEGER(shortResult) || TOY_VALUE_AS_INTEGER(shortResult) != 69
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to use a dictionary with string keys, or as a value\n" TOY_CC_RESET);
+			Toy_freeDictionary(dictionary);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//free
+		Toy_freeDictionary(dictionary);
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+int main() {
+	//run each test set, returning the total errors given
+	int total = 0, res = 0;
+
+	{
+		res = test_dictionary_allocation();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_dictionary_insert_lookup_and_remove();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_dictionary_insertion_order();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_dictionary_values();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	return total;
+}
@@ -0,0 +1,176 @@
+#include "toy_hamt.h"
+#include "toy_console_colors.h"
+
+#include <stdio.h>
+
+int test_hamt_insert_and_lookup() {
+	//an empty trie
+	{
+		Toy_HamtNode* root = NULL;
+
+		if (Toy_private_lookupHamtValue(root, TOY_VALUE_FROM_INTEGER(1), Toy_hashValue(TOY_VALUE_FROM_INTEGER(1))) != NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected entry found in an empty hamt\n" TOY_CC_RESET);
+			return -1;
+		}
+
+		Toy_freeHamt(root);
+	}
+
+	//many entries, overriding some
+	{
+		//setup
+		Toy_HamtNode* root = NULL;
+
+		for (int i = 0; i < 5000; i++) {
+			Toy_insertHamt(&root, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i * 2), Toy_hashValue(TOY_VALUE_FROM_INTEGER(i)));
+		}
+
+		for (int i = 0; i < 5000; i += 3) {
+			Toy_insertHamt(&root, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(-i), Toy_hashValue(TOY_VALUE_FROM_INTEGER(i)));
+		}
+
+		//check the state
+		int failures = 0;
+
+		for (int i = 0; i < 5000; i++) {
+			const Toy_Value* result = Toy_private_lookupHamtValue(root, TOY_VALUE_FROM_INTEGER(i), Toy_hashValue(TOY_VALUE_FROM_INTEGER(i)));
+			failures += result == NULL || TOY_VALUE_AS_INTEGER(*result) != (i % 3 == 0 ? -i : i * 2);
+		}
+
+		failures += Toy_private_lookupHamtValue(root, TOY_VALUE_FROM_INTEGER(5000), Toy_hashValue(TOY_VALUE_FROM_INTEGER(5000))) != NULL;
+
+		if (failures != 0 || root->refCount != 1) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Hamt insert and lookup failed, %d bad lookups\n" TOY_CC_RESET, failures);
+			Toy_freeHamt(root);
+			return -1;
+		}
+
+		//free
+		Toy_freeHamt(root);
+	}
+
+	//full hash collisions, and hashes that only differ at the last level
+	{
+		//setup
+		Toy_HamtNode* root = NULL;
+
+		for (int i = 0; i < 10; i++) {
+			Toy_insertHamt(&root, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i), 0x12345678);
+		}
+
+		Toy_insertHamt(&root, TOY_VALUE_FROM_INTEGER(10), TOY_VALUE_FROM_INTEGER(10), 0x12345678 ^ 0x40000000);
+		Toy_insertHamt(&root, TOY_VALUE_FROM_INTEGER(4), TOY_VALUE_FROM_INTEGER(44), 0x12345678);
+
+		//check the state
+		int failures = 0;
+
+		for (int i = 0; i < 10; i++) {
+			const Toy_Value* result = Toy_private_lookupHamtValue(root, TOY_VALUE_FROM_INTEGER(i), 0x12345678);
+			failures += result == NULL || TOY_VALUE_AS_INTEGER(*result) != (i == 4 ? 44 : i);
+		}
+
+		const Toy_Value* last = Toy_private_lookupHamtValue(root, TOY_VALUE_FROM_INTEGER(10), 0x12345678 ^ 0x40000000);
+		failures += last == NULL || TOY_VALUE_AS_INTEGER(*last) != 10;
+		failures += Toy_private_lookupHamtValue(root, TOY_VALUE_FROM_INTEGER(10), 0x12345678) != NULL;
+
+		if (failures != 0) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Hamt collisions failed, %d bad lookups\n" TOY_CC_RESET, failures);
+			Toy_freeHamt(root);
+			return -1;
+		}
+
+		//free
+		Toy_freeHamt(root);
+	}
+
+	return 0;
+}
+
+int test_hamt_persistence() {
+	//copies share everything, until one side changes
+	{
+		//setup
+		Toy_HamtNode* original = NULL;
+
+		for (int i = 0; i < 1000; i++) {
+			Toy_insertHamt(&original, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i), Toy_hashValue(TOY_VALUE_FROM_INTEGER(i)));
+		}
+
+		Toy_HamtNode* copy = Toy_copyHamt(original);
+
+		if (copy != original || original->refCount != 2) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Hamt copy didn't share the root\n" TOY_CC_RESET);
+			Toy_freeHamt(copy);
+			Toy_freeHamt(original);
+			return -1;
+		}
+
+		//change the copy, with overrides and new entries
+		for (int i = 0; i < 1000; i += 7) {
+			Toy_insertHamt(&copy, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(-i), Toy_hashValue(TOY_VALUE_FROM_INTEGER(i)));
+		}
+
+		for (int i = 1000; i < 1100; i++) {
+			Toy_insertHamt(&copy, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i), Toy_hashValue(TOY_VALUE_FROM_INTEGER(i)));
+		}
+
+		//check both sides
+		int failures = 0;
+
+		for (int i = 0; i < 1100; i++) {
+			Toy_Value key = TOY_VALUE_FROM_INTEGER(i);
+			const Toy_Value* before = Toy_private_lookupHamtValue(original, key, Toy_hashValue(key));
+			const Toy_Value* after = Toy_private_lookupHamtValue(copy, key, Toy_hashValue(key));
+
+			if (i < 1000) {
+				failures += before == NULL || TOY_VALUE_AS_INTEGER(*before) != i;
+				failures += after == NULL || TOY_VALUE_AS_INTEGER(*after) != (i % 7 == 0 ? -i : i);
+			}
+			else {
+				failures += before != NULL;
+				failures += after == NULL || TOY_VALUE_AS_INTEGER(*after) != i;
+			}
+		}
+
+		if (failures != 0 ||
+			copy == original ||
+			original->refCount != 1 ||
+			copy->refCount != 1
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Hamt persistence failed, %d bad lookups\n" TOY_CC_RESET, failures);
+			Toy_freeHamt(copy);
+			Toy_freeHamt(original);
+			return -1;
+		}
+
+		//free in either order
+		Toy_freeHamt(original);
+		Toy_freeHamt(copy);
+	}
+
+	return 0;
+}
+
+int main() {
+	//run each test set, returning the total errors given
+	int total = 0, res = 0;
+
+	{
+		res = test_hamt_insert_and_lookup();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_hamt_persistence();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	return total;
+}
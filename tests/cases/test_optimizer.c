@@ -0,0 +1,199 @@
+#include "toy_optimizer.h"
+#include "toy_console_colors.h"
+
+#include "toy_lexer.h"
+#include "toy_parser.h"
+#include "toy_string.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//utils
+Toy_Ast* makeOptimizedAstFromSource(Toy_Bucket** bucketHandle, const char* source) {
+	Toy_Lexer lexer;
+	Toy_bindLexer(&lexer, source);
+
+	Toy_Parser parser;
+	Toy_bindParser(&parser, &lexer);
+
+	Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+	Toy_optimizeAst(bucketHandle, ast);
+
+	return ast;
+}
+
+//tests
+int test_fold_constants(Toy_Bucket** bucketHandle) {
+	//fold arithmetic
+	{
+		Toy_Ast* ast = makeOptimizedAstFromSource(bucketHandle, "print 6 * 7;");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_PRINT ||
+			ast->block.child->print.child == NULL ||
+			ast->block.child->print.child->type != TOY_AST_VALUE ||
+			TOY_VALUE_IS_INTEGER(ast->block.child->print.child->value.value) == false ||
+			TOY_VALUE_AS_INTEGER(ast->block.child->print.child->value.value) != 42)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fold arithmetic\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//fold through groups, coercing to floats
+	{
+		Toy_Ast* ast = makeOptimizedAstFromSource(bucketHandle, "(1 + 2) * (3 + 0.5);");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_VALUE ||
+			TOY_VALUE_IS_FLOAT(ast->block.child->value.value) == false ||
+			TOY_VALUE_AS_FLOAT(ast->block.child->value.value) != 10.5f)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fold grouped arithmetic\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//fold comparisons and negation
+	{
+		Toy_Ast* ast = makeOptimizedAstFromSource(bucketHandle, "!(1 < 2) == (3 != 3);");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_VALUE ||
+			TOY_VALUE_IS_BOOLEAN(ast->block.child->value.value) == false ||
+			TOY_VALUE_AS_BOOLEAN(ast->block.child->value.value) != true)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fold comparisons and negation\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//fold string concatenation
+	{
+		Toy_Ast* ast = makeOptimizedAstFromSource(bucketHandle, "\"Hello\" .. \" \" .. \"world\";");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_VALUE ||
+			TOY_VALUE_IS_STRING(ast->block.child->value.value) == false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fold string concatenation\n" TOY_CC_RESET);
+			return -1;
+		}
+
+		char* buffer = Toy_getStringRawBuffer(TOY_VALUE_AS_STRING(ast->block.child->value.value));
+
+		if (strcmp(buffer, "Hello world") != 0) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fold string concatenation, found '%s'\n" TOY_CC_RESET, buffer);
+			free(buffer);
+			return -1;
+		}
+
+		free(buffer);
+	}
+
+	return 0;
+}
+
+int test_fold_skipped(Toy_Bucket** bucketHandle) {
+	//leave runtime errors for the VM to report
+	{
+		Toy_Ast* ast = makeOptimizedAstFromSource(bucketHandle, "1 / 0;");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_BINARY ||
+			ast->block.child->binary.flag != TOY_AST_FLAG_DIVIDE)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: folded a division by zero\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//variables aren't constants, but the constant parts around them still fold
+	{
+		Toy_Ast* ast = makeOptimizedAstFromSource(bucketHandle, "var answer = foobar + (2 * 3);");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_VAR_DECLARE ||
+			ast->block.child->varDeclare.expr->type != TOY_AST_BINARY ||
+			ast->block.child->varDeclare.expr->binary.left->type != TOY_AST_VAR_ACCESS ||
+			ast->block.child->varDeclare.expr->binary.right->type != TOY_AST_VALUE ||
+			TOY_VALUE_AS_INTEGER(ast->block.child->varDeclare.expr->binary.right->value.value) != 6)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fold around a variable\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//assignments keep their target
+	{
+		Toy_Ast* ast = makeOptimizedAstFromSource(bucketHandle, "{ var a = 1; a += (2 + 3); }");
+
+		Toy_Ast* assign = ast->block.child->scope.child->block.next->block.child;
+
+		//check if it worked
+		if (
+			assign->type != TOY_AST_BINARY ||
+			assign->binary.flag != TOY_AST_FLAG_ADD_ASSIGN ||
+			assign->binary.left->type != TOY_AST_VAR_ACCESS ||
+			assign->binary.right->type != TOY_AST_VALUE ||
+			TOY_VALUE_AS_INTEGER(assign->binary.right->value.value) != 5)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fold an assignment\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int main() {
+	//run each test set, returning the total errors given
+	int total = 0, res = 0;
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_fold_constants(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_fold_skipped(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	return total;
+}
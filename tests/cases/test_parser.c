@@ -358,9 +358,9 @@ int test_binary(Toy_Bucket** bucketHandle) {
 		}
 	}
 
-	//test binary assign (using numbers for now, as identifiers aren't coded yet)
+	//test binary assign
 	{
-		Toy_Ast* ast = makeAstFromSource(bucketHandle, "1 = 2;");
+		Toy_Ast* ast = makeAstFromSource(bucketHandle, "foobar = 2;");
 
 		//check if it worked
 		if (
@@ -371,16 +371,15 @@ int test_binary(Toy_Bucket** bucketHandle) {
 			ast->block.child->binary.flag != TOY_AST_FLAG_ASSIGN ||
 
 			ast->block.child->binary.left == NULL ||
-			ast->block.child->binary.left->type != TOY_AST_VALUE ||
-			TOY_VALUE_IS_INTEGER(ast->block.child->binary.left->value.value) == false ||
-			TOY_VALUE_AS_INTEGER(ast->block.child->binary.left->value.value) != 1 ||
+			ast->block.child->binary.left->type != TOY_AST_VAR_ACCESS ||
+			strcmp(ast->block.child->binary.left->varAccess.name->as.name.data, "foobar") != 0 ||
 
 			ast->block.child->binary.right == NULL ||
 			ast->block.child->binary.right->type != TOY_AST_VALUE ||
 			TOY_VALUE_IS_INTEGER(ast->block.child->binary.right->value.value) == false ||
 			TOY_VALUE_AS_INTEGER(ast->block.child->binary.right->value.value) != 2)
 		{
-			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to run the parser with binary assign '1 = 2'\n" TOY_CC_RESET);
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to run the parser with binary assign 'foobar = 2'\n" TOY_CC_RESET);
 			return -1;
 		}
 	}
@@ -560,6 +559,79 @@ int test_precedence(Toy_Bucket** bucketHandle) {
 	return 0;
 }
 
+int test_variables(Toy_Bucket** bucketHandle) {
+	//test variable access
+	{
+		Toy_Ast* ast = makeAstFromSource(bucketHandle, "foobar;");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_VAR_ACCESS ||
+			ast->block.child->varAccess.name == NULL ||
+			strcmp(ast->block.child->varAccess.name->as.name.data, "foobar") != 0)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to run the parser with variable access 'foobar'\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//test compound assignment
+	{
+		Toy_Ast* ast = makeAstFromSource(bucketHandle, "foobar += 42;");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_BINARY ||
+			ast->block.child->binary.flag != TOY_AST_FLAG_ADD_ASSIGN ||
+
+			ast->block.child->binary.left == NULL ||
+			ast->block.child->binary.left->type != TOY_AST_VAR_ACCESS ||
+			strcmp(ast->block.child->binary.left->varAccess.name->as.name.data, "foobar") != 0 ||
+
+			ast->block.child->binary.right == NULL ||
+			ast->block.child->binary.right->type != TOY_AST_VALUE ||
+			TOY_VALUE_AS_INTEGER(ast->block.child->binary.right->value.value) != 42)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to run the parser with compound assignment 'foobar += 42'\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//test a block with a local variable
+	{
+		Toy_Ast* ast = makeAstFromSource(bucketHandle, "{ var foobar = 42; print foobar; }");
+
+		//check if it worked
+		if (
+			ast == NULL ||
+			ast->type != TOY_AST_BLOCK ||
+			ast->block.child == NULL ||
+			ast->block.child->type != TOY_AST_SCOPE ||
+
+			ast->block.child->scope.child == NULL ||
+			ast->block.child->scope.child->type != TOY_AST_BLOCK ||
+			ast->block.child->scope.child->block.child == NULL ||
+			ast->block.child->scope.child->block.child->type != TOY_AST_VAR_DECLARE ||
+
+			ast->block.child->scope.child->block.next == NULL ||
+			ast->block.child->scope.child->block.next->block.child == NULL ||
+			ast->block.child->scope.child->block.next->block.child->type != TOY_AST_PRINT ||
+			ast->block.child->scope.child->block.next->block.child->print.child->type != TOY_AST_VAR_ACCESS)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to run the parser with a block '{ var foobar = 42; print foobar; }'\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 int main() {
 	//run each test set, returning the total errors given
 	int total = 0, res = 0;
@@ -624,5 +696,15 @@ int main() {
 		total += res;
 	}
 
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_variables(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
 	return total;
 }
@@ -24,11 +24,13 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 28 || //total size
+		if ((ptr++)[0] != 36 || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 0) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, ast: PASS\n" TOY_CC_RESET);
 
@@ -38,10 +40,10 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 25)) != 0 ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 33)) != 0 ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0
 		)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, ast: PASS\n" TOY_CC_RESET);
@@ -73,11 +75,13 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 28 || //total size
+		if ((ptr++)[0] != 36 || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 0) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -87,10 +91,10 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 25)) != 0 ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 33)) != 0 ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0
 		)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
@@ -122,11 +126,13 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 32 || //total size
+		if ((ptr++)[0] != 40 || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 1) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -136,14 +142,14 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_NULL ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*((unsigned char*)(buffer + 28)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 29)) != 0 ||
-			*((unsigned char*)(buffer + 30)) != 0 ||
-			*((unsigned char*)(buffer + 31)) != 0
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_NULL ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*((unsigned char*)(buffer + 36)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 37)) != 0 ||
+			*((unsigned char*)(buffer + 38)) != 0 ||
+			*((unsigned char*)(buffer + 39)) != 0
 		)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
@@ -175,11 +181,13 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 32 || //total size
+		if ((ptr++)[0] != 40 || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 1) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -189,14 +197,14 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_BOOLEAN ||
-			*((unsigned char*)(buffer + 26)) != 1 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*((unsigned char*)(buffer + 28)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 29)) != 0 ||
-			*((unsigned char*)(buffer + 30)) != 0 ||
-			*((unsigned char*)(buffer + 31)) != 0
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_BOOLEAN ||
+			*((unsigned char*)(buffer + 34)) != 1 ||
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*((unsigned char*)(buffer + 36)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 37)) != 0 ||
+			*((unsigned char*)(buffer + 38)) != 0 ||
+			*((unsigned char*)(buffer + 39)) != 0
 		)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
@@ -228,11 +236,13 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 36 || //total size
+		if ((ptr++)[0] != 44 || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 1) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -242,15 +252,15 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*(int*)(buffer + 28) != 42 ||
-			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 33)) != 0 ||
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 34)) != 0 ||
-			*((unsigned char*)(buffer + 35)) != 0
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*(int*)(buffer + 36) != 42 ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 41)) != 0 ||
+			*((unsigned char*)(buffer + 42)) != 0 ||
+			*((unsigned char*)(buffer + 43)) != 0
 		)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
@@ -282,11 +292,13 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 36 || //total size
+		if ((ptr++)[0] != 44 || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 1) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -296,15 +308,15 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_FLOAT ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*(float*)(buffer + 28) != 3.1415f ||
-			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 33)) != 0 ||
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_FLOAT ||
 			*((unsigned char*)(buffer + 34)) != 0 ||
-			*((unsigned char*)(buffer + 35)) != 0
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*(float*)(buffer + 36) != 3.1415f ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 41)) != 0 ||
+			*((unsigned char*)(buffer + 42)) != 0 ||
+			*((unsigned char*)(buffer + 43)) != 0
 		)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
@@ -336,16 +348,18 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check header
 		int* header = (int*)buffer;
 
-		if (header[0] != 64 || //total size
+		if (header[0] != 72 + TOY_ROUTINE_DATA_HASHES * 8 || //total size
 			header[1] != 0 || //param size
 			header[2] != 4 || //jumps size
-			header[3] != 16 || //data size
+			header[3] != 16 + TOY_ROUTINE_DATA_HASHES * 8 || //data size (the length and hash come first)
 			header[4] != 0 || //subs size
+			header[5] != TOY_BACKEND_STACK || //backend
+			header[6] != 1 || //frame size
 
 			// header[??] != ?? || //params address
-			header[5] != 32 || //code address
-			header[6] != 44 || //jumps address
-			header[7] != 48 || //data address
+			header[7] != 40 || //code address
+			header[8] != 52 || //jumps address
+			header[9] != 56 || //data address
 			// header[??] != ?? || //subs address
 
 			false)
@@ -357,7 +371,7 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 			return -1;
 		}
 
-		void* code = buffer + 32; //8 values in the header, each 4 bytes
+		void* code = buffer + 40; //10 values in the header, each 4 bytes
 
 		//check code
 		if (
@@ -386,7 +400,7 @@ int test_routine_expressions(Toy_Bucket** bucketHandle) {
 		//check jumps
 		if (
 			//code start
-			*(unsigned int*)(jumps + 0) != 0 || //the address relative to the start of the data section
+			*(unsigned int*)(jumps + 0) != TOY_ROUTINE_DATA_HASHES * 8 || //the address relative to the start of the data section
 
 			false)
 		{
@@ -443,11 +457,13 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 48 || //total size
+		if ((ptr++)[0] != (TOY_ROUTINE_SUPERINSTRUCTIONS ? 52 : 56) || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 2) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -457,28 +473,48 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*(int*)(buffer + 28) != 3 ||
+#if TOY_ROUTINE_SUPERINSTRUCTIONS
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*(int*)(buffer + 36) != 3 ||
 
-			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_ARITHMETIC_IMM ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 42)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(buffer + 43)) != 0 ||
+			*(int*)(buffer + 44) != 5 ||
+
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 49)) != 0 ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0
+		)
+#else
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
 			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 34)) != 0 ||
 			*((unsigned char*)(buffer + 35)) != 0 ||
-			*(int*)(buffer + 36) != 5 ||
+			*(int*)(buffer + 36) != 3 ||
 
-			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_ADD ||
-			*((unsigned char*)(buffer + 41)) != 0 ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 42)) != 0 ||
 			*((unsigned char*)(buffer + 43)) != 0 ||
+			*(int*)(buffer + 44) != 5 ||
 
-			*((unsigned char*)(buffer + 44)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 45)) != 0 ||
-			*((unsigned char*)(buffer + 46)) != 0 ||
-			*((unsigned char*)(buffer + 47)) != 0
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(buffer + 49)) != 0 ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0 ||
+
+			*((unsigned char*)(buffer + 52)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 53)) != 0 ||
+			*((unsigned char*)(buffer + 54)) != 0 ||
+			*((unsigned char*)(buffer + 55)) != 0
 		)
+#endif
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
 
@@ -509,11 +545,13 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 48 || //total size
+		if ((ptr++)[0] != (TOY_ROUTINE_SUPERINSTRUCTIONS ? 52 : 56) || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 2) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -523,28 +561,48 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*(int*)(buffer + 28) != 3 ||
+#if TOY_ROUTINE_SUPERINSTRUCTIONS
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*(int*)(buffer + 36) != 3 ||
 
-			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_COMPARE_IMM ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 42)) != TOY_OPCODE_COMPARE_EQUAL ||
+			*((unsigned char*)(buffer + 43)) != 0 ||
+			*(int*)(buffer + 44) != 5 ||
+
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 49)) != 0 ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0
+		)
+#else
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
 			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 34)) != 0 ||
 			*((unsigned char*)(buffer + 35)) != 0 ||
-			*(int*)(buffer + 36) != 5 ||
+			*(int*)(buffer + 36) != 3 ||
 
-			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_COMPARE_EQUAL ||
-			*((unsigned char*)(buffer + 41)) != 0 ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 42)) != 0 ||
 			*((unsigned char*)(buffer + 43)) != 0 ||
+			*(int*)(buffer + 44) != 5 ||
 
-			*((unsigned char*)(buffer + 44)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 45)) != 0 ||
-			*((unsigned char*)(buffer + 46)) != 0 ||
-			*((unsigned char*)(buffer + 47)) != 0
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_COMPARE_EQUAL ||
+			*((unsigned char*)(buffer + 49)) != 0 ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0 ||
+
+			*((unsigned char*)(buffer + 52)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 53)) != 0 ||
+			*((unsigned char*)(buffer + 54)) != 0 ||
+			*((unsigned char*)(buffer + 55)) != 0
 		)
+#endif
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
 
@@ -575,11 +633,13 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 48 || //total size
+		if ((ptr++)[0] != (TOY_ROUTINE_SUPERINSTRUCTIONS ? 52 : 56) || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 2) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -589,28 +649,48 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*(int*)(buffer + 28) != 3 ||
-
-			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+#if TOY_ROUTINE_SUPERINSTRUCTIONS
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*(int*)(buffer + 36) != 3 ||
+
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_COMPARE_IMM ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 42)) != TOY_OPCODE_COMPARE_EQUAL ||
+			*((unsigned char*)(buffer + 43)) != TOY_OPCODE_NEGATE ||
+			*(int*)(buffer + 44) != 5 ||
+
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 49)) != 0 ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0
+		)
+#else
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
 			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 34)) != 0 ||
 			*((unsigned char*)(buffer + 35)) != 0 ||
-			*(int*)(buffer + 36) != 5 ||
+			*(int*)(buffer + 36) != 3 ||
 
-			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_COMPARE_EQUAL ||
-			*((unsigned char*)(buffer + 41)) != TOY_OPCODE_NEGATE ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 42)) != 0 ||
 			*((unsigned char*)(buffer + 43)) != 0 ||
+			*(int*)(buffer + 44) != 5 ||
 
-			*((unsigned char*)(buffer + 44)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 45)) != 0 ||
-			*((unsigned char*)(buffer + 46)) != 0 ||
-			*((unsigned char*)(buffer + 47)) != 0
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_COMPARE_EQUAL ||
+			*((unsigned char*)(buffer + 49)) != TOY_OPCODE_NEGATE ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0 ||
+
+			*((unsigned char*)(buffer + 52)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 53)) != 0 ||
+			*((unsigned char*)(buffer + 54)) != 0 ||
+			*((unsigned char*)(buffer + 55)) != 0
 		)
+#endif
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
 
@@ -641,11 +721,13 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 72 || //total size
+		if ((ptr++)[0] != (TOY_ROUTINE_SUPERINSTRUCTIONS ? 72 : 80) || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 3) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -655,54 +737,95 @@ int test_routine_binary(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
+#if TOY_ROUTINE_SUPERINSTRUCTIONS
 		if (
 			//left hand side
-			*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*(int*)(buffer + 28) != 1 ||
+			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*(int*)(buffer + 36) != 1 ||
 
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_ARITHMETIC_IMM ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 42)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(buffer + 43)) != 0 ||
+			*(int*)(buffer + 44) != 2 ||
+
+			//right hand side
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 49)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0 ||
+			*(int*)(buffer + 52) != 3 ||
+
+			*((unsigned char*)(buffer + 56)) != TOY_OPCODE_ARITHMETIC_IMM ||
+			*((unsigned char*)(buffer + 57)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 58)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(buffer + 59)) != 0 ||
+			*(int*)(buffer + 60) != 4 ||
+
+			//multiply the two values
+			*((unsigned char*)(buffer + 64)) != TOY_OPCODE_MULTIPLY ||
+			*((unsigned char*)(buffer + 65)) != 0 ||
+			*((unsigned char*)(buffer + 66)) != 0 ||
+			*((unsigned char*)(buffer + 67)) != 0 ||
+
+			*((unsigned char*)(buffer + 68)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 69)) != 0 ||
+			*((unsigned char*)(buffer + 70)) != 0 ||
+			*((unsigned char*)(buffer + 71)) != 0
+		)
+#else
+		if (
+			//left hand side
 			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
 			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 34)) != 0 ||
 			*((unsigned char*)(buffer + 35)) != 0 ||
-			*(int*)(buffer + 36) != 2 ||
+			*(int*)(buffer + 36) != 1 ||
 
-			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_ADD ||
-			*((unsigned char*)(buffer + 41)) != 0 ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 41)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 42)) != 0 ||
 			*((unsigned char*)(buffer + 43)) != 0 ||
+			*(int*)(buffer + 44) != 2 ||
 
-			//right hand side
-			*((unsigned char*)(buffer + 44)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 45)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(buffer + 46)) != 0 ||
-			*((unsigned char*)(buffer + 47)) != 0 ||
-			*(int*)(buffer + 48) != 3 ||
+			*((unsigned char*)(buffer + 48)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(buffer + 49)) != 0 ||
+			*((unsigned char*)(buffer + 50)) != 0 ||
+			*((unsigned char*)(buffer + 51)) != 0 ||
 
+			//right hand side
 			*((unsigned char*)(buffer + 52)) != TOY_OPCODE_READ ||
 			*((unsigned char*)(buffer + 53)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 54)) != 0 ||
 			*((unsigned char*)(buffer + 55)) != 0 ||
-			*(int*)(buffer + 56) != 4 ||
+			*(int*)(buffer + 56) != 3 ||
 
-			*((unsigned char*)(buffer + 60)) != TOY_OPCODE_ADD ||
-			*((unsigned char*)(buffer + 61)) != 0 ||
+			*((unsigned char*)(buffer + 60)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 61)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 62)) != 0 ||
 			*((unsigned char*)(buffer + 63)) != 0 ||
+			*(int*)(buffer + 64) != 4 ||
 
-			//multiply the two values
-			*((unsigned char*)(buffer + 64)) != TOY_OPCODE_MULTIPLY ||
-			*((unsigned char*)(buffer + 65)) != 0 ||
-			*((unsigned char*)(buffer + 66)) != 0 ||
-			*((unsigned char*)(buffer + 67)) != 0 ||
-
-			*((unsigned char*)(buffer + 68)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 68)) != TOY_OPCODE_ADD ||
 			*((unsigned char*)(buffer + 69)) != 0 ||
 			*((unsigned char*)(buffer + 70)) != 0 ||
-			*((unsigned char*)(buffer + 71)) != 0
+			*((unsigned char*)(buffer + 71)) != 0 ||
+
+			//multiply the two values
+			*((unsigned char*)(buffer + 72)) != TOY_OPCODE_MULTIPLY ||
+			*((unsigned char*)(buffer + 73)) != 0 ||
+			*((unsigned char*)(buffer + 74)) != 0 ||
+			*((unsigned char*)(buffer + 75)) != 0 ||
+
+			*((unsigned char*)(buffer + 76)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 77)) != 0 ||
+			*((unsigned char*)(buffer + 78)) != 0 ||
+			*((unsigned char*)(buffer + 79)) != 0
 		)
+#endif
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
 
@@ -737,11 +860,13 @@ int test_routine_keywords(Toy_Bucket** bucketHandle) {
 		//check header
 		int* ptr = (int*)buffer;
 
-		if ((ptr++)[0] != 40 || //total size
+		if ((ptr++)[0] != (TOY_ROUTINE_SUPERINSTRUCTIONS ? 44 : 48) || //total size
 			(ptr++)[0] != 0 || //param count
 			(ptr++)[0] != 0 || //jump count
 			(ptr++)[0] != 0 || //data count
-			(ptr++)[0] != 0) //subs count
+			(ptr++)[0] != 0 || //subs count
+			(ptr++)[0] != TOY_BACKEND_STACK || //backend
+			(ptr++)[0] != 1) //frame size
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
 
@@ -751,20 +876,33 @@ int test_routine_keywords(Toy_Bucket** bucketHandle) {
 		}
 
 		//check code
-		if (*((unsigned char*)(buffer + 24)) != TOY_OPCODE_READ ||
-			*((unsigned char*)(buffer + 25)) != TOY_VALUE_INTEGER ||
-			*((unsigned char*)(buffer + 26)) != 0 ||
-			*((unsigned char*)(buffer + 27)) != 0 ||
-			*(int*)(buffer + 28) != 42 ||
-			*((unsigned char*)(buffer + 32)) != TOY_OPCODE_PRINT ||
-			*((unsigned char*)(buffer + 33)) != 0 ||
+#if TOY_ROUTINE_SUPERINSTRUCTIONS
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_PRINT_IMM ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
 			*((unsigned char*)(buffer + 34)) != 0 ||
 			*((unsigned char*)(buffer + 35)) != 0 ||
-			*((unsigned char*)(buffer + 36)) != TOY_OPCODE_RETURN ||
-			*((unsigned char*)(buffer + 37)) != 0 ||
-			*((unsigned char*)(buffer + 38)) != 0 ||
-			*((unsigned char*)(buffer + 39)) != 0
+			*(int*)(buffer + 36) != 42 ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 41)) != 0 ||
+			*((unsigned char*)(buffer + 42)) != 0 ||
+			*((unsigned char*)(buffer + 43)) != 0
+		)
+#else
+		if (*((unsigned char*)(buffer + 32)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(buffer + 33)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(buffer + 34)) != 0 ||
+			*((unsigned char*)(buffer + 35)) != 0 ||
+			*(int*)(buffer + 36) != 42 ||
+			*((unsigned char*)(buffer + 40)) != TOY_OPCODE_PRINT ||
+			*((unsigned char*)(buffer + 41)) != 0 ||
+			*((unsigned char*)(buffer + 42)) != 0 ||
+			*((unsigned char*)(buffer + 43)) != 0 ||
+			*((unsigned char*)(buffer + 44)) != TOY_OPCODE_RETURN ||
+			*((unsigned char*)(buffer + 45)) != 0 ||
+			*((unsigned char*)(buffer + 46)) != 0 ||
+			*((unsigned char*)(buffer + 47)) != 0
 		)
+#endif
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
 
@@ -795,16 +933,18 @@ int test_routine_keywords(Toy_Bucket** bucketHandle) {
 		//check header
 		int* header = (int*)buffer;
 
-		if (header[0] != 64 || //total size
+		if (header[0] != 72 + TOY_ROUTINE_DATA_HASHES * 8 || //total size
 			header[1] != 0 || //param size
 			header[2] != 4 || //jumps size
-			header[3] != 8 || //data size
+			header[3] != 8 + TOY_ROUTINE_DATA_HASHES * 8 || //data size (the length and hash come first)
 			header[4] != 0 || //subs size
+			header[5] != TOY_BACKEND_STACK || //backend
+			header[6] != 1 || //frame size
 
 			// header[??] != ?? || //params address
-			header[5] != 32 || //code address
-			header[6] != 52 || //jumps address
-			header[7] != 56 || //data address
+			header[7] != 40 || //code address
+			header[8] != 60 || //jumps address
+			header[9] != 64 || //data address
 			// header[??] != ?? || //subs address
 
 			false)
@@ -816,7 +956,7 @@ int test_routine_keywords(Toy_Bucket** bucketHandle) {
 			return -1;
 		}
 
-		void* code = buffer + 32; //8 values in the header, each 4 bytes
+		void* code = buffer + 40; //10 values in the header, each 4 bytes
 
 		//check code
 		if (
@@ -854,7 +994,7 @@ int test_routine_keywords(Toy_Bucket** bucketHandle) {
 		//check jumps
 		if (
 			//code start
-			*(unsigned int*)(jumps + 0) != 0 || //the address relative to the start of the data section
+			*(unsigned int*)(jumps + 0) != TOY_ROUTINE_DATA_HASHES * 8 || //the address relative to the start of the data section
 
 			false)
 		{
@@ -881,6 +1021,355 @@ int test_routine_keywords(Toy_Bucket** bucketHandle) {
 			return -1;
 		}
 
+#if TOY_ROUTINE_DATA_HASHES
+		//check the name's length and hash, which match what the string itself would calculate
+		Toy_String* name = Toy_createString(bucketHandle, "foobar");
+		Toy_hashString(name);
+
+		unsigned int* prefix = (unsigned int*)(data + ((unsigned int*)jumps)[0]) - 2;
+
+		if (prefix[0] != 6 || prefix[1] != name->cachedHash) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine data prefix, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			Toy_freeString(name);
+			free(buffer);
+			return -1;
+		}
+
+		Toy_freeString(name);
+#endif
+
+		//cleanup
+		free(buffer);
+	}
+
+	return 0;
+}
+
+int test_routine_variables(Toy_Bucket** bucketHandle) {
+	//block-level variables are resolved to slots
+	{
+		//setup
+		const char* source = "{ var foobar = 42; print foobar; foobar = 1; }";
+		Toy_Lexer lexer;
+		Toy_Parser parser;
+
+		Toy_bindLexer(&lexer, source);
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		//run
+		void* buffer = Toy_compileRoutine(ast);
+
+		//check header
+		int* header = (int*)buffer;
+
+		if (header[0] != 68 || //total size
+			header[1] != 0 || //param size
+			header[2] != 0 || //jumps size
+			header[3] != 0 || //data size
+			header[4] != 0 || //subs size
+			header[5] != TOY_BACKEND_STACK || //backend
+			header[6] != 1 || //frame size
+
+			header[7] != 32 || //code address
+
+			false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
+		void* code = buffer + 32; //8 values in the header, each 4 bytes
+
+		//check code
+		if (
+			//code start
+			*((unsigned char*)(code + 0)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(code + 1)) != TOY_VALUE_INTEGER ||
+			*(int*)(code + 4) != 42 ||
+
+			*((unsigned char*)(code + 8)) != TOY_OPCODE_DECLARE_SLOT ||
+			*((unsigned char*)(code + 9)) != TOY_VALUE_NULL ||
+			*(unsigned short*)(code + 10) != 0 || //the slot
+
+			*((unsigned char*)(code + 12)) != TOY_OPCODE_ACCESS_SLOT ||
+			*(unsigned short*)(code + 14) != 0 ||
+
+			*((unsigned char*)(code + 16)) != TOY_OPCODE_PRINT ||
+
+			*((unsigned char*)(code + 20)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(code + 21)) != TOY_VALUE_INTEGER ||
+			*(int*)(code + 24) != 1 ||
+
+			*((unsigned char*)(code + 28)) != TOY_OPCODE_ASSIGN_SLOT ||
+			*(unsigned short*)(code + 30) != 0 ||
+
+			*((unsigned char*)(code + 32)) != TOY_OPCODE_RETURN ||
+
+			false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
+		//cleanup
+		free(buffer);
+	}
+
+	//shadowed and sibling locals
+	{
+		//setup
+		const char* source = "{ var a = 1; { var a = 2; var b = a; } { var c = a; } }";
+		Toy_Lexer lexer;
+		Toy_Parser parser;
+
+		Toy_bindLexer(&lexer, source);
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		//run
+		void* buffer = Toy_compileRoutine(ast);
+
+		void* code = buffer + 32; //8 values in the header, each 4 bytes
+
+		//check code
+		if (
+			*((unsigned char*)(code + 8)) != TOY_OPCODE_DECLARE_SLOT ||
+			*(unsigned short*)(code + 10) != 0 || //outer 'a'
+
+			*((unsigned char*)(code + 20)) != TOY_OPCODE_DECLARE_SLOT ||
+			*(unsigned short*)(code + 22) != 1 || //inner 'a'
+
+			*((unsigned char*)(code + 24)) != TOY_OPCODE_ACCESS_SLOT ||
+			*(unsigned short*)(code + 26) != 1 || //reads the inner 'a'
+
+			*((unsigned char*)(code + 28)) != TOY_OPCODE_DECLARE_SLOT ||
+			*(unsigned short*)(code + 30) != 2 || //'b'
+
+			*((unsigned char*)(code + 32)) != TOY_OPCODE_ACCESS_SLOT ||
+			*(unsigned short*)(code + 34) != 0 || //reads the outer 'a'
+
+			*((unsigned char*)(code + 36)) != TOY_OPCODE_DECLARE_SLOT ||
+			*(unsigned short*)(code + 38) != 1 || //'c' reuses the sibling's slot
+
+			*((unsigned char*)(code + 40)) != TOY_OPCODE_RETURN ||
+
+			false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
+		//cleanup
+		free(buffer);
+	}
+
+	//globals are still accessed by name
+	{
+		//setup
+		const char* source = "foobar;";
+		Toy_Lexer lexer;
+		Toy_Parser parser;
+
+		Toy_bindLexer(&lexer, source);
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		//run
+		void* buffer = Toy_compileRoutine(ast);
+
+		void* code = buffer + 40; //10 values in the header, each 4 bytes
+
+		//check code
+		if (
+			*((unsigned char*)(code + 0)) != TOY_OPCODE_ACCESS ||
+			*((unsigned char*)(code + 2)) != 6 || //strlen
+			*(unsigned int*)(code + 4) != 0 || //the jump index
+
+			*((unsigned char*)(code + 8)) != TOY_OPCODE_RETURN ||
+
+			false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
+		//cleanup
+		free(buffer);
+	}
+
+	//the peephole pass merges and drops redundant logical words
+	{
+		//setup
+		const char* source = "!(foobar == foobar); !!foobar; !!(foobar < foobar);";
+		Toy_Lexer lexer;
+		Toy_Parser parser;
+
+		Toy_bindLexer(&lexer, source);
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		//run
+		void* buffer = Toy_compileRoutine(ast);
+
+		void* code = buffer + 40; //10 values in the header, each 4 bytes
+
+		//check code
+		if (
+			//!(foobar == foobar)
+			*((unsigned char*)(code + 0)) != TOY_OPCODE_ACCESS ||
+			*((unsigned char*)(code + 8)) != TOY_OPCODE_ACCESS ||
+			*((unsigned char*)(code + 16)) != TOY_OPCODE_COMPARE_EQUAL ||
+			*((unsigned char*)(code + 17)) != TOY_OPCODE_NEGATE ||
+
+			//!!foobar
+			*((unsigned char*)(code + 20)) != TOY_OPCODE_ACCESS ||
+			*((unsigned char*)(code + 28)) != TOY_OPCODE_TRUTHY ||
+
+			//!!(foobar < foobar)
+			*((unsigned char*)(code + 32)) != TOY_OPCODE_ACCESS ||
+			*((unsigned char*)(code + 40)) != TOY_OPCODE_ACCESS ||
+			*((unsigned char*)(code + 48)) != TOY_OPCODE_COMPARE_LESS ||
+
+			*((unsigned char*)(code + 52)) != TOY_OPCODE_RETURN ||
+
+			false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
+		//cleanup
+		free(buffer);
+	}
+
+	return 0;
+}
+
+int test_routine_registers(Toy_Bucket** bucketHandle) {
+	//three-address instructions, with locals in the lowest registers
+	{
+		//setup
+		const char* source = "{ var a = 1; var b = a + 2; print b; }";
+		Toy_Lexer lexer;
+		Toy_Parser parser;
+
+		Toy_bindLexer(&lexer, source);
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		//run
+		void* buffer = Toy_compileRoutineWithBackend(ast, TOY_BACKEND_REGISTER);
+
+		//check header
+		int* header = (int*)buffer;
+
+		if (header[0] != 60 || //total size
+			header[1] != 0 || //param size
+			header[2] != 0 || //jumps size
+			header[3] != 0 || //data size
+			header[4] != 0 || //subs size
+			header[5] != TOY_BACKEND_REGISTER || //backend
+			header[6] != 2 || //frame size
+			header[7] != 32 || //code address
+			false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine header, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
+		void* code = buffer + 32; //8 values in the header, each 4 bytes
+
+		//check code
+		if (
+			//var a = 1, read straight into a's register
+			*((unsigned char*)(code + 0)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(code + 1)) != TOY_VALUE_INTEGER ||
+			*((unsigned char*)(code + 2)) != 0 ||
+			*(int*)(code + 4) != 1 ||
+
+			//2 into a temporary
+			*((unsigned char*)(code + 8)) != TOY_OPCODE_READ ||
+			*((unsigned char*)(code + 10)) != 1 ||
+			*(int*)(code + 12) != 2 ||
+
+			//var b = a + 2, overwriting the temporary
+			*((unsigned char*)(code + 16)) != TOY_OPCODE_ADD ||
+			*((unsigned char*)(code + 17)) != 1 ||
+			*((unsigned char*)(code + 18)) != 0 ||
+			*((unsigned char*)(code + 19)) != 1 ||
+
+			//print b
+			*((unsigned char*)(code + 20)) != TOY_OPCODE_PRINT ||
+			*((unsigned char*)(code + 21)) != 1 ||
+
+			*((unsigned char*)(code + 24)) != TOY_OPCODE_RETURN ||
+
+			false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to produce the expected routine code, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
+		//cleanup
+		free(buffer);
+	}
+
+	//too many registers falls back to the stack backend
+	{
+		//setup
+		char source[TOY_ROUTINE_MAX_REGISTERS * 16 + 16] = "{";
+		for (int i = 0; i <= TOY_ROUTINE_MAX_REGISTERS; i++) {
+			sprintf(source + strlen(source), " var v%d = %d;", i, i);
+		}
+		strcat(source, " }");
+
+		Toy_Lexer lexer;
+		Toy_Parser parser;
+
+		Toy_bindLexer(&lexer, source);
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		//run
+		void* buffer = Toy_compileRoutineWithBackend(ast, TOY_BACKEND_REGISTER);
+
+		//check header
+		int* header = (int*)buffer;
+
+		if (header[5] != TOY_BACKEND_STACK || //backend
+			header[6] != 1) //frame size
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to fall back to the stack backend with %d locals\n" TOY_CC_RESET, TOY_ROUTINE_MAX_REGISTERS + 1);
+
+			//cleanup and return
+			free(buffer);
+			return -1;
+		}
+
 		//cleanup
 		free(buffer);
 	}
@@ -922,5 +1411,25 @@ int main() {
 		total += res;
 	}
 
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_routine_variables(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_routine_registers(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
 	return total;
 }
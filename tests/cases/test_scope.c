@@ -2,12 +2,18 @@
 #include "toy_console_colors.h"
 
 #include "toy_bucket.h"
+#include "toy_print.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-
+//the smallest table, which is a whole group of control bytes in the Swiss layout
+#if TOY_TABLE_SWISS
+#define TEST_INITIAL_CAPACITY TOY_TABLE_GROUP_WIDTH
+#else
+#define TEST_INITIAL_CAPACITY TOY_TABLE_INITIAL_CAPACITY
+#endif
 
 int test_scope_allocation() {
 	//allocate and free a scope
@@ -21,7 +27,7 @@ int test_scope_allocation() {
 		if (scope == NULL ||
 			scope->next != NULL ||
 			scope->table == NULL ||
-			scope->table->capacity != 8 ||
+			scope->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->refCount != 1 ||
 
 			false)
@@ -54,27 +60,27 @@ int test_scope_allocation() {
 			scope == NULL ||
 			scope->next == NULL ||
 			scope->table == NULL ||
-			scope->table->capacity != 8 ||
+			scope->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->refCount != 1 ||
 
 			scope->next->next == NULL ||
 			scope->next->table == NULL ||
-			scope->next->table->capacity != 8 ||
+			scope->next->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->next->refCount != 2 ||
 
 			scope->next->next->next == NULL ||
 			scope->next->next->table == NULL ||
-			scope->next->next->table->capacity != 8 ||
+			scope->next->next->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->next->next->refCount != 3 ||
 
 			scope->next->next->next->next == NULL ||
 			scope->next->next->next->table == NULL ||
-			scope->next->next->next->table->capacity != 8 ||
+			scope->next->next->next->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->next->next->next->refCount != 4 ||
 
 			scope->next->next->next->next->next != NULL ||
 			scope->next->next->next->next->table == NULL ||
-			scope->next->next->next->next->table->capacity != 8 ||
+			scope->next->next->next->next->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->next->next->next->next->refCount != 5 || //refCount includes all ancestors
 
 			false)
@@ -115,17 +121,17 @@ int test_scope_allocation() {
 			scope == NULL ||
 			scope->next == NULL ||
 			scope->table == NULL ||
-			scope->table->capacity != 8 ||
+			scope->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->refCount != 1 ||
 
 			scope->next->next == NULL ||
 			scope->next->table == NULL ||
-			scope->next->table->capacity != 8 ||
+			scope->next->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->next->refCount != 2 ||
 
 			scope->next->next->next != NULL ||
 			scope->next->next->table == NULL ||
-			scope->next->next->table->capacity != 8 ||
+			scope->next->next->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->next->next->refCount != 3 ||
 
 			false)
@@ -160,19 +166,19 @@ int test_scope_allocation() {
 			scopeBase == NULL ||
 			scopeBase->next != NULL ||
 			scopeBase->table == NULL ||
-			scopeBase->table->capacity != 8 ||
+			scopeBase->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeBase->refCount != 3 ||
 
 			scopeA == NULL ||
 			scopeA->next != scopeBase ||
 			scopeA->table == NULL ||
-			scopeA->table->capacity != 8 ||
+			scopeA->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeA->refCount != 1 ||
 
 			scopeB == NULL ||
 			scopeB->next != scopeBase ||
 			scopeB->table == NULL ||
-			scopeB->table->capacity != 8 ||
+			scopeB->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeB->refCount != 1 ||
 
 			scopeA->next != scopeB->next || //double check
@@ -212,20 +218,20 @@ int test_scope_allocation() {
 			scopeA == NULL ||
 			scopeA->next != NULL ||
 			scopeA->table == NULL ||
-			scopeA->table->capacity != 8 ||
+			scopeA->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeA->refCount != 2 ||
 
 			//scopeB still exists in memory until scopeC is popped
 			scopeB == NULL ||
 			scopeB->next != scopeA ||
 			scopeB->table == NULL ||
-			scopeB->table->capacity != 8 ||
+			scopeB->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeB->refCount != 1 ||
 
 			scopeC == NULL ||
 			scopeC->next != scopeB ||
 			scopeC->table == NULL ||
-			scopeC->table->capacity != 8 ||
+			scopeC->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeC->refCount != 1 ||
 
 			false)
@@ -259,19 +265,19 @@ int test_scope_allocation() {
 			scopeA == NULL ||
 			scopeA->next != NULL ||
 			scopeA->table == NULL ||
-			scopeA->table->capacity != 8 ||
+			scopeA->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeA->refCount != 3 ||
 
 			scopeB == NULL ||
 			scopeB->next != scopeA ||
 			scopeB->table == NULL ||
-			scopeB->table->capacity != 8 ||
+			scopeB->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeB->refCount != 1 ||
 
 			scopeB == NULL ||
 			scopeB->next != scopeA ||
 			scopeB->table == NULL ||
-			scopeB->table->capacity != 8 ||
+			scopeB->table->capacity != TEST_INITIAL_CAPACITY ||
 			scopeB->refCount != 1 ||
 
 			scopeB == scopeCopy ||
@@ -335,7 +341,7 @@ int test_scope_elements() {
 		if (scope == NULL ||
 			scope->next != NULL ||
 			scope->table == NULL ||
-			scope->table->capacity != 8 ||
+			scope->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->refCount != 1 ||
 
 			TOY_VALUE_IS_INTEGER(result) != true ||
@@ -360,7 +366,7 @@ int test_scope_elements() {
 		if (scope == NULL ||
 			scope->next != NULL ||
 			scope->table == NULL ||
-			scope->table->capacity != 8 ||
+			scope->table->capacity != TEST_INITIAL_CAPACITY ||
 			scope->refCount != 1 ||
 
 			TOY_VALUE_IS_FLOAT(resultTwo) != true ||
@@ -446,14 +452,16 @@ int test_scope_elements() {
 			}
 		}
 
-		Toy_assignScope(scope, hello, TOY_VALUE_FROM_INTEGER(8891));
+		Toy_Value replaced = Toy_assignScope(scope, hello, TOY_VALUE_FROM_INTEGER(8891));
 
 		{
-			//check it's assigned correctly
+			//check it's assigned correctly, and the old value is handed back
 			Toy_Value result4 = Toy_accessScope(scope, hello);
 
 			if (TOY_VALUE_IS_INTEGER(result4) != true ||
-				TOY_VALUE_AS_INTEGER(result4) != 8891)
+				TOY_VALUE_AS_INTEGER(result4) != 8891 ||
+				TOY_VALUE_IS_INTEGER(replaced) != true ||
+				TOY_VALUE_AS_INTEGER(replaced) != 42)
 			{
 				fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to assign to an ancestor in Toy_Scope\n" TOY_CC_RESET);
 				Toy_freeString(hello);
@@ -489,6 +497,350 @@ int test_scope_elements() {
 	return 0;
 }
 
+int test_scope_bloom_filter() {
+	//names declared along a chain are found from the innermost scope, whichever scopes get skipped
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* scope = NULL;
+		Toy_String* names[64];
+
+		//eight scopes, of eight names each
+		for (int i = 0; i < 64; i++) {
+			if (i % 8 == 0) {
+				scope = Toy_pushScope(&bucket, scope);
+			}
+
+			char buffer[16];
+			int length = snprintf(buffer, sizeof(buffer), "name%d", i);
+			names[i] = Toy_createNameStringLength(&bucket, buffer, length, TOY_VALUE_INTEGER);
+			Toy_declareScope(scope, names[i], TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		Toy_Scope* copy = Toy_deepCopyScope(&bucket, scope);
+		Toy_String* missing = Toy_createNameStringLength(&bucket, "missing", 7, TOY_VALUE_INTEGER);
+
+		//check the state
+		int failures = 0;
+
+		for (int i = 0; i < 64; i++) {
+			Toy_Value result = Toy_accessScope(scope, names[i]);
+			Toy_Value copied = Toy_accessScope(copy, names[i]);
+
+			failures += !TOY_VALUE_IS_INTEGER(result) || TOY_VALUE_AS_INTEGER(result) != i;
+			failures += !TOY_VALUE_IS_INTEGER(copied) || TOY_VALUE_AS_INTEGER(copied) != i;
+		}
+
+		if (failures != 0 ||
+			scope->bloom == 0 ||
+			copy->bloom != scope->bloom ||
+			Toy_isDeclaredScope(scope, missing) ||
+			Toy_isDeclaredScope(copy, missing)
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to look up names through a Toy_Scope chain, %d bad lookups\n" TOY_CC_RESET, failures);
+			for (int i = 0; i < 64; i++) {
+				Toy_freeString(names[i]);
+			}
+			Toy_freeString(missing);
+			Toy_popScope(copy);
+			while ((scope = Toy_popScope(scope)) != NULL) /* */;
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		for (int i = 0; i < 64; i++) {
+			Toy_freeString(names[i]);
+		}
+		Toy_freeString(missing);
+		Toy_popScope(copy);
+		while ((scope = Toy_popScope(scope)) != NULL) /* */;
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+int test_scope_persistent() {
+	//a persistent scope's copies share its contents, while assignments stay on their own side
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* root = Toy_pushScope(&bucket, NULL);
+		Toy_Scope* scope = Toy_pushPersistentScope(&bucket, root);
+
+		Toy_String* outer = Toy_createNameStringLength(&bucket, "outer", 5, TOY_VALUE_INTEGER);
+		Toy_declareScope(root, outer, TOY_VALUE_FROM_INTEGER(1));
+
+		Toy_String* names[100];
+		for (int i = 0; i < 100; i++) {
+			char buffer[16];
+			int length = snprintf(buffer, sizeof(buffer), "name%d", i);
+			names[i] = Toy_createNameStringLength(&bucket, buffer, length, TOY_VALUE_INTEGER);
+			Toy_declareScope(scope, names[i], TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		Toy_Scope* copy = Toy_deepCopyScope(&bucket, scope);
+		bool shared = copy->persistent && copy->table == NULL && copy->hamt == scope->hamt;
+
+		//change the copy, including a name from the shared parent
+		Toy_assignScope(copy, names[42], TOY_VALUE_FROM_INTEGER(-42));
+		Toy_assignScope(copy, outer, TOY_VALUE_FROM_INTEGER(2));
+
+		Toy_Value original = Toy_accessScope(scope, names[42]);
+		Toy_Value changed = Toy_accessScope(copy, names[42]);
+		Toy_Value untouched = Toy_accessScope(copy, names[43]);
+		Toy_Value parent = Toy_accessScope(scope, outer);
+
+		//check the state
+		if (!shared ||
+			copy->hamt == scope->hamt ||
+			!TOY_VALUE_IS_INTEGER(original) || TOY_VALUE_AS_INTEGER(original) != 42 ||
+			!TOY_VALUE_IS_INTEGER(changed) || TOY_VALUE_AS_INTEGER(changed) != -42 ||
+			!TOY_VALUE_IS_INTEGER(untouched) || TOY_VALUE_AS_INTEGER(untouched) != 43 ||
+			!TOY_VALUE_IS_INTEGER(parent) || TOY_VALUE_AS_INTEGER(parent) != 2
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to share and separate a persistent Toy_Scope\n" TOY_CC_RESET);
+			Toy_popScope(copy);
+			while ((scope = Toy_popScope(scope)) != NULL) /* */;
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_popScope(copy);
+		while ((scope = Toy_popScope(scope)) != NULL) /* */;
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+int test_scope_copy_ownership() {
+	//a copy keeps its own references, so the original's replaced value is still readable through it
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* scope = Toy_pushScope(&bucket, NULL);
+
+		Toy_String* name = Toy_createNameStringLength(&bucket, "motto", 5, TOY_VALUE_STRING);
+		Toy_declareScope(scope, name, TOY_VALUE_FROM_STRING(Toy_createString(&bucket, "the original value")));
+
+		Toy_Scope* copy = Toy_deepCopyScope(&bucket, scope);
+
+		//released by the caller, as the VM does
+		Toy_freeValue(Toy_assignScope(scope, name, TOY_VALUE_FROM_STRING(Toy_createString(&bucket, "the replacement"))));
+		Toy_createString(&bucket, "OVERWRITTEN BY A NEW ALLOCATION");
+
+		Toy_Value original = Toy_accessScope(copy, name);
+		Toy_Value changed = Toy_accessScope(scope, name);
+
+		//check the state
+		if (!TOY_VALUE_IS_STRING(original) ||
+			Toy_getStringRefCount(TOY_VALUE_AS_STRING(original)) != 1 ||
+			strcmp(TOY_VALUE_AS_STRING(original)->as.leaf.data, "the original value") != 0 ||
+			!TOY_VALUE_IS_STRING(changed) ||
+			strcmp(TOY_VALUE_AS_STRING(changed)->as.leaf.data, "the replacement") != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: A copied Toy_Scope didn't keep its own reference to a value\n" TOY_CC_RESET);
+			Toy_popScope(copy);
+			Toy_popScope(scope);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_popScope(copy);
+		Toy_popScope(scope);
+
+		//popping the last scope holding a string releases it
+		if (Toy_getStringRefCount(TOY_VALUE_AS_STRING(original)) != 0) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: A popped Toy_Scope didn't release its values\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		Toy_freeBucket(&bucket);
+	}
+
+	//the same for a persistent scope, where the copy shares nodes until the original changes
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* scope = Toy_pushPersistentScope(&bucket, NULL);
+
+		Toy_String* name = Toy_createNameStringLength(&bucket, "motto", 5, TOY_VALUE_STRING);
+		Toy_declareScope(scope, name, TOY_VALUE_FROM_STRING(Toy_createString(&bucket, "the original value")));
+
+		Toy_Scope* copy = Toy_deepCopyScope(&bucket, scope);
+
+		//released by the caller, as the VM does
+		Toy_freeValue(Toy_assignScope(scope, name, TOY_VALUE_FROM_STRING(Toy_createString(&bucket, "the replacement"))));
+		Toy_createString(&bucket, "OVERWRITTEN BY A NEW ALLOCATION");
+
+		Toy_Value original = Toy_accessScope(copy, name);
+		Toy_Value changed = Toy_accessScope(scope, name);
+
+		//check the state
+		if (copy->hamt == scope->hamt ||
+			!TOY_VALUE_IS_STRING(original) ||
+			Toy_getStringRefCount(TOY_VALUE_AS_STRING(original)) != 1 ||
+			strcmp(TOY_VALUE_AS_STRING(original)->as.leaf.data, "the original value") != 0 ||
+			!TOY_VALUE_IS_STRING(changed) ||
+			strcmp(TOY_VALUE_AS_STRING(changed)->as.leaf.data, "the replacement") != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: A copied persistent Toy_Scope didn't keep its own reference to a value\n" TOY_CC_RESET);
+			Toy_popScope(copy);
+			Toy_popScope(scope);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_popScope(copy);
+		Toy_popScope(scope);
+
+		//freeing the last node holding a string releases it
+		if (Toy_getStringRefCount(TOY_VALUE_AS_STRING(original)) != 0 ||
+			Toy_getStringRefCount(TOY_VALUE_AS_STRING(changed)) != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: A popped persistent Toy_Scope didn't release its values\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+static int errorCount = 0;
+
+static void countErrors(const char* msg) {
+	errorCount++;
+}
+
+int test_scope_shared() {
+	//two chains, as if from two VMs, rooted on the same shared table
+	{
+		//setup
+		Toy_Bucket* hostBucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_SharedTable* shared = Toy_allocateSharedTable();
+
+		Toy_String* config = Toy_createNameStringLength(&hostBucket, "config", 6, TOY_VALUE_INTEGER);
+		Toy_insertSharedTable(shared, TOY_VALUE_FROM_STRING(config), TOY_VALUE_FROM_INTEGER(1));
+
+		Toy_Bucket* bucketA = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* scopeA = Toy_pushScope(&bucketA, Toy_pushSharedScope(&bucketA, NULL, shared));
+
+		Toy_Bucket* bucketB = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* scopeB = Toy_pushScope(&bucketB, Toy_pushSharedScope(&bucketB, NULL, shared));
+
+		//each VM has its own copy of the name, and its own local
+		Toy_String* configA = Toy_createNameStringLength(&bucketA, "config", 6, TOY_VALUE_INTEGER);
+		Toy_String* configB = Toy_createNameStringLength(&bucketB, "config", 6, TOY_VALUE_INTEGER);
+		Toy_String* local = Toy_createNameStringLength(&bucketA, "local", 5, TOY_VALUE_INTEGER);
+
+		Toy_declareScope(scopeA, local, TOY_VALUE_FROM_INTEGER(3));
+
+		Toy_Value before = Toy_accessScope(scopeB, configB);
+		Toy_assignScope(scopeA, configA, TOY_VALUE_FROM_INTEGER(2));
+		Toy_Value after = Toy_accessScope(scopeB, configB);
+
+		//check the state
+		if (!TOY_VALUE_IS_INTEGER(before) || TOY_VALUE_AS_INTEGER(before) != 1 ||
+			!TOY_VALUE_IS_INTEGER(after) || TOY_VALUE_AS_INTEGER(after) != 2 ||
+			scopeA->next->table != NULL ||
+			scopeA->next->reader == scopeB->next->reader ||
+			Toy_isDeclaredScope(scopeB, local) ||
+			!Toy_isDeclaredScope(scopeA, local)
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to share a Toy_SharedTable between two scope chains\n" TOY_CC_RESET);
+			while ((scopeA = Toy_popScope(scopeA)) != NULL) /* */;
+			while ((scopeB = Toy_popScope(scopeB)) != NULL) /* */;
+			Toy_freeBucket(&bucketA);
+			Toy_freeBucket(&bucketB);
+			Toy_freeSharedTable(shared);
+			Toy_freeBucket(&hostBucket);
+			return -1;
+		}
+
+		//popping the chains closes their readers, leaving the table to the host
+		while ((scopeA = Toy_popScope(scopeA)) != NULL) /* */;
+		while ((scopeB = Toy_popScope(scopeB)) != NULL) /* */;
+
+		if (shared->readers != NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Popping a shared Toy_Scope didn't close its reader\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucketA);
+			Toy_freeBucket(&bucketB);
+			Toy_freeBucket(&hostBucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucketA);
+		Toy_freeBucket(&bucketB);
+		Toy_freeSharedTable(shared);
+		Toy_freeBucket(&hostBucket);
+	}
+
+	//names and strings declared by one VM outlive it
+	{
+		//setup
+		Toy_SharedTable* shared = Toy_allocateSharedTable();
+
+		Toy_Bucket* bucketA = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* scopeA = Toy_pushSharedScope(&bucketA, NULL, shared);
+		Toy_String* nameA = Toy_createNameStringLength(&bucketA, "motto", 5, TOY_VALUE_STRING);
+		Toy_declareScope(scopeA, nameA, TOY_VALUE_FROM_STRING(Toy_createString(&bucketA, "declared by the first VM")));
+		Toy_Value given = Toy_assignScope(scopeA, nameA, TOY_VALUE_FROM_STRING(Toy_createString(&bucketA, "assigned by the first VM")));
+
+		//the first VM goes away
+		while ((scopeA = Toy_popScope(scopeA)) != NULL) /* */;
+		Toy_freeBucket(&bucketA);
+
+		Toy_Bucket* bucketB = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Scope* scopeB = Toy_pushSharedScope(&bucketB, NULL, shared);
+		Toy_String* nameB = Toy_createNameStringLength(&bucketB, "motto", 5, TOY_VALUE_STRING);
+
+		//the second VM can't declare it again
+		errorCount = 0;
+		Toy_setErrorCallback(countErrors);
+		Toy_declareScope(scopeB, nameB, TOY_VALUE_FROM_INTEGER(0));
+		Toy_resetErrorCallback();
+
+		Toy_Value result = Toy_accessScope(scopeB, nameB);
+
+		//check the state
+		if (errorCount != 1 ||
+			!TOY_VALUE_IS_STRING(given) ||
+			!TOY_VALUE_IS_STRING(result) ||
+			strcmp(TOY_VALUE_AS_STRING(result)->as.leaf.data, "assigned by the first VM") != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Strings declared through a shared Toy_Scope didn't outlive their VM\n" TOY_CC_RESET);
+			while ((scopeB = Toy_popScope(scopeB)) != NULL) /* */;
+			Toy_freeBucket(&bucketB);
+			Toy_freeSharedTable(shared);
+			return -1;
+		}
+
+		//cleanup
+		while ((scopeB = Toy_popScope(scopeB)) != NULL) /* */;
+		Toy_freeBucket(&bucketB);
+		Toy_freeSharedTable(shared);
+	}
+
+	return 0;
+}
+
 int main() {
 	//run each test set, returning the total errors given
 	int total = 0, res = 0;
@@ -509,5 +861,37 @@ int main() {
 		total += res;
 	}
 
+	{
+		res = test_scope_bloom_filter();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_scope_persistent();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_scope_copy_ownership();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_scope_shared();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
 	return total;
 }
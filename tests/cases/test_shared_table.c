@@ -0,0 +1,271 @@
+#include "toy_shared_table.h"
+#include "toy_console_colors.h"
+
+#include "toy_string.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+int test_shared_table_insert_and_lookup() {
+	//an empty table
+	{
+		Toy_SharedTable* shared = Toy_allocateSharedTable();
+		Toy_SharedReader* reader = Toy_openSharedReader(shared);
+
+		Toy_Value result = Toy_lookupSharedTable(shared, reader, TOY_VALUE_FROM_INTEGER(1));
+
+		if (!TOY_VALUE_IS_NULL(result) || shared->readers != reader) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected entry found in an empty shared table\n" TOY_CC_RESET);
+			Toy_closeSharedReader(shared, reader);
+			Toy_freeSharedTable(shared);
+			return -1;
+		}
+
+		Toy_closeSharedReader(shared, reader);
+		Toy_freeSharedTable(shared);
+	}
+
+	//many entries, overriding some, read through two readers
+	{
+		//setup
+		Toy_SharedTable* shared = Toy_allocateSharedTable();
+		Toy_SharedReader* first = Toy_openSharedReader(shared);
+		Toy_SharedReader* second = Toy_openSharedReader(shared);
+
+		for (int i = 0; i < 2000; i++) {
+			Toy_insertSharedTable(shared, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i * 2));
+		}
+
+		for (int i = 0; i < 2000; i += 3) {
+			Toy_insertSharedTable(shared, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(-i));
+		}
+
+		//check the state
+		int failures = 0;
+
+		for (int i = 0; i < 2000; i++) {
+			Toy_Value result = Toy_lookupSharedTable(shared, i % 2 ? first : second, TOY_VALUE_FROM_INTEGER(i));
+			failures += !TOY_VALUE_IS_INTEGER(result) || TOY_VALUE_AS_INTEGER(result) != (i % 3 == 0 ? -i : i * 2);
+		}
+
+		failures += !TOY_VALUE_IS_NULL(Toy_lookupSharedTable(shared, first, TOY_VALUE_FROM_INTEGER(2000)));
+
+		//each write publishes a new version, and only the latest one is still around
+		if (failures != 0 ||
+			atomic_load(&shared->epoch) != 2000 + 667 ||
+			atomic_load(&shared->table)->count != 2000 ||
+			atomic_load(&first->state) != 0 ||
+			atomic_load(&second->state) != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Shared table insert and lookup failed, %d bad lookups\n" TOY_CC_RESET, failures);
+			Toy_closeSharedReader(shared, first);
+			Toy_closeSharedReader(shared, second);
+			Toy_freeSharedTable(shared);
+			return -1;
+		}
+
+		//free
+		Toy_closeSharedReader(shared, first);
+		Toy_closeSharedReader(shared, second);
+		Toy_freeSharedTable(shared);
+	}
+
+	return 0;
+}
+
+int test_shared_table_readers() {
+	//readers can be closed in any order
+	{
+		//setup
+		Toy_SharedTable* shared = Toy_allocateSharedTable();
+		Toy_SharedReader* readers[4];
+
+		for (int i = 0; i < 4; i++) {
+			readers[i] = Toy_openSharedReader(shared);
+		}
+
+		Toy_insertSharedTable(shared, TOY_VALUE_FROM_INTEGER(1), TOY_VALUE_FROM_INTEGER(42));
+
+		Toy_closeSharedReader(shared, readers[2]);
+		Toy_closeSharedReader(shared, readers[0]);
+
+		//check the state
+		int count = 0;
+		for (Toy_SharedReader* iter = shared->readers; iter; iter = iter->next) {
+			count++;
+		}
+
+		Toy_Value result = Toy_lookupSharedTable(shared, readers[3], TOY_VALUE_FROM_INTEGER(1));
+
+		if (count != 2 ||
+			shared->readers != readers[3] ||
+			shared->readers->next != readers[1] ||
+			!TOY_VALUE_IS_INTEGER(result) || TOY_VALUE_AS_INTEGER(result) != 42
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Shared table readers weren't tracked correctly\n" TOY_CC_RESET);
+			Toy_closeSharedReader(shared, readers[1]);
+			Toy_closeSharedReader(shared, readers[3]);
+			Toy_freeSharedTable(shared);
+			return -1;
+		}
+
+		//free
+		Toy_closeSharedReader(shared, readers[3]);
+		Toy_closeSharedReader(shared, readers[1]);
+		Toy_freeSharedTable(shared);
+	}
+
+	return 0;
+}
+
+int test_shared_table_declare() {
+	//declaring only inserts keys that aren't there yet, without publishing a new version otherwise
+	{
+		//setup
+		Toy_SharedTable* shared = Toy_allocateSharedTable();
+		Toy_SharedReader* reader = Toy_openSharedReader(shared);
+
+		bool first = Toy_declareSharedTable(shared, TOY_VALUE_FROM_INTEGER(1), TOY_VALUE_FROM_INTEGER(42));
+		bool second = Toy_declareSharedTable(shared, TOY_VALUE_FROM_INTEGER(1), TOY_VALUE_FROM_INTEGER(99));
+		unsigned int epoch = atomic_load(&shared->epoch);
+
+		Toy_Value result = Toy_lookupSharedTable(shared, reader, TOY_VALUE_FROM_INTEGER(1));
+
+		//check the state
+		if (!first ||
+			second ||
+			epoch != 1 ||
+			!TOY_VALUE_IS_INTEGER(result) || TOY_VALUE_AS_INTEGER(result) != 42
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Shared table declare failed\n" TOY_CC_RESET);
+			Toy_closeSharedReader(shared, reader);
+			Toy_freeSharedTable(shared);
+			return -1;
+		}
+
+		//free
+		Toy_closeSharedReader(shared, reader);
+		Toy_freeSharedTable(shared);
+	}
+
+	return 0;
+}
+
+//the only key in the current version
+static Toy_String* findOnlyKey(Toy_SharedTable* shared) {
+	Toy_Table* table = atomic_load(&shared->table);
+
+	for (unsigned int i = 0; i < table->capacity; i++) {
+		if (!TOY_VALUE_IS_NULL(TOY_TABLE_KEY(table, i))) {
+			return TOY_VALUE_AS_STRING(TOY_TABLE_KEY(table, i));
+		}
+	}
+
+	return NULL;
+}
+
+int test_shared_table_ownership() {
+	//strings are copied in, so they outlive the writer's bucket, and replacing a value keeps the stored key
+	{
+		//setup
+		Toy_SharedTable* shared = Toy_allocateSharedTable();
+		Toy_SharedReader* reader = Toy_openSharedReader(shared);
+
+		Toy_Bucket* writerBucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_String* key = Toy_createNameStringLength(&writerBucket, "greeting", 8, TOY_VALUE_STRING);
+		Toy_String* first = Toy_createString(&writerBucket, "hello from the writer");
+		Toy_String* second = Toy_createString(&writerBucket, "goodbye from the writer");
+
+		Toy_insertSharedTable(shared, TOY_VALUE_FROM_STRING(key), TOY_VALUE_FROM_STRING(first));
+		Toy_String* storedKey = findOnlyKey(shared);
+
+		Toy_insertSharedTable(shared, TOY_VALUE_FROM_STRING(key), TOY_VALUE_FROM_STRING(second));
+		bool keptKey = findOnlyKey(shared) == storedKey;
+
+		//the writer goes away
+		Toy_freeBucket(&writerBucket);
+
+		Toy_Bucket* readerBucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_String* name = Toy_createNameStringLength(&readerBucket, "greeting", 8, TOY_VALUE_STRING);
+		Toy_Value result = Toy_lookupSharedTable(shared, reader, TOY_VALUE_FROM_STRING(name));
+
+		//check the state
+		if (storedKey == NULL ||
+			storedKey == key ||
+			!keptKey ||
+			atomic_load(&shared->table)->count != 1 ||
+			Toy_getStringRefCount(storedKey) != UINT_MAX ||
+			!TOY_VALUE_IS_STRING(result) ||
+			Toy_getStringRefCount(TOY_VALUE_AS_STRING(result)) != UINT_MAX ||
+			strcmp(TOY_VALUE_AS_STRING(result)->as.leaf.data, "goodbye from the writer") != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Shared table didn't keep its own copies of its strings\n" TOY_CC_RESET);
+			Toy_freeBucket(&readerBucket);
+			Toy_closeSharedReader(shared, reader);
+			Toy_freeSharedTable(shared);
+			return -1;
+		}
+
+		//copies and releases by the reader leave the pinned string as it was
+		Toy_freeString(Toy_copyString(TOY_VALUE_AS_STRING(result)));
+
+		if (Toy_getStringRefCount(TOY_VALUE_AS_STRING(result)) != UINT_MAX) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: A pinned string's reference count was changed\n" TOY_CC_RESET);
+			Toy_freeBucket(&readerBucket);
+			Toy_closeSharedReader(shared, reader);
+			Toy_freeSharedTable(shared);
+			return -1;
+		}
+
+		//free
+		Toy_freeBucket(&readerBucket);
+		Toy_closeSharedReader(shared, reader);
+		Toy_freeSharedTable(shared);
+	}
+
+	return 0;
+}
+
+int main() {
+	//run each test set, returning the total errors given
+	int total = 0, res = 0;
+
+	{
+		res = test_shared_table_insert_and_lookup();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_shared_table_readers();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_shared_table_declare();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_shared_table_ownership();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	return total;
+}
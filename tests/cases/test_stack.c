@@ -109,6 +109,51 @@ int test_stack_stress() {
 	return 0;
 }
 
+int test_stack_reserve() {
+	//reserve up front, then use the unchecked fast path
+	{
+		Toy_Stack* stack = Toy_allocateStack();
+
+		Toy_reserveStack(&stack, 100);
+		Toy_reserveStack(&stack, 10); //never shrinks
+
+		for (int i = 0; i < 100; i++) {
+			TOY_STACK_PUSH_UNCHECKED(stack, TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		//check if it worked
+		if (
+			stack == NULL ||
+			stack->capacity != 100 ||
+			stack->count != 100)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to reserve the Toy_Stack\n" TOY_CC_RESET);
+			Toy_freeStack(stack);
+			return -1;
+		}
+
+		int sum = 0;
+		for (int i = 0; i < 100; i++) {
+			sum += TOY_VALUE_AS_INTEGER(TOY_STACK_POP_UNCHECKED(stack));
+		}
+
+		//popping never gives the memory back
+		if (
+			stack->capacity != 100 ||
+			stack->count != 0 ||
+			sum != 4950)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: failed to pop the unchecked Toy_Stack\n" TOY_CC_RESET);
+			Toy_freeStack(stack);
+			return -1;
+		}
+
+		Toy_freeStack(stack);
+	}
+
+	return 0;
+}
+
 int main() {
 	//run each test set, returning the total errors given
 	int total = 0, res = 0;
@@ -129,5 +174,13 @@ int main() {
 		total += res;
 	}
 
+	{
+		res = test_stack_reserve();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
 	return total;
 }
@@ -54,9 +54,10 @@ int test_string_allocation() {
 		//free the string
 		Toy_freeString(str);
 
-		//inspect the bucket
+		//inspect the bucket, which was given its memory back
 		if (bucket->capacity != 1024 ||
-			bucket->count != sizeof(Toy_String) + 12 ||
+			bucket->count != 0 ||
+			bucket->released != 0 ||
 			bucket->next != NULL)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected bucket state after a string was freed\n" TOY_CC_RESET);
@@ -255,8 +256,8 @@ int test_string_with_stressed_bucket() {
 			str = Toy_concatStrings(&bucket, str, Toy_createString(&bucket, testData[i]));
 		}
 
-		//check
-		if (ptr->refCount != 9 ||
+		//check, only the first node holds a reference to the first leaf
+		if (ptr->refCount != 2 ||
 			str->length != 36)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of the string after stress test\n" TOY_CC_RESET);
@@ -822,6 +823,467 @@ int test_string_fragmenting() {
 	return 0;
 }
 
+int test_string_rebalancing() {
+	//appending one character at a time keeps the rope shallow
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(1024);
+
+		Toy_String* str = Toy_createString(&bucket, "");
+		for (int i = 0; i < 1000; i++) {
+			char c[2] = { 'a' + (i % 26), '\0' };
+			Toy_String* next = Toy_concatStrings(&bucket, str, Toy_createString(&bucket, c));
+			Toy_freeString(str);
+			str = next;
+		}
+
+		//check
+		if (str->length != 1000 ||
+			str->depth > TOY_STRING_MAX_DEPTH ||
+			str->refCount != 1)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of the string after rebalancing, length %d and depth %d\n" TOY_CC_RESET, (int)str->length, (int)str->depth);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//the contents are unchanged
+		char* buffer = Toy_getStringRawBuffer(str);
+
+		for (int i = 0; i < 1000; i++) {
+			if (buffer[i] != 'a' + (i % 26)) {
+				fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected character '%c' at %d after rebalancing\n" TOY_CC_RESET, buffer[i], i);
+				free(buffer);
+				Toy_freeBucket(&bucket);
+				return -1;
+			}
+		}
+
+		//cleanup
+		free(buffer);
+		Toy_freeString(str);
+		Toy_freeBucket(&bucket);
+	}
+
+	//short ropes collapse into a single leaf
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(1024);
+
+		Toy_String* str = Toy_createString(&bucket, "x");
+		for (int i = 0; i <= TOY_STRING_MAX_DEPTH; i++) {
+			str = Toy_concatStrings(&bucket, str, Toy_createString(&bucket, "x"));
+		}
+
+		//check
+		if (str->type != TOY_STRING_LEAF ||
+			str->length != TOY_STRING_MAX_DEPTH + 2 ||
+			str->depth != 0 ||
+			strspn(str->as.leaf.data, "x") != TOY_STRING_MAX_DEPTH + 2)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to collapse a short rope into a leaf\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+int test_string_builder() {
+	//build a string from several pieces
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(128); //deliberately too small for the result
+
+		Toy_StringBuilder builder;
+		Toy_initStringBuilder(&builder);
+
+		Toy_String* hello = Toy_concatStrings(&bucket, Toy_createString(&bucket, "Hello"), Toy_createString(&bucket, " "));
+
+		for (int i = 0; i < 50; i++) {
+			Toy_appendStringBuilder(&builder, hello);
+			Toy_appendCStringBuilder(&builder, "world! ", 7);
+		}
+
+		Toy_String* str = Toy_buildString(&bucket, &builder);
+
+		//check
+		if (str->length != 650 ||
+			builder.length != 0 ||
+			builder.capacity < 650)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of the string builder\n" TOY_CC_RESET);
+			Toy_freeStringBuilder(&builder);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		char* buffer = Toy_getStringRawBuffer(str);
+
+		if (strncmp(buffer, "Hello world! Hello world! ", 26) != 0 || strcmp(buffer + 637, "Hello world! ") != 0) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected contents '%s' from the string builder\n" TOY_CC_RESET, buffer);
+			free(buffer);
+			Toy_freeStringBuilder(&builder);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		free(buffer);
+		Toy_freeStringBuilder(&builder);
+		Toy_freeBucket(&bucket);
+	}
+
+	//empty appends to a fresh builder allocate nothing
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_StringBuilder builder;
+		Toy_initStringBuilder(&builder);
+
+		Toy_appendCStringBuilder(&builder, "", 0);
+		Toy_appendStringBuilder(&builder, Toy_createString(&bucket, ""));
+
+		Toy_String* str = Toy_buildString(&bucket, &builder);
+
+		//check
+		if (str->length != 0 ||
+			builder.data != NULL ||
+			builder.capacity != 0)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of the string builder after empty appends\n" TOY_CC_RESET);
+			Toy_freeStringBuilder(&builder);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeStringBuilder(&builder);
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+int test_string_hashing() {
+	//ropes hash the same as the flat string, whatever their shape
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(128); //deliberately too small for the long string
+
+		Toy_String* flat = Toy_createString(&bucket, "Hello world");
+		Toy_String* left = Toy_concatStrings(&bucket, Toy_createString(&bucket, "Hello"), Toy_createString(&bucket, " world"));
+		Toy_String* right = Toy_concatStrings(&bucket, Toy_createString(&bucket, "Hel"), Toy_concatStrings(&bucket, Toy_createString(&bucket, "lo wo"), Toy_createString(&bucket, "rld")));
+
+		const char* cstring = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat.";
+		Toy_String* fragmented = Toy_createString(&bucket, cstring);
+
+		Toy_Bucket* bigBucket = Toy_allocateBucket(1024);
+		Toy_String* whole = Toy_createString(&bigBucket, cstring);
+
+		//check
+		if (left->type != TOY_STRING_NODE ||
+			right->type != TOY_STRING_NODE ||
+			fragmented->type != TOY_STRING_NODE ||
+			whole->type != TOY_STRING_LEAF ||
+			Toy_hashString(left) != Toy_hashString(flat) ||
+			Toy_hashString(right) != Toy_hashString(flat) ||
+			Toy_hashString(fragmented) != Toy_hashString(whole) ||
+			Toy_hashString(flat) == Toy_hashString(whole))
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected hash of a rope within Toy_String\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			Toy_freeBucket(&bigBucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+		Toy_freeBucket(&bigBucket);
+	}
+
+	//concatenating hashed strings fills in the hash, without revisiting the children
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_String* first = Toy_createString(&bucket, "foo");
+		Toy_String* second = Toy_createString(&bucket, "bar");
+		Toy_String* unhashed = Toy_concatStrings(&bucket, first, second);
+
+		Toy_hashString(first);
+		Toy_hashString(second);
+		Toy_String* hashed = Toy_concatStrings(&bucket, first, second);
+
+		//check
+		if (unhashed->cachedHash != 0 ||
+			hashed->cachedHash == 0 ||
+			Toy_hashString(hashed) != Toy_hashString(Toy_createString(&bucket, "foobar")) ||
+			Toy_hashString(unhashed) != Toy_hashString(hashed))
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected cached hash after concatenation within Toy_String\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+int test_string_iterator() {
+	//walk the chunks of a rope in order, skipping empty leaves
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_String* str = Toy_concatStrings(&bucket,
+			Toy_concatStrings(&bucket, Toy_createString(&bucket, "Hello"), Toy_createString(&bucket, "")),
+			Toy_concatStrings(&bucket, Toy_createString(&bucket, " "), Toy_concatStrings(&bucket, Toy_createString(&bucket, "world"), Toy_createString(&bucket, "!")))
+		);
+
+		const char* expected[] = { "Hello", " ", "world", "!" };
+		unsigned int count = 0;
+
+		Toy_StringIterator iter;
+		Toy_initStringIterator(&iter, str);
+
+		while (Toy_nextStringChunk(&iter)) {
+			if (count >= 4 || iter.length != strlen(expected[count]) || strncmp(iter.chunk, expected[count], iter.length) != 0) {
+				fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected chunk %u from a string iterator\n" TOY_CC_RESET, count);
+				Toy_freeBucket(&bucket);
+				return -1;
+			}
+			count++;
+		}
+
+		//check
+		if (count != 4 || iter.chunk != NULL || iter.length != 0) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected end state of a string iterator, found %u chunks\n" TOY_CC_RESET, count);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
+	//compare ropes whose chunks don't line up
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_String* left = Toy_concatStrings(&bucket, Toy_createString(&bucket, "Hello w"), Toy_createString(&bucket, "orld"));
+		Toy_String* right = Toy_concatStrings(&bucket, Toy_createString(&bucket, "He"), Toy_concatStrings(&bucket, Toy_createString(&bucket, "llo"), Toy_createString(&bucket, " world")));
+		Toy_String* prefix = Toy_concatStrings(&bucket, Toy_createString(&bucket, "Hel"), Toy_createString(&bucket, "lo"));
+		Toy_String* later = Toy_concatStrings(&bucket, Toy_createString(&bucket, "Hello w"), Toy_createString(&bucket, "orle"));
+
+		//check
+		if (Toy_compareStrings(left, right) != 0 ||
+			Toy_equalStrings(left, right) != true ||
+			Toy_compareStrings(prefix, left) >= 0 ||
+			Toy_compareStrings(left, prefix) <= 0 ||
+			Toy_equalStrings(left, prefix) != false ||
+			Toy_compareStrings(left, later) >= 0 ||
+			Toy_compareStrings(later, right) <= 0 ||
+			Toy_equalStrings(later, right) != false)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected comparison of misaligned ropes\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
+	//compare deep ropes of different shapes
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_String* appended = Toy_createString(&bucket, "");
+		Toy_String* prepended = Toy_createString(&bucket, "");
+
+		for (int i = 0; i < 10000; i++) {
+			char a[2] = { 'a' + (i % 26), '\0' };
+			char p[2] = { 'a' + ((9999 - i) % 26), '\0' };
+			appended = Toy_concatStrings(&bucket, appended, Toy_createString(&bucket, a));
+			prepended = Toy_concatStrings(&bucket, Toy_createString(&bucket, p), prepended);
+		}
+
+		//check
+		if (appended->depth == prepended->depth ||
+			Toy_compareStrings(appended, prepended) != 0 ||
+			Toy_equalStrings(appended, prepended) != true)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected comparison of deep ropes\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+int test_string_slicing() {
+	//slice a long leaf, sharing its characters
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		const char* cstring = "The quick brown fox jumps over the lazy dog, then naps in the afternoon sun.";
+		Toy_String* str = Toy_createString(&bucket, cstring);
+		Toy_String* slice = Toy_sliceString(&bucket, str, 4, 40);
+
+		char* buffer = Toy_getStringRawBuffer(slice);
+		Toy_String* copy = Toy_createStringLength(&bucket, cstring + 4, 40);
+
+		//check
+		if (slice->type != TOY_STRING_VIEW ||
+			slice->length != 40 ||
+			slice->as.view.parent != str ||
+			slice->as.view.data != str->as.leaf.data + 4 ||
+			str->refCount != 2 ||
+			strncmp(buffer, cstring + 4, 40) != 0 ||
+			strlen(buffer) != 40 ||
+			Toy_equalStrings(slice, copy) != true ||
+			Toy_hashString(slice) != Toy_hashString(copy))
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of a string view, found '%s'\n" TOY_CC_RESET, buffer);
+			free(buffer);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//a view of a view still looks at the leaf
+		Toy_String* inner = Toy_sliceString(&bucket, slice, 6, 33);
+
+		if (inner->type != TOY_STRING_VIEW ||
+			inner->as.view.parent != str ||
+			inner->as.view.data != str->as.leaf.data + 10 ||
+			str->refCount != 3 ||
+			slice->refCount != 1 ||
+			strncmp(inner->as.view.data, "brown fox", 9) != 0)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of a view of a view\n" TOY_CC_RESET);
+			free(buffer);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//the views keep the leaf alive
+		Toy_freeString(str);
+		Toy_freeString(slice);
+
+		if (str->refCount != 1 || inner->refCount != 1) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected refcounts after freeing the parent of a view\n" TOY_CC_RESET);
+			free(buffer);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		free(buffer);
+		Toy_freeString(inner);
+		Toy_freeString(copy);
+		Toy_freeBucket(&bucket);
+	}
+
+	//small slices, and small parts of big leaves, are copied instead
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		char cstring[1024];
+		memset(cstring, 'a', sizeof(cstring) - 1);
+		cstring[sizeof(cstring) - 1] = '\0';
+
+		Toy_String* str = Toy_createString(&bucket, cstring);
+		Toy_String* small = Toy_sliceString(&bucket, str, 10, 5);
+		Toy_String* share = Toy_sliceString(&bucket, str, 100, 64);
+		Toy_String* whole = Toy_sliceString(&bucket, str, 0, 1023);
+
+		//check
+		if (small->type != TOY_STRING_LEAF ||
+			small->length != 5 ||
+			strcmp(small->as.leaf.data, "aaaaa") != 0 ||
+			share->type != TOY_STRING_LEAF ||
+			share->length != 64 ||
+			whole != str ||
+			str->refCount != 2)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of copied string slices\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeString(small);
+		Toy_freeString(share);
+		Toy_freeString(whole);
+		Toy_freeString(str);
+		Toy_freeBucket(&bucket);
+	}
+
+	//slice across the leaves of a rope
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		Toy_String* first = Toy_createString(&bucket, "Lorem ipsum dolor sit amet, consectetur adipiscing elit, ");
+		Toy_String* second = Toy_createString(&bucket, "sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.");
+		Toy_String* str = Toy_concatStrings(&bucket, first, second);
+
+		Toy_String* wide = Toy_sliceString(&bucket, str, 28, 64);
+		Toy_String* narrow = Toy_sliceString(&bucket, str, 51, 15);
+		Toy_String* right = Toy_sliceString(&bucket, str, first->length, second->length);
+
+		char* wideBuffer = Toy_getStringRawBuffer(wide);
+		char* narrowBuffer = Toy_getStringRawBuffer(narrow);
+
+		//check
+		if (wide->type != TOY_STRING_NODE ||
+			wide->as.node.left->type != TOY_STRING_LEAF || //29 characters is too few for a view
+			wide->as.node.right->type != TOY_STRING_VIEW ||
+			strcmp(wideBuffer, "consectetur adipiscing elit, sed do eiusmod tempor incididunt ut") != 0 ||
+			narrow->type != TOY_STRING_LEAF ||
+			strcmp(narrowBuffer, "elit, sed do ei") != 0 ||
+			right != second ||
+			second->refCount != 4)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected state of rope slices, found '%s' and '%s'\n" TOY_CC_RESET, wideBuffer, narrowBuffer);
+			free(wideBuffer);
+			free(narrowBuffer);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		free(wideBuffer);
+		free(narrowBuffer);
+		Toy_freeString(wide);
+		Toy_freeString(narrow);
+		Toy_freeString(right);
+		Toy_freeString(str);
+		Toy_freeString(first);
+		Toy_freeString(second);
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
 int main() {
 	//run each test set, returning the total errors given
 	int total = 0, res = 0;
@@ -886,5 +1348,45 @@ int main() {
 		total += res;
 	}
 
+	{
+		res = test_string_rebalancing();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_string_builder();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_string_hashing();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_string_iterator();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_string_slicing();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
 	return total;
 }
@@ -1,8 +1,17 @@
 #include "toy_table.h"
 #include "toy_console_colors.h"
 
+#include "toy_string.h"
+
 #include <stdio.h>
 
+//the smallest table, which is a whole group of control bytes in the Swiss layout
+#if TOY_TABLE_SWISS
+#define TEST_INITIAL_CAPACITY TOY_TABLE_GROUP_WIDTH
+#else
+#define TEST_INITIAL_CAPACITY TOY_TABLE_INITIAL_CAPACITY
+#endif
+
 int test_table_allocation() {
 	//allocate and free a table
 	{
@@ -36,7 +45,7 @@ int test_table_simple_insert_lookup_and_remove() {
 		//insert
 		Toy_insertTable(&table, key, value);
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 1)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to insert into a table\n" TOY_CC_RESET);
@@ -49,7 +58,7 @@ int test_table_simple_insert_lookup_and_remove() {
 
 		//check lookup
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 1 ||
 			TOY_VALUE_AS_INTEGER(result) != 42)
 		{
@@ -63,7 +72,7 @@ int test_table_simple_insert_lookup_and_remove() {
 
 		//check remove
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 0)
 		{
 			fprintf(stderr, TOY_CC_ERROR "ERROR: Failed to remove from a table\n" TOY_CC_RESET);
@@ -78,6 +87,9 @@ int test_table_simple_insert_lookup_and_remove() {
 	return 0;
 }
 
+//the exact placement of entries depends on the layout
+#if !TOY_TABLE_SWISS
+
 //macros are a godsend
 #define TEST_ENTRY_STATE(i, k, v, p) \
 	TOY_VALUE_IS_INTEGER(table->data[i].key) != true || \
@@ -97,7 +109,7 @@ int test_table_contents_no_expansion() {
 
 		//check the state
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 1 ||
 
 			TEST_ENTRY_STATE(7, 1, 42, 0)
@@ -124,7 +136,7 @@ int test_table_contents_no_expansion() {
 
 		//check the state
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 3 ||
 
 			TEST_ENTRY_STATE(7, 1, 42, 0) ||
@@ -154,7 +166,7 @@ int test_table_contents_no_expansion() {
 
 		//check the state
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 4 ||
 
 			TEST_ENTRY_STATE(2, 5, 42, 0) ||
@@ -185,7 +197,7 @@ int test_table_contents_no_expansion() {
 
 		//check the state
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 4 ||
 
 			TEST_ENTRY_STATE(7, 1, 42, 0) ||
@@ -219,7 +231,7 @@ int test_table_contents_no_expansion() {
 
 		//check the state
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 3 ||
 
 			TOY_VALUE_IS_INTEGER(result) != true ||
@@ -248,7 +260,7 @@ int test_table_contents_no_expansion() {
 
 		//check the state
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 4 ||
 
 			TEST_ENTRY_STATE(7, 17, 42, 0) ||
@@ -282,7 +294,7 @@ int test_table_contents_no_expansion() {
 
 		//check the state
 		if (table == NULL ||
-			table->capacity != 8 ||
+			table->capacity != TEST_INITIAL_CAPACITY ||
 			table->count != 3 ||
 
 			TEST_ENTRY_STATE(7, 17, 42, 0) ||
@@ -569,6 +581,153 @@ int test_table_contents_with_expansions() {
 	return 0;
 }
 
+int test_table_cached_hashes() {
+	//every entry keeps its key's hash, and sits at that hash's home slot plus its psl, after odd-sized growth too
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Table* table = Toy_private_adjustTableCapacity(NULL, 12);
+
+		//a mix of integer and string keys
+		for (int i = 0; i < 200; i++) {
+			Toy_insertTable(&table, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i));
+
+			char buffer[32];
+			int length = snprintf(buffer, sizeof(buffer), "a longer name, %d", i);
+			Toy_insertTable(&table, TOY_VALUE_FROM_STRING(Toy_createStringLength(&bucket, buffer, length)), TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		//check the state
+		int failures = 0;
+		unsigned int mask = table->capacity - 1;
+
+		for (unsigned int i = 0; i < table->capacity; i++) {
+			if (TOY_VALUE_IS_NULL(table->data[i].key)) {
+				continue;
+			}
+
+			failures += table->data[i].hash != Toy_hashValue(table->data[i].key);
+			failures += ((table->data[i].hash + table->data[i].psl) & mask) != i;
+		}
+
+		if (table == NULL ||
+			table->capacity != 512 ||
+			(table->capacity & mask) != 0 ||
+			table->count != 400 ||
+			failures != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Table cached hashes failed, %d bad entries\n" TOY_CC_RESET, failures);
+			Toy_freeTable(table);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//free
+		Toy_freeTable(table);
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
+#else
+
+int test_table_control_bytes() {
+	//occupied slots hold their hash's low bits, and removals leave the group empty when it never filled
+	{
+		//setup
+		Toy_Table* table = Toy_allocateTable();
+
+		Toy_insertTable(&table, TOY_VALUE_FROM_INTEGER(1), TOY_VALUE_FROM_INTEGER(42));
+
+		unsigned int hash = Toy_hashValue(TOY_VALUE_FROM_INTEGER(1));
+		int slot = -1;
+		for (unsigned int i = 0; i < table->capacity; i++) {
+			if (table->ctrl[i] != TOY_TABLE_CTRL_EMPTY) {
+				slot = i;
+			}
+		}
+
+		//check the state
+		if (table == NULL ||
+			table->count != 1 ||
+			slot < 0 ||
+			table->ctrl[slot] != (hash & 0x7F) ||
+			TOY_VALUE_AS_INTEGER(table->keys[slot]) != 1 ||
+			TOY_VALUE_AS_INTEGER(table->values[slot]) != 42
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unrecognized control bytes from table data, single insert {1:42}\n" TOY_CC_RESET);
+			Toy_freeTable(table);
+			return -1;
+		}
+
+		Toy_removeTable(&table, TOY_VALUE_FROM_INTEGER(1));
+
+		if (table->count != 0 ||
+			table->deleted != 0 ||
+			table->ctrl[slot] != TOY_TABLE_CTRL_EMPTY ||
+			!TOY_VALUE_IS_NULL(table->keys[slot])
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unrecognized control bytes from table data, single removal\n" TOY_CC_RESET);
+			Toy_freeTable(table);
+			return -1;
+		}
+
+		//free
+		Toy_freeTable(table);
+	}
+
+	//a full group leaves tombstones, which are cleared by the next resize
+	{
+		//setup, filling the only group by hand, as inserting that many would expand the table
+		Toy_Table* table = Toy_allocateTable();
+
+		for (int i = 0; i < TOY_TABLE_GROUP_WIDTH; i++) {
+			table->keys[i] = TOY_VALUE_FROM_INTEGER(-1 - i);
+			table->values[i] = TOY_VALUE_FROM_INTEGER(i);
+			table->ctrl[i] = Toy_hashValue(table->keys[i]) & 0x7F;
+		}
+		table->count = TOY_TABLE_GROUP_WIDTH;
+
+		Toy_removeTable(&table, TOY_VALUE_FROM_INTEGER(-4));
+
+		if (table->count != TOY_TABLE_GROUP_WIDTH - 1 ||
+			table->deleted != 1 ||
+			table->ctrl[3] != TOY_TABLE_CTRL_DELETED
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Expected a tombstone when removing from a full group\n" TOY_CC_RESET);
+			Toy_freeTable(table);
+			return -1;
+		}
+
+		//resize, which rehashes everything still present
+		table = Toy_private_adjustTableCapacity(table, table->capacity * 2);
+
+		if (table->capacity != TOY_TABLE_GROUP_WIDTH * 2 ||
+			table->count != TOY_TABLE_GROUP_WIDTH - 1 ||
+			table->deleted != 0 ||
+			!TOY_VALUE_IS_NULL(Toy_lookupTable(&table, TOY_VALUE_FROM_INTEGER(-4))) ||
+			TOY_VALUE_AS_INTEGER(Toy_lookupTable(&table, TOY_VALUE_FROM_INTEGER(-5))) != 4
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Expected the tombstones to be cleared by a resize\n" TOY_CC_RESET);
+			Toy_freeTable(table);
+			return -1;
+		}
+
+		//free
+		Toy_freeTable(table);
+	}
+
+	return 0;
+}
+
+#endif
+
 int test_table_expansions_under_stress() {
 	//multiple expansions, find one value
 	{
@@ -605,6 +764,114 @@ int test_table_expansions_under_stress() {
 	return 0;
 }
 
+int test_table_removals_under_stress() {
+	//churn through inserts and removals, checking every key along the way
+	{
+		//setup
+		Toy_Table* table = Toy_allocateTable();
+
+		for (int i = 0; i < 1000; i++) {
+			Toy_insertTable(&table, TOY_VALUE_FROM_INTEGER(i), TOY_VALUE_FROM_INTEGER(i * 2));
+		}
+
+		//remove the even keys, then replace them with new ones, several times over
+		for (int round = 0; round < 4; round++) {
+			for (int i = 0; i < 1000; i += 2) {
+				Toy_removeTable(&table, TOY_VALUE_FROM_INTEGER(round * 1000 + i));
+			}
+
+			for (int i = 0; i < 1000; i += 2) {
+				Toy_insertTable(&table, TOY_VALUE_FROM_INTEGER((round + 1) * 1000 + i), TOY_VALUE_FROM_INTEGER(i * 2));
+			}
+		}
+
+		//removing something absent does nothing
+		Toy_removeTable(&table, TOY_VALUE_FROM_INTEGER(-1));
+
+		//check the state
+		int failures = 0;
+
+		for (int i = 0; i < 1000; i++) {
+			//odd keys stayed put, while the even ones only exist from the last round
+			Toy_Value original = Toy_lookupTable(&table, TOY_VALUE_FROM_INTEGER(i));
+			Toy_Value latest = Toy_lookupTable(&table, TOY_VALUE_FROM_INTEGER(4000 + i));
+
+			if (i % 2 == 1) {
+				failures += !TOY_VALUE_IS_INTEGER(original) || TOY_VALUE_AS_INTEGER(original) != i * 2 || !TOY_VALUE_IS_NULL(latest);
+			}
+			else {
+				failures += !TOY_VALUE_IS_NULL(original) || !TOY_VALUE_IS_INTEGER(latest) || TOY_VALUE_AS_INTEGER(latest) != i * 2;
+			}
+		}
+
+		if (table == NULL ||
+			table->count != 1000 ||
+			failures != 0
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Table removals under stress failed, %d bad lookups\n" TOY_CC_RESET, failures);
+			Toy_freeTable(table);
+			return -1;
+		}
+
+		//free
+		Toy_freeTable(table);
+	}
+
+	return 0;
+}
+
+int test_table_short_string_keys() {
+	//inline and heap strings with the same contents are the same key
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		Toy_Table* table = Toy_allocateTable();
+
+		//insert inline keys, enough to expand a few times
+		for (int i = 0; i < 100; i++) {
+			char key[8];
+			int length = snprintf(key, sizeof(key), "k%d", i);
+			Toy_insertTable(&table, TOY_VALUE_FROM_SHORT_STRING(key, length), TOY_VALUE_FROM_INTEGER(i));
+		}
+
+		//insert a heap key
+		Toy_String* heapKey = Toy_createString(&bucket, "k100");
+		Toy_insertTable(&table, TOY_VALUE_FROM_STRING(heapKey), TOY_VALUE_FROM_INTEGER(100));
+
+		//look up each with the other representation
+		Toy_String* lookupKey = Toy_createString(&bucket, "k42");
+		Toy_Value heapResult = Toy_lookupTable(&table, TOY_VALUE_FROM_STRING(lookupKey));
+		Toy_Value shortResult = Toy_lookupTable(&table, TOY_VALUE_FROM_SHORT_STRING("k100", 4));
+
+		//check the state
+		if (table == NULL ||
+			table->count != 101 ||
+
+			TOY_VALUE_IS_INTEGER(heapResult) != true ||
+			TOY_VALUE_AS_INTEGER(heapResult) != 42 ||
+			TOY_VALUE_IS_INTEGER(shortResult) != true ||
+			TOY_VALUE_AS_INTEGER(shortResult) != 100
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Table lookups across inline and heap string keys failed\n" TOY_CC_RESET);
+			Toy_freeString(heapKey);
+			Toy_freeString(lookupKey);
+			Toy_freeTable(table);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//free
+		Toy_freeString(heapKey);
+		Toy_freeString(lookupKey);
+		Toy_freeTable(table);
+		Toy_freeBucket(&bucket);
+	}
+
+	return 0;
+}
+
 int main() {
 	//run each test set, returning the total errors given
 	int total = 0, res = 0;
@@ -625,6 +892,7 @@ int main() {
 		total += res;
 	}
 
+#if !TOY_TABLE_SWISS
 	{
 		res = test_table_contents_no_expansion();
 		if (res == 0) {
@@ -641,6 +909,23 @@ int main() {
 		total += res;
 	}
 
+	{
+		res = test_table_cached_hashes();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+#else
+	{
+		res = test_table_control_bytes();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+#endif
+
 	{
 		res = test_table_expansions_under_stress();
 		if (res == 0) {
@@ -649,5 +934,21 @@ int main() {
 		total += res;
 	}
 
+	{
+		res = test_table_removals_under_stress();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		res = test_table_short_string_keys();
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
 	return total;
 }
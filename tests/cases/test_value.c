@@ -5,11 +5,14 @@
 #include "toy_string.h"
 
 #include <stdio.h>
+#include <string.h>
 
 int main() {
 	//test for the correct size
 	{
-#if TOY_BITNESS == 64
+#if TOY_VALUE_PACKED
+		if (sizeof(Toy_Value) != 8) {
+#elif TOY_BITNESS == 64
 		if (sizeof(Toy_Value) != 16) {
 #else
 		if (sizeof(Toy_Value) != 8) {
@@ -57,6 +60,38 @@ int main() {
 		}
 	}
 
+	//test equality across zero and mixed numeric types
+	{
+		if (!TOY_VALUES_ARE_EQUAL(TOY_VALUE_FROM_INTEGER(0), TOY_VALUE_FROM_INTEGER(0)) ||
+			!TOY_VALUES_ARE_EQUAL(TOY_VALUE_FROM_INTEGER(2), TOY_VALUE_FROM_FLOAT(2.0f)) ||
+			!TOY_VALUES_ARE_EQUAL(TOY_VALUE_FROM_FLOAT(0.5f), TOY_VALUE_FROM_FLOAT(0.5f)) ||
+			TOY_VALUES_ARE_EQUAL(TOY_VALUE_FROM_FLOAT(0.5f), TOY_VALUE_FROM_INTEGER(0))
+		)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: numeric equality check failed\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
+	//test the payloads survive, in either layout
+	{
+		Toy_Value zero = {0};
+		Toy_Value i = TOY_VALUE_FROM_INTEGER(-42);
+		Toy_Value f = TOY_VALUE_FROM_FLOAT(-3.5f);
+		Toy_Value t = TOY_VALUE_FROM_BOOLEAN(true);
+
+		if (!TOY_VALUE_IS_NULL(zero) ||
+			!TOY_VALUE_IS_INTEGER(i) || TOY_VALUE_AS_INTEGER(i) != -42 ||
+			!TOY_VALUE_IS_FLOAT(f) || TOY_VALUE_AS_FLOAT(f) != -3.5f ||
+			!TOY_VALUE_IS_BOOLEAN(t) || TOY_VALUE_AS_BOOLEAN(t) != true ||
+			TOY_VALUE_GET_TYPE(f) != TOY_VALUE_FLOAT
+		)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: value payload check failed\n" TOY_CC_RESET);
+			return -1;
+		}
+	}
+
 	//test value hashing
 	{
 		//setup
@@ -74,7 +109,7 @@ int main() {
 			Toy_hashValue(t) != 1 ||
 			Toy_hashValue(f) != 0 ||
 			Toy_hashValue(i) != 4147366645 ||
-			Toy_hashValue(s) != 994097935 ||
+			Toy_hashValue(s) != 2191592565 ||
 			TOY_VALUE_AS_STRING(s)->cachedHash == 0
 			)
 		{
@@ -87,6 +122,51 @@ int main() {
 		Toy_freeBucket(&bucket);
 	}
 
+	//test short strings, which live inside the value
+	{
+		//setup
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+
+		//values
+		Toy_Value inlined = TOY_VALUE_FROM_SHORT_STRING("key", 3);
+		Toy_Value full = TOY_VALUE_FROM_SHORT_STRING("abcdefgh", TOY_VALUE_SHORT_STRING_CAPACITY);
+		Toy_Value empty = TOY_VALUE_FROM_SHORT_STRING("", 0);
+		Toy_Value heap = TOY_VALUE_FROM_STRING(Toy_createString(&bucket, "key"));
+		Toy_Value rope = TOY_VALUE_FROM_STRING(Toy_concatStrings(&bucket, Toy_createString(&bucket, "k"), Toy_createString(&bucket, "ey")));
+		Toy_Value other = TOY_VALUE_FROM_STRING(Toy_createString(&bucket, "kez"));
+
+		char buffer[TOY_VALUE_SHORT_STRING_CAPACITY + 1];
+
+		if (TOY_VALUE_IS_STRING(inlined) != true ||
+			TOY_VALUE_IS_SHORT_STRING(inlined) != true ||
+			TOY_VALUE_GET_TYPE(inlined) != TOY_VALUE_STRING ||
+			TOY_VALUE_IS_SHORT_STRING(heap) != false ||
+
+			TOY_VALUE_AS_SHORT_STRING(inlined, buffer) != 3 || strcmp(buffer, "key") != 0 ||
+			TOY_VALUE_AS_SHORT_STRING(full, buffer) != TOY_VALUE_SHORT_STRING_CAPACITY || strncmp(buffer, "abcdefgh", TOY_VALUE_SHORT_STRING_CAPACITY) != 0 ||
+			TOY_VALUE_AS_SHORT_STRING(empty, buffer) != 0 || buffer[0] != '\0' ||
+
+			TOY_VALUES_ARE_EQUAL(inlined, TOY_VALUE_FROM_SHORT_STRING("key", 3)) != true ||
+			TOY_VALUES_ARE_EQUAL(inlined, heap) != true ||
+			TOY_VALUES_ARE_EQUAL(rope, inlined) != true ||
+			TOY_VALUES_ARE_EQUAL(inlined, other) != false ||
+			TOY_VALUES_ARE_EQUAL(inlined, full) != false ||
+			TOY_VALUES_ARE_EQUAL(inlined, empty) != false ||
+
+			Toy_hashValue(inlined) != Toy_hashValue(heap) ||
+			Toy_hashValue(inlined) != Toy_hashValue(rope) ||
+			Toy_hashValue(inlined) == Toy_hashValue(other)
+			)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected behaviour of a short string value\n" TOY_CC_RESET);
+			Toy_freeBucket(&bucket);
+			return -1;
+		}
+
+		//cleanup
+		Toy_freeBucket(&bucket);
+	}
+
 	printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
 	return 0;
 }
@@ -4,6 +4,7 @@
 #include "toy_lexer.h"
 #include "toy_parser.h"
 #include "toy_bytecode.h"
+#include "toy_routine.h"
 #include "toy_print.h"
 
 #include <stdio.h>
@@ -55,7 +56,7 @@ int test_setup_and_teardown(Toy_Bucket** bucketHandle) {
 		//check the routine was loaded correctly
 		if (
 			vm.routine - vm.bc != headerSize ||
-			vm.routineSize != 72 ||
+			vm.routineSize != (TOY_ROUTINE_SUPERINSTRUCTIONS ? 72 : 80) ||
 			vm.paramSize != 0 ||
 			vm.jumpsSize != 0 ||
 			vm.dataSize != 0 ||
@@ -476,6 +477,481 @@ int test_vm_reuse(Toy_Bucket** bucketHandle) {
 	return 0;
 }
 
+int test_constants(Toy_Bucket** bucketHandle) {
+	//string literals are built once, when the routine is bound
+	{
+		Toy_Bytecode bc = makeBytecodeFromSource(bucketHandle, "\"alpha string\"; \"beta string\"; \"alpha string\";");
+
+		Toy_VM vm;
+		Toy_initVM(&vm);
+		Toy_bindVM(&vm, bc.ptr);
+
+		//remember the memory in use
+		unsigned int bucketCount = vm.stringBucket->count;
+
+		//run
+		Toy_runVM(&vm);
+		Toy_runVM(&vm);
+
+		//check the pool and the pushed strings
+		if (vm.constants == NULL ||
+			vm.constants->count != 2 ||
+			TOY_VALUE_AS_STRING(vm.constants->data[0]) == TOY_VALUE_AS_STRING(vm.constants->data[1]) ||
+			strcmp(TOY_VALUE_AS_STRING(vm.constants->data[1])->as.leaf.data, "beta string") != 0 ||
+
+			vm.stack->count != 6 ||
+			TOY_VALUE_AS_STRING(((Toy_Value*)(vm.stack->data))[0]) != TOY_VALUE_AS_STRING(vm.constants->data[0]) ||
+			TOY_VALUE_AS_STRING(((Toy_Value*)(vm.stack->data))[5]) != TOY_VALUE_AS_STRING(vm.constants->data[0]) ||
+			Toy_getStringRefCount(TOY_VALUE_AS_STRING(vm.constants->data[0])) != 5 ||
+
+			vm.stringBucket->next != NULL ||
+			vm.stringBucket->count != bucketCount
+		)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected constant pool state in 'Toy_VM'\n" TOY_CC_RESET);
+
+			//cleanup and return
+			Toy_freeVM(&vm);
+			return -1;
+		}
+
+		//teadown
+		Toy_freeVM(&vm);
+	}
+
+	return 0;
+}
+
+int test_interning(Toy_Bucket** bucketHandle) {
+	//every use of a name resolves to one string, even across routines
+	{
+		Toy_Bytecode bc1 = makeBytecodeFromSource(bucketHandle, "var answer = 20; answer += 1;");
+		Toy_Bytecode bc2 = makeBytecodeFromSource(bucketHandle, "var other = 0; answer *= 2;");
+
+		Toy_VM vm;
+		Toy_initVM(&vm);
+
+		//run 1
+		Toy_bindVM(&vm, bc1.ptr);
+		Toy_runVM(&vm);
+
+		Toy_String* first = vm.names != NULL && vm.names->count == 1 ? TOY_VALUE_AS_STRING(vm.names->data[0]) : NULL;
+		Toy_resetVM(&vm);
+
+		//run 2, where 'answer' comes second in the data section
+		Toy_bindVM(&vm, bc2.ptr);
+		Toy_runVM(&vm);
+
+		Toy_String* key = Toy_createNameStringLength(bucketHandle, "answer", 6, TOY_VALUE_NULL);
+
+		if (first == NULL ||
+			first->type != TOY_STRING_NAME ||
+			strcmp(first->as.name.data, "answer") != 0 ||
+
+			vm.names == NULL ||
+			vm.names->count != 2 ||
+			TOY_VALUE_AS_STRING(vm.names->data[1]) != first ||
+			TOY_VALUE_AS_STRING(vm.names->data[0]) == first ||
+
+			TOY_VALUE_AS_INTEGER(Toy_accessScope(vm.scope, key)) != 42
+		)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected name interning state in 'Toy_VM'\n" TOY_CC_RESET);
+
+			//cleanup and return
+			Toy_freeVM(&vm);
+			Toy_freeBytecode(bc1);
+			return -1;
+		}
+
+		//teadown
+		Toy_freeVM(&vm);
+		Toy_freeBytecode(bc1);
+	}
+
+	return 0;
+}
+
+int test_slots(Toy_Bucket** bucketHandle) {
+	//locals live in slots, while globals live in the scope
+	{
+		const char* source = "var total = 1; { var a = 2; a *= 10; { var a = 3; total += a; } total += a; }";
+		Toy_Bytecode bc = makeBytecodeFromSource(bucketHandle, source);
+
+		Toy_VM vm;
+		Toy_initVM(&vm);
+		Toy_bindVM(&vm, bc.ptr);
+
+		//run
+		Toy_runVM(&vm);
+
+		//check the final state
+		Toy_String* key = Toy_createNameStringLength(bucketHandle, "total", 5, TOY_VALUE_NULL);
+		Toy_String* local = Toy_createNameStringLength(bucketHandle, "a", 1, TOY_VALUE_NULL);
+
+		if (vm.stack == NULL ||
+			vm.stack->count != 0 ||
+
+			vm.scope == NULL ||
+			Toy_isDeclaredScope(vm.scope, local) == true ||
+			TOY_VALUE_IS_INTEGER(Toy_accessScope(vm.scope, key)) != true ||
+			TOY_VALUE_AS_INTEGER(Toy_accessScope(vm.scope, key)) != 24 ||
+
+			vm.slots == NULL ||
+			vm.slots->count != 2 ||
+			TOY_VALUE_AS_INTEGER(vm.slots->data[0]) != 20 ||
+			TOY_VALUE_AS_INTEGER(vm.slots->data[1]) != 3
+		)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected result in 'Toy_VM' when testing slots, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			Toy_freeVM(&vm);
+			return -1;
+		}
+
+		//teadown
+		Toy_freeVM(&vm);
+	}
+
+	return 0;
+}
+
+int test_registers(Toy_Bucket** bucketHandle) {
+	//the same program as the slots test, compiled for the register backend
+	{
+		const char* source = "var total = 1; { var a = 2; a *= 10; { var a = 3; total += a; } total += a; }";
+
+		Toy_Lexer lexer;
+		Toy_bindLexer(&lexer, source);
+		Toy_Parser parser;
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		unsigned char* routine = Toy_compileRoutineWithBackend(ast, TOY_BACKEND_REGISTER);
+
+		Toy_VM vm;
+		Toy_initVM(&vm);
+		Toy_bindVMToRoutine(&vm, routine);
+
+		//run
+		Toy_runVM(&vm);
+
+		//check the final state
+		Toy_String* key = Toy_createNameStringLength(bucketHandle, "total", 5, TOY_VALUE_NULL);
+
+		if (vm.backend != TOY_BACKEND_REGISTER ||
+			vm.frameSize != 3 ||
+
+			vm.stack == NULL ||
+			vm.stack->count != 0 ||
+
+			vm.scope == NULL ||
+			TOY_VALUE_IS_INTEGER(Toy_accessScope(vm.scope, key)) != true ||
+			TOY_VALUE_AS_INTEGER(Toy_accessScope(vm.scope, key)) != 24 ||
+
+			vm.slots == NULL ||
+			vm.slots->count != 3 ||
+			TOY_VALUE_AS_INTEGER(vm.slots->data[0]) != 20 || //the outer 'a'
+			TOY_VALUE_AS_INTEGER(vm.slots->data[1]) != 24 //reused by the last temporary
+		)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected result in 'Toy_VM' when testing registers, source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			Toy_freeVM(&vm);
+			free(routine);
+			return -1;
+		}
+
+		//teadown
+		Toy_freeVM(&vm);
+		free(routine);
+	}
+
+	//register operands are printed and concatenated in place
+	{
+		Toy_setPrintCallback(callbackUtil);
+
+		const char* sources[] = {
+			"{ var a = \"foo\"; var b = a; print b .. \"bar\"; }", "foobar",
+			"{ var a = 1; print a != 2; }", "true",
+			"{ var a = 4; var b = (a + 2) * (a - 1) % 7; print b; }", "4",
+			NULL, NULL,
+		};
+
+		for (int i = 0; sources[i] != NULL; i += 2) {
+			Toy_Lexer lexer;
+			Toy_bindLexer(&lexer, sources[i]);
+			Toy_Parser parser;
+			Toy_bindParser(&parser, &lexer);
+			Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+			unsigned char* routine = Toy_compileRoutineWithBackend(ast, TOY_BACKEND_REGISTER);
+
+			Toy_VM vm;
+			Toy_initVM(&vm);
+			Toy_bindVMToRoutine(&vm, routine);
+			Toy_runVM(&vm);
+
+			if (callbackUtilReceived == NULL || strcmp(callbackUtilReceived, sources[i + 1]) != 0) {
+				fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected value '%s' found when testing registers, source: %s\n" TOY_CC_RESET, callbackUtilReceived != NULL ? callbackUtilReceived : "NULL", sources[i]);
+
+				//cleanup and return
+				free(callbackUtilReceived);
+				callbackUtilReceived = NULL;
+				Toy_freeVM(&vm);
+				free(routine);
+				Toy_resetPrintCallback();
+				return -1;
+			}
+
+			Toy_freeVM(&vm);
+			free(routine);
+		}
+
+		//cleanup
+		free(callbackUtilReceived);
+		callbackUtilReceived = NULL;
+		Toy_resetPrintCallback();
+	}
+
+	return 0;
+}
+
+int test_superinstructions(Toy_Bucket** bucketHandle) {
+	//literal operands are fused into the instructions using them
+	{
+		Toy_setPrintCallback(callbackUtil);
+
+		const char* sources[] = {
+			"{ var a = 4; print a + 1; }", "5",
+			"{ var a = 4; print a * 2.5; }", "10.000000",
+			"{ var a = 4; print a % 3 - 1; }", "0",
+			"{ var a = 4; print a < 10; }", "true",
+			"{ var a = 4; print a != 4; }", "false",
+			"{ var a = 4; print !(a == 4); }", "false",
+			"print 3.5;", "3.500000",
+			NULL, NULL,
+		};
+
+		for (int i = 0; sources[i] != NULL; i += 2) {
+			Toy_Lexer lexer;
+			Toy_bindLexer(&lexer, sources[i]);
+			Toy_Parser parser;
+			Toy_bindParser(&parser, &lexer);
+			Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+			unsigned char* routine = Toy_compileRoutineWithBackend(ast, TOY_BACKEND_STACK);
+
+			Toy_VM vm;
+			Toy_initVM(&vm);
+			Toy_bindVMToRoutine(&vm, routine);
+			Toy_runVM(&vm);
+
+			if (callbackUtilReceived == NULL || strcmp(callbackUtilReceived, sources[i + 1]) != 0 || vm.stack->count != 0) {
+				fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected value '%s' found when testing superinstructions, source: %s\n" TOY_CC_RESET, callbackUtilReceived != NULL ? callbackUtilReceived : "NULL", sources[i]);
+
+				//cleanup and return
+				free(callbackUtilReceived);
+				callbackUtilReceived = NULL;
+				Toy_freeVM(&vm);
+				free(routine);
+				Toy_resetPrintCallback();
+				return -1;
+			}
+
+			Toy_freeVM(&vm);
+			free(routine);
+		}
+
+		//cleanup
+		free(callbackUtilReceived);
+		callbackUtilReceived = NULL;
+		Toy_resetPrintCallback();
+	}
+
+	return 0;
+}
+
+int test_concat_chains(Toy_Bucket** bucketHandle) {
+	//chains are joined by one instruction, converting scalars along the way, on either backend
+	{
+		Toy_setPrintCallback(callbackUtil);
+
+		const char* sources[] = {
+			"print \"a\" .. \"b\" .. \"c\";", "abc",
+			"print \"n=\" .. 1 .. \", \" .. (-20) .. \", \" .. true .. \", \" .. null;", "n=1, -20, true, null",
+			"{ var a = \"foo\"; var b = \"bar\"; print a .. (b .. a) .. b; }", "foobarfoobar",
+			"{ var a = \"x\"; var b = a .. a .. a; print b .. b .. 2.5; }", "xxxxxx2.500000",
+			"{ var a = \"0123456789012345678901234567890123456789012345678901234567890123\"; print a .. a .. a .. a .. \"!\"; }",
+				"0123456789012345678901234567890123456789012345678901234567890123"
+				"0123456789012345678901234567890123456789012345678901234567890123"
+				"0123456789012345678901234567890123456789012345678901234567890123"
+				"0123456789012345678901234567890123456789012345678901234567890123!",
+			NULL, NULL,
+		};
+
+		Toy_RoutineBackend backends[] = { TOY_BACKEND_STACK, TOY_BACKEND_REGISTER };
+
+		for (int b = 0; b < 2; b++) {
+			for (int i = 0; sources[i] != NULL; i += 2) {
+				Toy_Lexer lexer;
+				Toy_bindLexer(&lexer, sources[i]);
+				Toy_Parser parser;
+				Toy_bindParser(&parser, &lexer);
+				Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+				unsigned char* routine = Toy_compileRoutineWithBackend(ast, backends[b]);
+
+				Toy_VM vm;
+				Toy_initVM(&vm);
+				Toy_bindVMToRoutine(&vm, routine);
+				Toy_runVM(&vm);
+
+				if (callbackUtilReceived == NULL || strcmp(callbackUtilReceived, sources[i + 1]) != 0 || vm.stack->count != 0) {
+					fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected value '%s' found when testing concatenation chains, backend %d, source: %s\n" TOY_CC_RESET, callbackUtilReceived != NULL ? callbackUtilReceived : "NULL", b, sources[i]);
+
+					//cleanup and return
+					free(callbackUtilReceived);
+					callbackUtilReceived = NULL;
+					Toy_freeVM(&vm);
+					free(routine);
+					Toy_resetPrintCallback();
+					return -1;
+				}
+
+				Toy_freeVM(&vm);
+				free(routine);
+			}
+		}
+
+		//cleanup
+		free(callbackUtilReceived);
+		callbackUtilReceived = NULL;
+		Toy_resetPrintCallback();
+	}
+
+	return 0;
+}
+
+int test_string_release(Toy_Bucket** bucketHandle) {
+	//strings that are replaced, printed or joined are given back, leaving only the pool's and the scope's references
+	{
+		const char* source = "var greeting = \"hello there\"; greeting = greeting .. \" again\"; print greeting; greeting == \"hello\"; greeting = \"goodbye world\";";
+		Toy_Bytecode bc = makeBytecodeFromSource(bucketHandle, source);
+
+		Toy_setPrintCallback(callbackUtil);
+
+		Toy_VM vm;
+		Toy_initVM(&vm);
+		Toy_bindVM(&vm, bc.ptr);
+
+		//run
+		Toy_runVM(&vm);
+		Toy_clearVMStack(&vm);
+
+		//check the final state
+		Toy_String* key = Toy_createNameStringLength(bucketHandle, "greeting", 8, TOY_VALUE_NULL);
+		Toy_Value value = Toy_accessScope(vm.scope, key);
+
+		unsigned int strings = 0, references = 0;
+		for (unsigned int i = 0; i < vm.constants->count; i++) {
+			if (!TOY_VALUE_IS_SHORT_STRING(vm.constants->data[i])) {
+				strings++;
+				references += Toy_getStringRefCount(TOY_VALUE_AS_STRING(vm.constants->data[i]));
+			}
+		}
+
+		if (callbackUtilReceived == NULL || strcmp(callbackUtilReceived, "hello there again") != 0 ||
+			vm.stack->count != 0 ||
+			TOY_VALUE_IS_STRING(value) != true ||
+			strcmp(TOY_VALUE_AS_STRING(value)->as.leaf.data, "goodbye world") != 0 ||
+			Toy_getStringRefCount(TOY_VALUE_AS_STRING(value)) != 2 ||
+			references != strings + 1 ||
+			vm.stringBucket->next != NULL
+		)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected string references in 'Toy_VM', source: %s\n" TOY_CC_RESET, source);
+
+			//cleanup and return
+			free(callbackUtilReceived);
+			callbackUtilReceived = NULL;
+			Toy_freeVM(&vm);
+			Toy_resetPrintCallback();
+			return -1;
+		}
+
+		//teadown
+		free(callbackUtilReceived);
+		callbackUtilReceived = NULL;
+		Toy_freeVM(&vm);
+		Toy_resetPrintCallback();
+	}
+
+	return 0;
+}
+
+int test_profile(Toy_Bucket** bucketHandle) {
+	//the profile only exists when compiled in
+	{
+		Toy_Lexer lexer;
+		Toy_bindLexer(&lexer, "var a = 1; var b = a + a; a = b * b;");
+		Toy_Parser parser;
+		Toy_bindParser(&parser, &lexer);
+		Toy_Ast* ast = Toy_scanParser(bucketHandle, &parser);
+
+		unsigned char* routine = Toy_compileRoutineWithBackend(ast, TOY_BACKEND_STACK);
+
+		Toy_VM vm;
+		Toy_initVM(&vm);
+		Toy_bindVMToRoutine(&vm, routine);
+		Toy_runVM(&vm);
+
+		Toy_VMProfile* profile = Toy_getVMProfile(&vm);
+
+#if TOY_VM_PROFILE
+		//every dispatch is counted, and each one after the first is the second half of a pair
+		unsigned long long counts = 0, pairs = 0;
+		for (int i = 0; i < 256; i++) {
+			counts += profile->opcodeCounts[i];
+			for (int j = 0; j < 256; j++) {
+				pairs += profile->opcodePairs[i][j];
+			}
+		}
+
+		if (profile == NULL ||
+			profile->opcodeCounts[TOY_OPCODE_RETURN] != 1 ||
+			profile->opcodeCounts[TOY_OPCODE_DECLARE] != 2 ||
+			counts < 2 ||
+			pairs != counts - 1 ||
+			profile->stackPeak == 0 ||
+			profile->scopePeak != 1 ||
+			profile->stringBucketBytes == 0 ||
+			profile->scopeBucketBytes == 0)
+		{
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Unexpected VM profile found\n" TOY_CC_RESET);
+			Toy_freeVM(&vm);
+			free(routine);
+			return -1;
+		}
+#else
+		if (profile != NULL) {
+			fprintf(stderr, TOY_CC_ERROR "ERROR: Found a VM profile when profiling is disabled\n" TOY_CC_RESET);
+			Toy_freeVM(&vm);
+			free(routine);
+			return -1;
+		}
+#endif
+
+		//cleanup
+		Toy_freeVM(&vm);
+		free(routine);
+	}
+
+	return 0;
+}
+
 int main() {
 	//run each test set, returning the total errors given
 	int total = 0, res = 0;
@@ -540,5 +1016,85 @@ int main() {
 		total += res;
 	}
 
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_constants(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_interning(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_slots(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_registers(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_superinstructions(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_concat_chains(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_string_release(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
+	{
+		Toy_Bucket* bucket = Toy_allocateBucket(TOY_BUCKET_IDEAL);
+		res = test_profile(&bucket);
+		Toy_freeBucket(&bucket);
+		if (res == 0) {
+			printf(TOY_CC_NOTICE "All good\n" TOY_CC_RESET);
+		}
+		total += res;
+	}
+
 	return total;
 }
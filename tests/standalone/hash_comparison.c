@@ -0,0 +1,293 @@
+//compares the string hashes Toy has used: throughput, and how evenly they fill a Robin Hood table like Toy_Table
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+//the hashes being compared
+static unsigned int oldHash(const char* string, unsigned int length) {
+	unsigned int hash = 2166136261u;
+
+	for (unsigned int i = 0; string[i]; i++) {
+		hash *= string[i];
+		hash ^= 16777619;
+	}
+
+	return hash;
+}
+
+static unsigned int murmurHash(const char* string, unsigned int length) {
+	const uint64_t m = 0xc6a4a7935bd1e995ull;
+	const int r = 47;
+
+	uint64_t hash = 0x9e3779b97f4a7c15ull ^ (length * m);
+
+	const char* tail = string + (length & ~7u);
+	for (const char* iter = string; iter != tail; iter += 8) {
+		uint64_t k;
+		memcpy(&k, iter, 8);
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		hash ^= k;
+		hash *= m;
+	}
+
+	switch(length & 7) {
+		case 7: hash ^= (uint64_t)(unsigned char)tail[6] << 48; //fallthrough
+		case 6: hash ^= (uint64_t)(unsigned char)tail[5] << 40; //fallthrough
+		case 5: hash ^= (uint64_t)(unsigned char)tail[4] << 32; //fallthrough
+		case 4: hash ^= (uint64_t)(unsigned char)tail[3] << 24; //fallthrough
+		case 3: hash ^= (uint64_t)(unsigned char)tail[2] << 16; //fallthrough
+		case 2: hash ^= (uint64_t)(unsigned char)tail[1] << 8; //fallthrough
+		case 1: hash ^= (uint64_t)(unsigned char)tail[0];
+			hash *= m;
+	}
+
+	hash ^= hash >> r;
+	hash *= m;
+	hash ^= hash >> r;
+
+	unsigned int result = (unsigned int)(hash ^ (hash >> 32));
+	return result != 0 ? result : 1;
+}
+
+//the current one, which composes across rope nodes
+static unsigned int ropeHash(const char* string, unsigned int length) {
+	const unsigned int b = 0x9e3779b1u;
+	unsigned int hash = 0;
+	unsigned int i = 0;
+
+	for (; i + 4 <= length; i += 4) {
+		hash = hash * (b * b * b * b) +
+			(unsigned char)string[i + 0] * (b * b * b) +
+			(unsigned char)string[i + 1] * (b * b) +
+			(unsigned char)string[i + 2] * b +
+			(unsigned char)string[i + 3];
+	}
+
+	for (; i < length; i++) {
+		hash = hash * b + (unsigned char)string[i];
+	}
+
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16;
+
+	return hash;
+}
+
+typedef unsigned int (*HashFn)(const char* string, unsigned int length);
+
+//utils
+static double nowSeconds() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int rng = 12345;
+static unsigned int nextRandom() {
+	rng = rng * 1103515245u + 12345u;
+	return rng >> 8;
+}
+
+//key sets, each key stored as a NUL-terminated string in a fixed slot
+#define KEY_SLOT 32
+
+typedef struct Keys {
+	char (*data)[KEY_SLOT];
+	unsigned int* lengths;
+	unsigned int count;
+} Keys;
+
+static Keys makeKeys(unsigned int count, int kind) {
+	Keys keys = { malloc(count * KEY_SLOT), malloc(count * sizeof(unsigned int)), count };
+
+	for (unsigned int i = 0; i < count; i++) {
+		switch(kind) {
+			case 0: //sequential identifiers, the shape a script's names take
+				snprintf(keys.data[i], KEY_SLOT, "var%u", i);
+				break;
+
+			case 1: //longer identifiers sharing a prefix
+				snprintf(keys.data[i], KEY_SLOT, "playerInventory%u", i);
+				break;
+
+			case 2: { //random lowercase words
+				unsigned int length = 3 + nextRandom() % 10;
+				for (unsigned int c = 0; c < length; c++) {
+					keys.data[i][c] = 'a' + nextRandom() % 26;
+				}
+				keys.data[i][length] = '\0';
+				break;
+			}
+		}
+
+		keys.lengths[i] = strlen(keys.data[i]);
+	}
+
+	return keys;
+}
+
+static void freeKeys(Keys keys) {
+	free(keys.data);
+	free(keys.lengths);
+}
+
+//insert every key into a Robin Hood table, growing it the way Toy_Table does, and report the probe sequence lengths
+static void measureDistribution(const char* name, HashFn hash, Keys keys) {
+	unsigned int capacity = 8;
+	unsigned int count = 0;
+	unsigned int* hashes = calloc(capacity, sizeof(unsigned int));
+	unsigned int* psls = calloc(capacity, sizeof(unsigned int));
+	unsigned char* used = calloc(capacity, 1);
+
+	for (unsigned int i = 0; i < keys.count; i++) {
+		//grow at 80% load, reinserting everything
+		if (count + 1 > capacity * 0.8) {
+			unsigned int oldCapacity = capacity;
+			unsigned int* oldHashes = hashes;
+			unsigned char* oldUsed = used;
+
+			capacity *= 2;
+			hashes = calloc(capacity, sizeof(unsigned int));
+			free(psls);
+			psls = calloc(capacity, sizeof(unsigned int));
+			used = calloc(capacity, 1);
+			count = 0;
+
+			for (unsigned int j = 0; j < oldCapacity; j++) {
+				if (!oldUsed[j]) {
+					continue;
+				}
+
+				unsigned int h = oldHashes[j], psl = 0, probe = h % capacity;
+				while (used[probe]) {
+					if (psls[probe] < psl) {
+						unsigned int th = hashes[probe], tp = psls[probe];
+						hashes[probe] = h;
+						psls[probe] = psl;
+						h = th;
+						psl = tp;
+					}
+					probe = (probe + 1) % capacity;
+					psl++;
+				}
+				hashes[probe] = h;
+				psls[probe] = psl;
+				used[probe] = 1;
+				count++;
+			}
+
+			free(oldHashes);
+			free(oldUsed);
+		}
+
+		unsigned int h = hash(keys.data[i], keys.lengths[i]), psl = 0, probe = h % capacity;
+		while (used[probe]) {
+			if (psls[probe] < psl) {
+				unsigned int th = hashes[probe], tp = psls[probe];
+				hashes[probe] = h;
+				psls[probe] = psl;
+				h = th;
+				psl = tp;
+			}
+			probe = (probe + 1) % capacity;
+			psl++;
+		}
+		hashes[probe] = h;
+		psls[probe] = psl;
+		used[probe] = 1;
+		count++;
+	}
+
+	//probe sequence lengths
+	unsigned long long totalPsl = 0;
+	unsigned int maxPsl = 0;
+	for (unsigned int i = 0; i < capacity; i++) {
+		if (used[i]) {
+			totalPsl += psls[i];
+			maxPsl = psls[i] > maxPsl ? psls[i] : maxPsl;
+		}
+	}
+
+	//how far the home buckets are from uniform, where 1.0 is ideal
+	unsigned int* homes = calloc(capacity, sizeof(unsigned int));
+	for (unsigned int i = 0; i < keys.count; i++) {
+		homes[hash(keys.data[i], keys.lengths[i]) % capacity]++;
+	}
+
+	double expected = (double)keys.count / capacity, chi = 0;
+	for (unsigned int i = 0; i < capacity; i++) {
+		chi += (homes[i] - expected) * (homes[i] - expected) / expected;
+	}
+
+	//full 32-bit collisions between different keys
+	unsigned int collisions = 0;
+	for (unsigned int i = 0; i < keys.count; i++) {
+		unsigned int h = hash(keys.data[i], keys.lengths[i]);
+		for (unsigned int j = i + 1; j < keys.count; j++) {
+			if (h == hash(keys.data[j], keys.lengths[j]) && strcmp(keys.data[i], keys.data[j]) != 0) {
+				collisions++;
+			}
+		}
+	}
+
+	printf("  %s: capacity %6u, mean psl %7.3f, max psl %5u, chi-squared / capacity %7.3f, full collisions %u\n", name, capacity, (double)totalPsl / keys.count, maxPsl, chi / capacity, collisions);
+
+	free(homes);
+	free(hashes);
+	free(psls);
+	free(used);
+}
+
+static void measureThroughput(const char* name, HashFn hash, Keys keys) {
+	unsigned int rounds = 2000;
+	unsigned long long bytes = 0;
+	unsigned int sink = 0;
+
+	double start = nowSeconds();
+
+	for (unsigned int r = 0; r < rounds; r++) {
+		for (unsigned int i = 0; i < keys.count; i++) {
+			sink += hash(keys.data[i], keys.lengths[i]);
+			bytes += keys.lengths[i];
+		}
+	}
+
+	double elapsed = nowSeconds() - start;
+
+	printf("  %s: %7.1f MB/s, %5.2f ns per key (%08x)\n", name, bytes / elapsed / 1e6, elapsed * 1e9 / ((double)rounds * keys.count), sink);
+}
+
+int main() {
+	const char* kinds[] = { "var%u", "playerInventory%u", "random words" };
+	const unsigned int sizes[] = { 100, 1000, 10000 };
+
+	for (int kind = 0; kind < 3; kind++) {
+		for (int s = 0; s < 3; s++) {
+			Keys keys = makeKeys(sizes[s], kind);
+
+			printf("%u keys like '%s':\n", sizes[s], kinds[kind]);
+			measureDistribution("old   ", oldHash, keys);
+			measureDistribution("murmur", murmurHash, keys);
+			measureDistribution("rope  ", ropeHash, keys);
+
+			if (sizes[s] == 1000) {
+				measureThroughput("old   ", oldHash, keys);
+				measureThroughput("murmur", murmurHash, keys);
+				measureThroughput("rope  ", ropeHash, keys);
+			}
+
+			freeKeys(keys);
+		}
+	}
+
+	return 0;
+}